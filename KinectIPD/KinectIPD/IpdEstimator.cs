@@ -0,0 +1,102 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+using System;
+using System.Runtime.InteropServices;
+using System.Windows.Media.Media3D;
+
+namespace KinectIPD
+{
+    #region Interop
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MIpdEstimatorSettings
+    {
+        public int WindowSize;
+        public int MinSamples;
+        public float MinIpd;
+        public float MaxIpd;
+        public float OutlierThreshold;
+        public float ConvergedHalfWidth;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MIpdEstimate
+    {
+        public float Ipd;
+        public float Low;
+        public float High;
+        public int Accepted;
+        public int Rejected;
+        public int Converged;
+    }
+    #endregion
+
+    // Running IPD of the pupil pairs found so far, in mm. Pairs whose IPD is far off the median of the
+    // latest ones are rejected; the estimate has converged once its 95% confidence interval is narrow enough.
+    public class IpdEstimator
+    {
+        #region DLLImports
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern IntPtr CreateIpdEstimator();
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern void DestroyIpdEstimator(IntPtr instance);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern int AddPupils(IntPtr instance, float leftX, float leftY, float leftZ, float rightX, float rightY, float rightZ, out MIpdEstimate estimate);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern void ResetIpdEstimator(IntPtr instance);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern void SetIpdEstimatorSettings(IntPtr instance, ref MIpdEstimatorSettings settings);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern IntPtr GetIpdEstimatorSettings(IntPtr instance);
+
+        #endregion
+
+        private IntPtr _ipdEstimatorDLL = IntPtr.Zero;
+        private MIpdEstimatorSettings _settings;
+
+        public IpdEstimator()
+        {
+            _ipdEstimatorDLL = CreateIpdEstimator();
+            var result = GetIpdEstimatorSettings(_ipdEstimatorDLL);
+            _settings = (MIpdEstimatorSettings)Marshal.PtrToStructure(result, typeof(MIpdEstimatorSettings));
+        }
+
+        public MIpdEstimatorSettings Settings
+        {
+            get { return _settings; }
+            set
+            {
+                _settings = value;
+                SetIpdEstimatorSettings(_ipdEstimatorDLL, ref _settings);
+            }
+        }
+
+        // Last estimate, updated by Add and cleared by Reset
+        public MIpdEstimate Estimate { get; private set; }
+
+        // Adds the pupil centers of one frame in camera space (meters), returns false if their IPD was rejected
+        public bool Add(Vector3D leftPupil, Vector3D rightPupil)
+        {
+            MIpdEstimate estimate;
+            var accepted = AddPupils(_ipdEstimatorDLL,
+                (float)leftPupil.X, (float)leftPupil.Y, (float)leftPupil.Z,
+                (float)rightPupil.X, (float)rightPupil.Y, (float)rightPupil.Z,
+                out estimate);
+            Estimate = estimate;
+            return accepted == 1;
+        }
+
+        public void Reset()
+        {
+            ResetIpdEstimator(_ipdEstimatorDLL);
+            Estimate = new MIpdEstimate();
+        }
+    }
+}
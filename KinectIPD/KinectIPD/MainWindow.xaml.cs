@@ -34,13 +34,7 @@ namespace KinectIPD
         private float _currentZoom = 3;     // used to zoom in/out on user's face when tracking (in debug mode)
 
         private int _resetStateAfterMs = 7500;              // how long to wait (after '_lastDoneTime') to reset (for the next user) after finding an IPD
-        private int _minIpds = 20;                          // minimum number of IPD scans to average together before displaying final IPD
-        private int _ipdAverageCount = 30;                  // number of IPD's to use for running average
         private int _pupilUpdateFrequencyMs = 200;          // how often the kinect should scan the face to find the users pupils
-        private double _acceptableStdDevStart = 1;          // standard deviation of IPD scans must be under this value before displaying measurement to user
-        private double _currentAcceptableStdDev = 1;        // current standard deviation
-        private double _acceptableStdDevIncreasePerSec = .1;// how much to increase the acceptable stdDev per second after the minimum number of scans
-        private double _maxStdDev = 10;                     // maximum standard deviation that is expected
         private int _maxMeasureTime = 25000;                // how long should sampling continue before giving up
 
         private DateTime _currentMeasureTimeStart = DateTime.Now;   // when did we start measuring for this session
@@ -62,7 +56,8 @@ namespace KinectIPD
         private Rect _leftPupilRectImageReco;
         private Rect _rightPupilRectImageReco;
 
-        private List<double> _ipds = new List<double>();
+        // outlier rejection and when the IPD is valid are set through its Settings
+        private IpdEstimator _ipdEstimator;
         // Used for averaging depth to avoid problems at pixel borders
         private Point[] _poissonDisk = new Point[64];
 
@@ -188,6 +183,7 @@ namespace KinectIPD
             DataContext = this;
 
             _pupilDetect = new PupilDetect();
+            _ipdEstimator = new IpdEstimator();
             _exposure = new KinectExposure();
             _recorder = new KinectRecorder();
         }
@@ -438,7 +434,7 @@ namespace KinectIPD
 
         private async void submitIpd_Click(object sender, RoutedEventArgs e)
         {
-            if (_ipds.Count > 0 && _holoDeviceManager.CurrentDevice != null)
+            if (_ipdEstimator.Estimate.Accepted > 0 && _holoDeviceManager.CurrentDevice != null)
             {
                 if (_holoDeviceManager.CurrentDevice.IsSaving)
                 {
@@ -446,7 +442,7 @@ namespace KinectIPD
                 }
                 else
                 {
-                    var result = await _holoDeviceManager.CurrentDevice.SubmitIPD((float)_ipds.Average());
+                    var result = await _holoDeviceManager.CurrentDevice.SubmitIPD(_ipdEstimator.Estimate.Ipd);
                     Log("Submit IPD: " + result);
                     if (!result)
                         MessageBox.Show("Couldn't save IPD to HoloLens.");
@@ -487,8 +483,7 @@ namespace KinectIPD
             _finalIPD = 0.0f;
             _hasSavedIPDToDevice = false;
             _hasValidIPD = false;
-            _currentAcceptableStdDev = _acceptableStdDevStart;
-            _ipds = new List<double>();
+            _ipdEstimator.Reset();
             if (!_isDebugMode)
                 debugMessage.Text = "";
             IPDText = string.Empty;
@@ -663,7 +658,7 @@ namespace KinectIPD
                     DistanceText = "Step into view of the camera";
                 }
 
-                IPDText = (_ipds.Count > 0 ? _ipds.Average().ToString("0.0") : "-");
+                IPDText = (_ipdEstimator.Estimate.Accepted > 0 ? _ipdEstimator.Estimate.Ipd.ToString("0.0") : "-");
             }
         }
 
@@ -699,7 +694,7 @@ namespace KinectIPD
                     else if (!_isPaused && _kinect.HasBody && _hasValidIPD)// && DateTime.Now.Subtract(_kinect.LastBodySeenTime).TotalSeconds < 5)
                     {
                         _lastDoneTime = DateTime.Now;
-                        _finalIPD = _ipds.Average();
+                        _finalIPD = _ipdEstimator.Estimate.Ipd;
                         if (_currentMode != Mode.DisplayOnly)
                         {
                             // If we still have a user and have a valid IPD, start the programming.
@@ -729,7 +724,7 @@ namespace KinectIPD
                                 else
                                     testingInstructionText.Text = "Look here";
                                 //testingInstructionText.Text += "(" + _currentAcceptableStdDev.ToString("0.00") + ")";
-                                testingIPDText.Text = (_ipds.Count > 0 ? _ipds.Average().ToString("0.0") : "-");
+                                testingIPDText.Text = (_ipdEstimator.Estimate.Accepted > 0 ? _ipdEstimator.Estimate.Ipd.ToString("0.0") : "-");
                                 testingOverlay.Visibility = Visibility.Visible;
                             }
                         }
@@ -739,7 +734,7 @@ namespace KinectIPD
                                 ShowInstructionMessage("Move " + (_kinect.HeadDist < _minDistance ? "further away" : "closer"));
                         }
 
-                        IPDText = (_ipds.Count > 0 ? _ipds.Average().ToString("0.0") : "-");
+                        IPDText = (_ipdEstimator.Estimate.Accepted > 0 ? _ipdEstimator.Estimate.Ipd.ToString("0.0") : "-");
                     }
                     break;
                 case State.Programming:
@@ -857,11 +852,13 @@ namespace KinectIPD
             if (_kinect.LeftEyeRect.Y < 0 || _kinect.RightEyeRect.Y < 0 || _kinect.LeftEyeRect.Bottom >= 1080 || _kinect.RightEyeRect.Bottom >= 1080)
             {
                 Log("** _leftEyeRect or _rightEyeRect outside screen ");
+                _pupilDetect.ResetTracking();
                 return false;
             }
 
             busy = true;
 
+            Rect[] eyeRects = new Rect[] { _kinect.LeftEyeRect, _kinect.RightEyeRect };
             Size leftPixelSize = new Size(_kinect.LeftEyeRect.Width, _kinect.LeftEyeRect.Height);
             byte[] leftPixelArray = _kinect.ColorBitmap.ToArray(new Int32Rect((int)_kinect.LeftEyeRect.X, (int)_kinect.LeftEyeRect.Y, (int)_kinect.LeftEyeRect.Width, (int)_kinect.LeftEyeRect.Height));
 
@@ -898,23 +895,24 @@ namespace KinectIPD
                 }
             }
 
-            Task.Run(() =>
+            Task.Run(async () =>
             {
                 Rect rightPupilLocalRect = Rect.Empty;
                 Point rightPupilLocalCenter = new Point();
                 Rect leftPupilLocalRect = Rect.Empty;
                 Point leftPupilLocalCenter = new Point();
 
-                var leftEyeTask = _pupilDetect.FindPupil(ref leftPixelArray, (int)leftPixelSize.Width, (int)leftPixelSize.Height);
-                var rightEyeTask = _pupilDetect.FindPupil(ref rightPixelArray, (int)rightPixelSize.Width, (int)rightPixelSize.Height);
-                if (leftEyeTask != null && rightEyeTask != null)
+                if (leftPixelSize.Width > 0 && leftPixelSize.Height > 0 && rightPixelSize.Width > 0 && rightPixelSize.Height > 0)
                 {
-                    Task.WaitAll(new Task[] { leftEyeTask, rightEyeTask });
-
-                    leftPupilLocalRect = leftEyeTask.Result.rectangle;
-                    leftPupilLocalCenter = leftEyeTask.Result.center;
-                    rightPupilLocalRect = rightEyeTask.Result.rectangle;
-                    rightPupilLocalCenter = rightEyeTask.Result.center;
+                    // both eyes, tracked from the previous frames. Awaited so no pool thread sits blocked on the search.
+                    var pupils = await _pupilDetect.TrackPupils(
+                        new byte[][] { leftPixelArray, rightPixelArray },
+                        eyeRects);
+
+                    leftPupilLocalRect = pupils[0].rectangle;
+                    leftPupilLocalCenter = pupils[0].center;
+                    rightPupilLocalRect = pupils[1].rectangle;
+                    rightPupilLocalCenter = pupils[1].center;
                 }
 
                 _foundPupils =
@@ -959,9 +957,12 @@ namespace KinectIPD
                     }
 
                     var newIpd = Utilities.VectorLength(leftPupilImageReco3D, rightPupilImageReco3D) * 1000;
-                    var isValidIpd = UpdateAverageIPD(newIpd);
+                    var isValidIpd = _ipdEstimator.Add(leftPupilImageReco3D, rightPupilImageReco3D);
+                    var estimate = _ipdEstimator.Estimate;
+                    if (estimate.Converged == 1)
+                        _hasValidIPD = true;
 
-                    debug += " = " + (newIpd).ToString("0.0") + (_ipds.Count > 0 ? "  Ave: " + _ipds.Average().ToString("0.0") : "") + (isValidIpd ? "" : " *** Rejected");
+                    debug += " = " + (newIpd).ToString("0.0") + (estimate.Accepted > 0 ? "  Ave: " + estimate.Ipd.ToString("0.0") + " (" + estimate.Low.ToString("0.0") + "-" + estimate.High.ToString("0.0") + ")" : "") + (isValidIpd ? "" : " *** Rejected");
                     Log(debug);
                 }
                 else
@@ -973,45 +974,6 @@ namespace KinectIPD
             return true;
         }
 
-        private bool UpdateAverageIPD(double newIpd)
-        {
-            if (_ipds.Count > _ipdAverageCount)
-                _ipds.RemoveAt(0);
-
-            if (double.IsNaN(newIpd) ||
-                newIpd > 80 || newIpd < 50 ||
-                (_ipds.Count > _minIpds && Math.Abs(_ipds.Average() - newIpd) > 5))
-            {
-                // rejection conditions
-                return false;
-            }
-            else
-            {
-                var lastAverage = _ipds.Count > 0 ? _ipds.Average() : 0;
-                _ipds.Add(newIpd);
-                var newAverage = _ipds.Average();
-
-                double stdDev = 0.0;
-                foreach (var ipd in _ipds)
-                {
-                    stdDev += Math.Pow((newAverage - ipd), 2);
-                }
-
-                stdDev /= _ipds.Count();
-                stdDev = Math.Sqrt(stdDev);
-                stdDev = stdDev > _maxStdDev ? _maxStdDev : stdDev;
-
-                if (_ipds.Count > _minIpds)
-                {
-                    _currentAcceptableStdDev += _acceptableStdDevIncreasePerSec / (1000 / _pupilUpdateFrequencyMs);
-                }
-                if (_ipds.Count > _minIpds && stdDev <= _currentAcceptableStdDev)
-                    _hasValidIPD = true;
-
-                return true;
-            }
-        }
-
         private void Log(string message)
         {
             Dispatcher.Invoke(new Action(() =>
@@ -16,6 +16,12 @@ namespace KinectIPD
     {
         public float CenterX { get; private set; }
         public float CenterY { get; private set; }
+
+        public MPupilInfo(float centerX, float centerY) : this()
+        {
+            CenterX = centerX;
+            CenterY = centerY;
+        }
     }
 
     public struct MPupilDetectSettings
@@ -29,7 +35,28 @@ namespace KinectIPD
         public bool EnablePostProcess { get; set; }
         public float PostProcessThreshold { get; set; }
         public float MaxMag { get; set; }
+        public float TrackRadius { get; set; }
+        public float TrackMinConfidence { get; set; }
+        public int PyramidLevels { get; set; }
+        public int PyramidCandidates { get; set; }
     };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MPupilTrack
+    {
+        public float CenterX;
+        public float CenterY;
+        public float Confidence;
+        public int Windowed;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MPupilImage
+    {
+        public IntPtr Pixels;
+        public int Width;
+        public int Height;
+    }
     #endregion
     public class PupilDetect
     {
@@ -49,6 +76,21 @@ namespace KinectIPD
         [DllImport(@"PupilDetectDLL.dll")]
         private static extern int FindCenter(IntPtr instance, IntPtr pixels, int width, int height, out IntPtr PupilInfo, bool writeFiles, string fileNamePrefix);
 
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern int FindCenters(IntPtr instance, [In] MPupilImage[] images, int count, [Out] MPupilInfo[] results, [Out] int[] found);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern int SubmitFindCenter(IntPtr instance, byte[] pixels, int width, int height);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern int PollFindCenter(IntPtr instance, int ticket, out MPupilInfo result);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern int TrackCenter(IntPtr instance, int eye, byte[] pixels, int width, int height, int originX, int originY, out MPupilTrack track);
+
+        [DllImport(@"PupilDetectDLL.dll")]
+        private static extern void ResetTracking(IntPtr instance, int eye);
+
         #endregion
 
 
@@ -69,6 +111,10 @@ namespace KinectIPD
             _settings.GradientThreshold = 50;
             _settings.PostProcessThreshold = .95f;
             _settings.MaxMag = 50;
+            _settings.TrackRadius = 10;
+            _settings.TrackMinConfidence = .2f;
+            _settings.PyramidLevels = 0; // 1 or 2 to trade some accuracy for speed, e.g. with a bigger FastEyeWidth
+            _settings.PyramidCandidates = 3;
             UpdatePupilDetectSettings();
         }
 
@@ -76,6 +122,8 @@ namespace KinectIPD
         {
             public Rect rectangle;
             public Point center;
+            // 0..1, only set by TrackPupils
+            public float confidence;
         }
 
         public Task<PupilDetectResult> FindPupil(ref WriteableBitmap colorBitmap, Rect eyeRect, bool writeFiles = false, string fileNamePrefix = "")
@@ -107,22 +155,119 @@ namespace KinectIPD
                 var result = FindCenter(_pupilDetectDLL, pnt, width, height, out pPupilInfo, writeFiles, fileNamePrefix);
                 Marshal.FreeHGlobal(pnt);
 
-                var pupilResult = new PupilDetectResult();
-                if (result == 1)
+                if (result != 1)
+                {
+                    return new PupilDetectResult();
+                }
+                return ToResult((MPupilInfo)Marshal.PtrToStructure(pPupilInfo, typeof(MPupilInfo)), width, height);
+            });
+
+            return t;
+        }
+
+        // Searches all the eye crops in one call, e.g. left and right. The crops are searched in parallel by the dll.
+        public Task<PupilDetectResult[]> FindPupils(byte[][] arrays, int[] widths, int[] heights)
+        {
+            return Task.Run(() =>
+            {
+                var handles = new GCHandle[arrays.Length];
+                var images = new MPupilImage[arrays.Length];
+                var infos = new MPupilInfo[arrays.Length];
+                var found = new int[arrays.Length];
+                try
                 {
-                    var PupilInfo = (MPupilInfo)Marshal.PtrToStructure(pPupilInfo, typeof(MPupilInfo));
-                    // Reject the result if the pupil was found along the border - usually not valid.
-                    if (PupilInfo.CenterX > _ignoreBorderWidth && PupilInfo.CenterX < width - _ignoreBorderWidth &&
-                    PupilInfo.CenterY > _ignoreBorderWidth && PupilInfo.CenterY < height - _ignoreBorderWidth)
+                    for (int i = 0; i < arrays.Length; i++)
                     {
-                        pupilResult.center = new Point(PupilInfo.CenterX, PupilInfo.CenterY);
-                        pupilResult.rectangle = new Rect(PupilInfo.CenterX - 2, PupilInfo.CenterY - 2, 4, 4);
+                        handles[i] = GCHandle.Alloc(arrays[i], GCHandleType.Pinned);
+                        images[i].Pixels = handles[i].AddrOfPinnedObject();
+                        images[i].Width = widths[i];
+                        images[i].Height = heights[i];
                     }
+
+                    FindCenters(_pupilDetectDLL, images, images.Length, infos, found);
                 }
-                return pupilResult;
+                finally
+                {
+                    foreach (var handle in handles)
+                    {
+                        if (handle.IsAllocated)
+                        {
+                            handle.Free();
+                        }
+                    }
+                }
+
+                var results = new PupilDetectResult[arrays.Length];
+                for (int i = 0; i < arrays.Length; i++)
+                {
+                    if (found[i] == 1)
+                    {
+                        results[i] = ToResult(infos[i], widths[i], heights[i]);
+                    }
+                }
+                return results;
             });
+        }
 
-            return t;
+        // Follows both pupils over the frames, arrays[0] is the left eye and arrays[1] the right one.
+        // Only the area around the predicted centers is searched while the tracking is confident, and the centers are smoothed.
+        public Task<PupilDetectResult[]> TrackPupils(byte[][] arrays, Rect[] eyeRects)
+        {
+            return Task.Run(() =>
+            {
+                var results = new PupilDetectResult[arrays.Length];
+                Parallel.For(0, arrays.Length, eye =>
+                {
+                    var rect = eyeRects[eye];
+                    MPupilTrack track;
+                    if (TrackCenter(_pupilDetectDLL, eye, arrays[eye], (int)rect.Width, (int)rect.Height, (int)rect.X, (int)rect.Y, out track) == 1)
+                    {
+                        var info = new MPupilInfo(track.CenterX, track.CenterY);
+                        results[eye] = ToResult(info, (int)rect.Width, (int)rect.Height);
+                        results[eye].confidence = track.Confidence;
+                    }
+                });
+                return results;
+            });
+        }
+
+        // Forgets the tracked pupils, e.g. when the face is lost.
+        public void ResetTracking()
+        {
+            ResetTracking(_pupilDetectDLL, -1);
+        }
+
+        // Starts a search in the background without waiting for it, the pixels are copied so the array can be reused.
+        // Returns a ticket for PollPupil, or 0 if too many searches are pending.
+        public int SubmitPupil(byte[] array, int width, int height)
+        {
+            if (width == 0 || height == 0)
+            {
+                return 0;
+            }
+            return SubmitFindCenter(_pupilDetectDLL, array, width, height);
+        }
+
+        // False while the search is still running. Once it returns true the ticket is done with.
+        public bool PollPupil(int ticket, int width, int height, out PupilDetectResult pupilResult)
+        {
+            MPupilInfo info;
+            int result = PollFindCenter(_pupilDetectDLL, ticket, out info);
+            pupilResult = (result == 1) ? ToResult(info, width, height) : new PupilDetectResult();
+            return result != -1;
+        }
+
+        private PupilDetectResult ToResult(MPupilInfo PupilInfo, int width, int height)
+        {
+            var pupilResult = new PupilDetectResult();
+            // Reject the result if the pupil was found along the border - usually not valid.
+            if (PupilInfo.CenterX > _ignoreBorderWidth && PupilInfo.CenterX < width - _ignoreBorderWidth &&
+            PupilInfo.CenterY > _ignoreBorderWidth && PupilInfo.CenterY < height - _ignoreBorderWidth)
+            {
+                pupilResult.center = new Point(PupilInfo.CenterX, PupilInfo.CenterY);
+                pupilResult.rectangle = new Rect(PupilInfo.CenterX - 2, PupilInfo.CenterY - 2, 4, 4);
+            }
+            return pupilResult;
         }
 
         private void UpdatePupilDetectSettings()
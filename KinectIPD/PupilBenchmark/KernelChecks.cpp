@@ -0,0 +1,277 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "KernelChecks.h"
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <stdio.h>
+
+// in findEyeCenter.cpp
+double computeGradients(const cv::Mat &mat, cv::Mat &gradientX, cv::Mat &gradientY, cv::Mat &mags, double stdDevFactor);
+void testPossibleCentersWindow(int x, int y, float gx, float gy, const cv::Mat &weight, cv::Mat &out, const float *displacementX, const float *displacementY, int radius);
+void buildDisplacementTable(int radius, float maxMag, std::vector<float> &displacementX, std::vector<float> &displacementY);
+void floodKillEdges(cv::Mat &mat, cv::Mat &mask, std::vector<cv::Point> &stack);
+
+// the default FastEyeWidth and up, where the window is smaller than the image
+const int kVotingWidths[] = { 75, 100, 150 };
+// eyes checked at each width, voting over the whole image is slow
+const int kVotingEyes = 10;
+const float kVotingMaxMag = 50.0f;
+const double kVotingGradientThreshold = 150.0;
+const int kVotingWeightBlurSize = 9;
+const float kVotingWeightDivisor = 80.0f;
+// largest difference allowed between the two votes at any center, relative to the largest vote
+const double kVotingTolerance = 1e-4;
+
+// The flood fill runs on votes cut off below a fraction of the largest one. The search uses PostProcessThreshold
+// 0.95, lower ones leave bigger regions. Random fields with holes and many short spans are filled as well.
+const int kFloodWidth = 150;
+const double kFloodThresholds[] = { 0.95, 0.5, 0.2, 0.0 };
+const double kFloodDensities[] = { 0.4, 0.6, 0.8 };
+const int kFloodFieldsPerDensity = 10;
+// each field is filled this often by both, for the timing
+const int kFloodRepeats = 10;
+
+namespace PupilDetect
+{
+	static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// an eye at the search size with the normalized gradients and the weight EyeCenter::prepareLevel makes
+	struct VotingInput
+	{
+		cv::Mat gradientX;
+		cv::Mat gradientY;
+		cv::Mat weight;
+	};
+
+	static void prepareVotingInput(const cv::Mat &bgra, int width, VotingInput &input)
+	{
+		cv::Mat gray, eye, mags;
+		cv::cvtColor(bgra, gray, cv::COLOR_BGRA2GRAY);
+		cv::resize(gray, eye, cv::Size(width, cvRound((double)width * gray.rows / gray.cols)));
+
+		double threshold = computeGradients(eye, input.gradientX, input.gradientY, mags, kVotingGradientThreshold);
+		for (int y = 0; y < eye.rows; ++y)
+		{
+			double *Xr = input.gradientX.ptr<double>(y), *Yr = input.gradientY.ptr<double>(y);
+			const double *Mr = mags.ptr<double>(y);
+			for (int x = 0; x < eye.cols; ++x)
+			{
+				bool keep = Mr[x] > threshold;
+				Xr[x] = keep ? Xr[x] / Mr[x] : 0.0;
+				Yr[x] = keep ? Yr[x] / Mr[x] : 0.0;
+			}
+		}
+
+		cv::Mat blurred;
+		cv::GaussianBlur(eye, blurred, cv::Size(kVotingWeightBlurSize, kVotingWeightBlurSize), 0, 0);
+		blurred.convertTo(input.weight, CV_32F, -1.0 / kVotingWeightDivisor, 255.0 / kVotingWeightDivisor);
+	}
+
+	// the vote as it was before the window, in double, every gradient visiting every center of the image
+	static void voteWholeImage(const VotingInput &input, float maxMag, cv::Mat &out)
+	{
+		out.create(input.weight.rows, input.weight.cols, CV_64F);
+		out.setTo(0.0);
+		for (int y = 0; y < out.rows; ++y)
+		{
+			const double *Xr = input.gradientX.ptr<double>(y), *Yr = input.gradientY.ptr<double>(y);
+			for (int x = 0; x < out.cols; ++x)
+			{
+				double gx = Xr[x], gy = Yr[x];
+				if (gx == 0.0 && gy == 0.0)
+					continue;
+				for (int cy = 0; cy < out.rows; ++cy)
+				{
+					double *Or = out.ptr<double>(cy);
+					const float *Wr = input.weight.ptr<float>(cy);
+					for (int cx = 0; cx < out.cols; ++cx)
+					{
+						if (x == cx && y == cy)
+							continue;
+						// the vector from the candidate center to the gradient
+						double dx = x - cx, dy = y - cy;
+						double magnitude = sqrt(dx * dx + dy * dy);
+						if (magnitude > maxMag)
+							continue;
+						double dotProduct = (std::max)(0.0, (dx * gx + dy * gy) / magnitude);
+						Or[cx] += dotProduct * dotProduct * Wr[cx];
+					}
+				}
+			}
+		}
+	}
+
+	static void voteWindowed(const VotingInput &input, const std::vector<float> &displacementX, const std::vector<float> &displacementY, int radius, cv::Mat &out)
+	{
+		out.create(input.weight.rows, input.weight.cols, CV_32F);
+		out.setTo(0.0f);
+		for (int y = 0; y < out.rows; ++y)
+		{
+			const double *Xr = input.gradientX.ptr<double>(y), *Yr = input.gradientY.ptr<double>(y);
+			for (int x = 0; x < out.cols; ++x)
+			{
+				if (Xr[x] == 0.0 && Yr[x] == 0.0)
+					continue;
+				testPossibleCentersWindow(x, y, (float)Xr[x], (float)Yr[x], input.weight, out, displacementX.data(), displacementY.data(), radius);
+			}
+		}
+	}
+
+	bool CheckCenterVoting(const std::vector<SyntheticEye> &eyes)
+	{
+		int eyeCount = (std::min)(kVotingEyes, (int)eyes.size());
+		printf("\ncenter voting on %d eyes, windowed against the whole image, MaxMag %.0f\n", eyeCount, kVotingMaxMag);
+		printf("%-8s %12s %10s %10s %10s %8s\n", "width", "max diff", "same max", "whole ms", "window ms", "speedup");
+
+		bool ok = true;
+		VotingInput input;
+		cv::Mat whole, windowed, windowed64;
+		std::vector<float> displacementX, displacementY;
+		for (int width : kVotingWidths)
+		{
+			double worstDifference = 0.0, wholeSeconds = 0.0, windowSeconds = 0.0;
+			int sameMaximum = 0;
+			for (int i = 0; i < eyeCount; ++i)
+			{
+				prepareVotingInput(eyes[i].bgra, width, input);
+				// as EyeCenter::voteAllCenters sizes it, the table is kept between searches so it is not timed
+				int radius = (std::max)(0, (std::min)((int)floor(kVotingMaxMag), (std::max)(input.weight.rows, input.weight.cols) - 1));
+				buildDisplacementTable(radius, kVotingMaxMag, displacementX, displacementY);
+
+				auto start = std::chrono::high_resolution_clock::now();
+				voteWholeImage(input, kVotingMaxMag, whole);
+				wholeSeconds += secondsSince(start);
+
+				start = std::chrono::high_resolution_clock::now();
+				voteWindowed(input, displacementX, displacementY, radius, windowed);
+				windowSeconds += secondsSince(start);
+
+				windowed.convertTo(windowed64, CV_64F);
+				double maxVote = 0.0;
+				cv::Point wholeMax, windowedMax;
+				cv::minMaxLoc(whole, nullptr, &maxVote, nullptr, &wholeMax);
+				cv::minMaxLoc(windowed64, nullptr, nullptr, nullptr, &windowedMax);
+				if (maxVote > 0.0)
+					worstDifference = (std::max)(worstDifference, cv::norm(whole, windowed64, cv::NORM_INF) / maxVote);
+				// float sums may pick the other one of two maxima that are equal up to the tolerance
+				if (windowedMax == wholeMax || whole.at<double>(windowedMax) >= maxVote * (1.0 - kVotingTolerance))
+					sameMaximum++;
+			}
+
+			ok = ok && worstDifference <= kVotingTolerance && sameMaximum == eyeCount;
+			printf("%-8d %12.2e %7d/%-2d %10.3f %10.3f %7.1fx\n", width, worstDifference, sameMaximum, eyeCount,
+				wholeSeconds * 1000.0 / eyeCount, windowSeconds * 1000.0 / eyeCount, wholeSeconds / (std::max)(windowSeconds, 1e-9));
+		}
+
+		if (!ok)
+			printf("center voting: the windowed votes differ from the whole image by more than %.0e\n", kVotingTolerance);
+		return ok;
+	}
+
+	// floodKillEdges as it was before the scanline fill, queueing every neighbor of every pixel it visits
+	static void floodKillEdgesQueue(cv::Mat &mat, cv::Mat &mask)
+	{
+		cv::rectangle(mat, cv::Rect(0, 0, mat.cols, mat.rows), 255);
+
+		mask.create(mat.rows, mat.cols, CV_8U);
+		mask.setTo(255);
+		std::queue<cv::Point> toDo;
+		toDo.push(cv::Point(0, 0));
+		while (!toDo.empty())
+		{
+			cv::Point p = toDo.front();
+			toDo.pop();
+			if (mat.at<float>(p) == 0.0f)
+				continue;
+			const cv::Point neighbors[] = { cv::Point(p.x + 1, p.y), cv::Point(p.x - 1, p.y), cv::Point(p.x, p.y + 1), cv::Point(p.x, p.y - 1) };
+			for (const cv::Point &np : neighbors)
+			{
+				if (np.x >= 0 && np.x < mat.cols && np.y >= 0 && np.y < mat.rows)
+					toDo.push(np);
+			}
+			mat.at<float>(p) = 0.0f;
+			mask.at<uchar>(p) = 0;
+		}
+	}
+
+	bool CheckFloodKillEdges(const std::vector<SyntheticEye> &eyes)
+	{
+		std::vector<cv::Mat> fields;
+
+		// the votes of the eyes, cut off the way EyeCenter::voteAllCenters does it
+		VotingInput input;
+		cv::Mat votes;
+		std::vector<float> displacementX, displacementY;
+		int eyeCount = (std::min)(kVotingEyes, (int)eyes.size());
+		for (int i = 0; i < eyeCount; ++i)
+		{
+			prepareVotingInput(eyes[i].bgra, kFloodWidth, input);
+			int radius = (std::max)(0, (std::min)((int)floor(kVotingMaxMag), (std::max)(input.weight.rows, input.weight.cols) - 1));
+			buildDisplacementTable(radius, kVotingMaxMag, displacementX, displacementY);
+			voteWindowed(input, displacementX, displacementY, radius, votes);
+
+			double maxVote = 0.0;
+			cv::minMaxLoc(votes, nullptr, &maxVote);
+			for (double threshold : kFloodThresholds)
+			{
+				fields.push_back(cv::Mat());
+				cv::threshold(votes, fields.back(), maxVote * threshold, 0.0f, cv::THRESH_TOZERO);
+			}
+		}
+
+		cv::RNG rng(1);
+		for (double density : kFloodDensities)
+		{
+			for (int i = 0; i < kFloodFieldsPerDensity; ++i)
+			{
+				cv::Mat noise(cvRound(kFloodWidth * 0.7), kFloodWidth, CV_32F);
+				rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0.0), cv::Scalar::all(1.0));
+				fields.push_back(cv::Mat());
+				cv::threshold(noise, fields.back(), 1.0 - density, 0.0f, cv::THRESH_TOZERO);
+			}
+		}
+
+		int identical = 0;
+		double queueSeconds = 0.0, scanlineSeconds = 0.0;
+		cv::Mat queueMat, queueMask, scanlineMat, scanlineMask;
+		std::vector<cv::Point> stack;
+		for (const cv::Mat &field : fields)
+		{
+			for (int repeat = 0; repeat < kFloodRepeats; ++repeat)
+			{
+				field.copyTo(queueMat);
+				auto start = std::chrono::high_resolution_clock::now();
+				floodKillEdgesQueue(queueMat, queueMask);
+				queueSeconds += secondsSince(start);
+
+				field.copyTo(scanlineMat);
+				start = std::chrono::high_resolution_clock::now();
+				floodKillEdges(scanlineMat, scanlineMask, stack);
+				scanlineSeconds += secondsSince(start);
+			}
+
+			if (cv::countNonZero(queueMask != scanlineMask) == 0 && cv::countNonZero(queueMat != scanlineMat) == 0)
+				identical++;
+		}
+
+		int runs = (int)fields.size() * kFloodRepeats;
+		printf("\nflood fill on %d fields, scanline against the queue\n", (int)fields.size());
+		printf("%-10s %10s %10s %8s\n", "identical", "queue ms", "scan ms", "speedup");
+		printf("%5d/%-4d %10.4f %10.4f %7.1fx\n", identical, (int)fields.size(),
+			queueSeconds * 1000.0 / runs, scanlineSeconds * 1000.0 / runs, queueSeconds / (std::max)(scanlineSeconds, 1e-9));
+
+		bool ok = identical == (int)fields.size();
+		if (!ok)
+			printf("flood fill: the scanline fill differs from the queue on %d fields\n", (int)fields.size() - identical);
+		return ok;
+	}
+}
@@ -0,0 +1,18 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include "SyntheticEyes.h"
+#include <vector>
+
+namespace PupilDetect
+{
+	// Checks of the search kernels against the straightforward versions they replaced, run on the synthetic eyes.
+	// Each prints how far apart the results are and how much faster the kernel is, and returns false on a mismatch.
+
+	// testPossibleCentersWindow against every gradient voting for every center of the image, at a few FastEyeWidths
+	bool CheckCenterVoting(const std::vector<SyntheticEye> &eyes);
+
+	// floodKillEdges against the breadth first search it replaced, mask and image have to be bit identical
+	bool CheckFloodKillEdges(const std::vector<SyntheticEye> &eyes);
+}
@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+// Searches synthetic eyes with known centers once with each of a few PupilDetectSettings combinations, through
+// the same entry points the kiosk uses, and prints the error and time per image of each, so performance work
+// can be checked against accuracy. The same seed gives the same eyes, so runs can be compared.
+// The search kernels are then checked against the versions they replaced, a mismatch fails the run.
+//
+//	PupilBenchmark [imageCount] [seed]
+
+#include "stdafx.h"
+#include "SyntheticEyes.h"
+#include "KernelChecks.h"
+#include "PupilDetectExports.h"
+
+#include <opencv2/core/core.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace PupilDetect;
+
+namespace
+{
+	struct BenchmarkCase
+	{
+		const char *name;
+		PupilDetectSettings settings;
+	};
+
+	// errors in pixels of the eye crops
+	struct BenchmarkResult
+	{
+		double meanError;
+		double maxError;
+		double millisecondsPerImage;
+		int found;
+	};
+
+	BenchmarkResult runCase(IPupilDetect *detector, const BenchmarkCase &benchmarkCase, const std::vector<SyntheticEye> &eyes)
+	{
+		PupilDetectSettings settings = benchmarkCase.settings;
+		SetSettings(detector, &settings);
+
+		BenchmarkResult result = {};
+		double totalError = 0.0, totalSeconds = 0.0;
+		for (const SyntheticEye &eye : eyes)
+		{
+			PupilInfo *info = nullptr;
+			auto start = std::chrono::high_resolution_clock::now();
+			int found = FindCenter(detector, eye.bgra.data, eye.bgra.cols, eye.bgra.rows, &info, false, "");
+			totalSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			// a miss counts as the worst error the crop allows
+			double error = found ? cv::norm(cv::Point2f(info->CenterX, info->CenterY) - eye.center) : cv::norm(cv::Point2f((float)eye.bgra.cols, (float)eye.bgra.rows));
+			result.found += found;
+			totalError += error;
+			result.maxError = (std::max)(result.maxError, error);
+		}
+
+		result.meanError = totalError / eyes.size();
+		result.millisecondsPerImage = totalSeconds * 1000.0 / eyes.size();
+		return result;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int imageCount = (argc > 1) ? atoi(argv[1]) : 200;
+	int seed = (argc > 2) ? atoi(argv[2]) : 1;
+	if (imageCount <= 0)
+	{
+		fprintf(stderr, "usage: PupilBenchmark [imageCount] [seed]\n");
+		return 2;
+	}
+
+	std::vector<SyntheticEye> eyes;
+	GenerateSyntheticEyes(imageCount, seed, eyes);
+
+	IPupilDetect *detector = CreatePupilDetect();
+	const PupilDetectSettings defaults = *GetSettings(detector);
+
+	// the defaults, then one value changed at a time
+	std::vector<BenchmarkCase> cases;
+	cases.push_back({ "defaults", defaults });
+	cases.push_back({ "GradientThreshold 50", defaults });
+	cases.back().settings.GradientThreshold = 50.0;
+	cases.push_back({ "WeightBlurSize 5", defaults });
+	cases.back().settings.WeightBlurSize = 5;
+	cases.push_back({ "EnableWeight", defaults });
+	cases.back().settings.EnableWeight = true;
+	cases.push_back({ "MaxMag 25", defaults });
+	cases.back().settings.MaxMag = 25.0f;
+	cases.push_back({ "EnablePostProcess", defaults });
+	cases.back().settings.EnablePostProcess = true;
+	cases.push_back({ "FastEyeWidth 50", defaults });
+	cases.back().settings.FastEyeWidth = 50;
+	cases.push_back({ "FastEyeWidth 100", defaults });
+	cases.back().settings.FastEyeWidth = 100;
+	cases.push_back({ "PyramidLevels 1", defaults });
+	cases.back().settings.PyramidLevels = 1;
+
+	printf("%d synthetic eyes, seed %d\n", imageCount, seed);
+	printf("%-24s %10s %10s %10s %10s\n", "settings", "mean err", "max err", "ms/image", "found");
+	for (const BenchmarkCase &benchmarkCase : cases)
+	{
+		BenchmarkResult result = runCase(detector, benchmarkCase, eyes);
+		printf("%-24s %10.2f %10.2f %10.3f %6d/%-4d\n", benchmarkCase.name, result.meanError, result.maxError, result.millisecondsPerImage, result.found, imageCount);
+	}
+
+	DestroyPupilDetect(detector);
+
+	bool ok = CheckCenterVoting(eyes);
+	ok = CheckFloodKillEdges(eyes) && ok;
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "SyntheticEyes.h"
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+// cv drawing takes fixed point centers with this many fractional bits, so pupils are not snapped to pixels
+const int kDrawShift = 4;
+const float kDrawScale = (float)(1 << kDrawShift);
+
+namespace PupilDetect
+{
+	static cv::Point fixedPoint(float x, float y)
+	{
+		return cv::Point(cvRound(x * kDrawScale), cvRound(y * kDrawScale));
+	}
+
+	static cv::Scalar jitter(cv::RNG &rng, double b, double g, double r, double amount)
+	{
+		return cv::Scalar(b + rng.uniform(-amount, amount), g + rng.uniform(-amount, amount), r + rng.uniform(-amount, amount));
+	}
+
+	// the part of the image above (upper) or below a parabola through the lid's middle
+	static void drawLid(cv::Mat &img, float middleY, float curvature, bool upper, const cv::Scalar &skin)
+	{
+		std::vector<cv::Point> lid;
+		float centerX = img.cols / 2.0f;
+		for (int x = 0; x <= img.cols; x += 2)
+		{
+			float dx = x - centerX;
+			float y = upper ? middleY + curvature * dx * dx : middleY - curvature * dx * dx;
+			lid.push_back(fixedPoint((float)x, y));
+		}
+		float edgeY = upper ? -1.0f : (float)img.rows + 1.0f;
+		lid.push_back(fixedPoint((float)img.cols + 1.0f, edgeY));
+		lid.push_back(fixedPoint(-1.0f, edgeY));
+		cv::fillPoly(img, std::vector<std::vector<cv::Point>>(1, lid), skin, cv::LINE_AA, kDrawShift);
+	}
+
+	void GenerateSyntheticEyes(int count, int seed, std::vector<SyntheticEye> &eyes)
+	{
+		cv::RNG rng((uint64)seed);
+		eyes.resize(count);
+		for (SyntheticEye &eye : eyes)
+		{
+			int width = rng.uniform(36, 65);
+			int height = cvRound(width * rng.uniform(0.6, 0.75));
+
+			cv::Scalar skin = jitter(rng, 120, 150, 200, 25);
+			cv::Mat img(height, width, CV_8UC3, skin);
+
+			// sclera
+			cv::ellipse(img, fixedPoint(width / 2.0f, height / 2.0f), cv::Size(cvRound(width * 0.48f * kDrawScale), cvRound(height * 0.42f * kDrawScale)),
+				0, 0, 360, jitter(rng, 215, 215, 220, 15), cv::FILLED, cv::LINE_AA, kDrawShift);
+
+			// iris and pupil
+			float irisRadius = height * rng.uniform(0.28f, 0.38f);
+			float pupilRadius = irisRadius * rng.uniform(0.3f, 0.5f);
+			float centerX = width * rng.uniform(0.35f, 0.65f);
+			float centerY = height * rng.uniform(0.4f, 0.6f);
+			cv::Point center = fixedPoint(centerX, centerY);
+			cv::circle(img, center, cvRound(irisRadius * kDrawScale), jitter(rng, 70, 80, 90, 40), cv::FILLED, cv::LINE_AA, kDrawShift);
+			// some radial texture in the iris
+			for (int i = 0; i < 12; i++)
+			{
+				double angle = rng.uniform(0.0, 2.0 * M_PI);
+				cv::Point rim = fixedPoint(centerX + irisRadius * 0.9f * (float)cos(angle), centerY + irisRadius * 0.9f * (float)sin(angle));
+				cv::line(img, center, rim, jitter(rng, 90, 100, 110, 40), 1, cv::LINE_AA, kDrawShift);
+			}
+			cv::circle(img, center, cvRound(pupilRadius * kDrawScale), jitter(rng, 20, 20, 20, 10), cv::FILLED, cv::LINE_AA, kDrawShift);
+
+			// glint from the IR emitter or a lamp, usually on the edge of the pupil
+			float glintAngle = rng.uniform(0.0f, 2.0f * (float)M_PI);
+			float glintDistance = pupilRadius * rng.uniform(0.2f, 1.2f);
+			cv::circle(img, fixedPoint(centerX + glintDistance * cos(glintAngle), centerY + glintDistance * sin(glintAngle)),
+				cvRound(rng.uniform(1.0f, 2.0f) * kDrawScale), cv::Scalar(250, 250, 250), cv::FILLED, cv::LINE_AA, kDrawShift);
+
+			// lids, never covering the pupil itself
+			float curvature = rng.uniform(0.2f, 0.6f) * height / (float)(width * width);
+			drawLid(img, std::min(centerY - irisRadius * rng.uniform(0.5f, 1.3f), centerY - pupilRadius - 1.0f), curvature, true, skin);
+			drawLid(img, std::max(centerY + irisRadius * rng.uniform(0.8f, 1.5f), centerY + pupilRadius + 1.0f), curvature, false, skin);
+
+			// camera blur and noise
+			cv::GaussianBlur(img, img, cv::Size(3, 3), rng.uniform(0.5, 1.0));
+			cv::Mat noise(img.size(), CV_16SC3);
+			rng.fill(noise, cv::RNG::NORMAL, cv::Scalar::all(0), cv::Scalar::all(rng.uniform(2.0, 10.0)));
+			cv::Mat noisy;
+			img.convertTo(noisy, CV_16SC3);
+			noisy += noise;
+			noisy.convertTo(img, CV_8UC3);
+
+			cv::cvtColor(img, eye.bgra, cv::COLOR_BGR2BGRA);
+			eye.center = cv::Point2f(centerX, centerY);
+		}
+	}
+}
@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include <opencv2/core/core.hpp>
+#include <vector>
+
+namespace PupilDetect
+{
+	struct SyntheticEye
+	{
+		cv::Mat bgra;
+		// where the pupil was drawn, in pixels of bgra
+		cv::Point2f center;
+	};
+
+	// Procedural eye crops with known pupil centers: a pupil and iris on the sclera, eyelids that can cover
+	// part of the iris, a glint next to the pupil, blur and sensor noise. The same seed gives the same eyes.
+	void GenerateSyntheticEyes(int count, int seed, std::vector<SyntheticEye> &eyes);
+}
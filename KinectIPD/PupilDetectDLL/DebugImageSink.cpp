@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "DebugImageSink.h"
+
+#include <opencv2/highgui/highgui.hpp>
+
+// level 9 took longer than the search itself
+const int kPngCompression = 1;
+
+namespace PupilDetect
+{
+	DebugImageSink::DebugImageSink(size_t maxQueued)
+		: m_maxQueued(maxQueued)
+		, m_dropped(0)
+	{
+	}
+
+	DebugImageSink::~DebugImageSink()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+
+		if (m_thread.joinable())
+			m_thread.join();
+	}
+
+	void DebugImageSink::Write(const std::string &fileName, const cv::Mat &image)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_queue.size() >= m_maxQueued)
+		{
+			m_dropped++;
+			return;
+		}
+
+		// the caller goes on to reuse its images
+		m_queue.push_back(QueuedImage{ fileName, image.clone() });
+		if (!m_thread.joinable())
+			m_thread = std::thread(&DebugImageSink::Run, this);
+		m_wake.notify_one();
+	}
+
+	void DebugImageSink::Run()
+	{
+		std::vector<int> compression_params;
+		compression_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
+		compression_params.push_back(kPngCompression);
+
+		while (true)
+		{
+			QueuedImage queued;
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+				if (m_queue.empty())
+					return;
+
+				queued = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+
+			try
+			{
+				cv::imwrite(queued.fileName, queued.image, compression_params);
+			}
+			catch (const cv::Exception &)
+			{
+				// a debug image that can't be written is not worth stopping for
+			}
+		}
+	}
+}
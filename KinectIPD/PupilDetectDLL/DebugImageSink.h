@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include <opencv2/core/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace PupilDetect
+{
+	// Writes the writeFiles debug images on a thread of its own, so turning them on barely changes the timing
+	// of the search. Images are copied when they are handed in and written with fast PNG compression.
+	// When more than maxQueued are waiting the new ones are dropped instead of making the search wait.
+	class DebugImageSink
+	{
+	public:
+		explicit DebugImageSink(size_t maxQueued = 32);
+		// writes whatever is still queued
+		~DebugImageSink();
+
+		void Write(const std::string &fileName, const cv::Mat &image);
+
+		// images dropped because the queue was full
+		int Dropped() const { return m_dropped; }
+
+	private:
+		struct QueuedImage
+		{
+			std::string fileName;
+			cv::Mat image;
+		};
+
+		void Run();
+
+		size_t m_maxQueued;
+		std::deque<QueuedImage> m_queue;
+		std::mutex m_lock;
+		std::condition_variable m_wake;
+		bool m_stop = false;
+		std::atomic<int> m_dropped;
+		// started with the first image
+		std::thread m_thread;
+	};
+}
@@ -0,0 +1,156 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "IpdEstimator.h"
+
+#include <algorithm>
+
+// samples in the window before the median and MAD are trusted for rejecting
+const size_t kMinWindowForRejection = 5;
+// MAD of a normal distribution times this is its standard deviation
+const double kMadToStdDev = 1.4826;
+// mm, keeps a window of nearly identical IPDs from rejecting everything else
+const double kMinRobustStdDev = 0.5;
+// 97.5% point of the standard normal
+const double kZ95 = 1.959964;
+
+IIpdEstimator* CreateIpdEstimator()
+{
+	return new PupilDetect::IpdEstimator();
+}
+
+int AddPupils(IIpdEstimator* ii, float leftX, float leftY, float leftZ, float rightX, float rightY, float rightZ, PupilDetect::IpdEstimate* estimate)
+{
+	if (ii == nullptr)
+		return 0;
+	return ii->AddPupils(leftX, leftY, leftZ, rightX, rightY, rightZ, estimate);
+}
+
+void ResetIpdEstimator(IIpdEstimator* ii)
+{
+	if (ii == nullptr)
+		return;
+	ii->Reset();
+}
+
+void SetIpdEstimatorSettings(IIpdEstimator* ii, PupilDetect::IpdEstimatorSettings* settings)
+{
+	if (ii == nullptr)
+		return;
+	ii->SetSettings(settings);
+}
+
+PupilDetect::IpdEstimatorSettings* GetIpdEstimatorSettings(IIpdEstimator* ii)
+{
+	if (ii == nullptr)
+		return nullptr;
+	return ii->GetSettings();
+}
+
+void DestroyIpdEstimator(IIpdEstimator* ii)
+{
+	delete ii;
+}
+
+namespace PupilDetect
+{
+	void IpdEstimator::SetSettings(IpdEstimatorSettings* settings)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_settings = *settings;
+	}
+
+	IpdEstimatorSettings* IpdEstimator::GetSettings()
+	{
+		return &m_settings;
+	}
+
+	void IpdEstimator::Reset()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_window.clear();
+		m_accepted = 0;
+		m_rejected = 0;
+		m_mean = 0.0;
+		m_m2 = 0.0;
+	}
+
+	int IpdEstimator::AddPupils(float leftX, float leftY, float leftZ, float rightX, float rightY, float rightZ, IpdEstimate* estimate)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		double dx = rightX - leftX, dy = rightY - leftY, dz = rightZ - leftZ;
+		double ipd = sqrt(dx * dx + dy * dy + dz * dz) * 1000.0;
+
+		bool accepted = false;
+		// no depth or a mismatched pupil gives an IPD no one has, that says nothing about the real one
+		if (std::isfinite(ipd) && ipd >= m_settings.MinIpd && ipd <= m_settings.MaxIpd)
+		{
+			accepted = !IsOutlier(ipd);
+
+			m_window.push_back(ipd);
+			while (m_window.size() > (size_t)(std::max)(1, m_settings.WindowSize))
+				m_window.pop_front();
+		}
+
+		if (accepted)
+		{
+			m_accepted++;
+			double delta = ipd - m_mean;
+			m_mean += delta / m_accepted;
+			m_m2 += delta * (ipd - m_mean);
+		}
+		else
+		{
+			m_rejected++;
+		}
+
+		if (estimate != nullptr)
+			*estimate = Estimate();
+		return accepted ? 1 : 0;
+	}
+
+	bool IpdEstimator::IsOutlier(double ipd)
+	{
+		if (m_window.size() < kMinWindowForRejection)
+			return false;
+
+		m_sorted.assign(m_window.begin(), m_window.end());
+		auto middle = m_sorted.begin() + m_sorted.size() / 2;
+		std::nth_element(m_sorted.begin(), middle, m_sorted.end());
+		double median = *middle;
+
+		for (double &value : m_sorted)
+			value = fabs(value - median);
+		std::nth_element(m_sorted.begin(), middle, m_sorted.end());
+		double robustStdDev = (std::max)(*middle * kMadToStdDev, kMinRobustStdDev);
+
+		return fabs(ipd - median) > m_settings.OutlierThreshold * robustStdDev;
+	}
+
+	IpdEstimate IpdEstimator::Estimate() const
+	{
+		IpdEstimate estimate = {};
+		estimate.Accepted = m_accepted;
+		estimate.Rejected = m_rejected;
+		if (m_accepted == 0)
+			return estimate;
+
+		estimate.Ipd = (float)m_mean;
+		if (m_accepted < 2)
+		{
+			estimate.Low = estimate.High = estimate.Ipd;
+			return estimate;
+		}
+
+		// Student's t for n - 1 degrees of freedom, from the first Cornish-Fisher term; close enough past a handful of samples
+		double freedom = m_accepted - 1;
+		double t = kZ95 + (kZ95 * kZ95 * kZ95 + kZ95) / (4.0 * freedom);
+		double halfWidth = t * sqrt(m_m2 / freedom / m_accepted);
+		estimate.Low = (float)(m_mean - halfWidth);
+		estimate.High = (float)(m_mean + halfWidth);
+		estimate.Converged = (m_accepted >= m_settings.MinSamples && halfWidth <= m_settings.ConvergedHalfWidth) ? 1 : 0;
+		return estimate;
+	}
+}
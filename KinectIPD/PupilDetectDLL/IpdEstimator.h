@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include "IpdEstimatorExports.h"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace PupilDetect
+{
+	// Turns a stream of per frame IPDs into one estimate. Each new IPD is checked against the median and
+	// MAD of the latest WindowSize IPDs and rejected if it is too far off; the accepted ones feed a running
+	// mean and variance. The estimate has converged once enough samples were accepted and the 95% interval
+	// of the mean is narrow enough.
+	class IpdEstimator : public IIpdEstimator
+	{
+		IpdEstimatorSettings m_settings =
+		{
+			30,			//	WindowSize
+			20,			//	MinSamples
+			50.0f,		//	MinIpd
+			80.0f,		//	MaxIpd
+			3.0f,		//	OutlierThreshold
+			0.5f,		//	ConvergedHalfWidth
+		};
+
+		std::mutex m_lock;
+		// latest IPDs inside MinIpd..MaxIpd, accepted or not, so the median can follow a real change
+		std::deque<double> m_window;
+		std::vector<double> m_sorted;
+		// Welford's running mean and sum of squared differences of the accepted IPDs
+		int m_accepted = 0;
+		int m_rejected = 0;
+		double m_mean = 0.0;
+		double m_m2 = 0.0;
+
+		bool IsOutlier(double ipd);
+		IpdEstimate Estimate() const;
+
+	public:
+		IpdEstimator() {}
+		int AddPupils(float leftX, float leftY, float leftZ, float rightX, float rightY, float rightZ, IpdEstimate* estimate);
+		void Reset();
+		void SetSettings(IpdEstimatorSettings*);
+		IpdEstimatorSettings* GetSettings();
+	};
+}
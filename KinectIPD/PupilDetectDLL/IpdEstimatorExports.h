@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include "PupilInfo.h"
+
+class __declspec(dllexport) IIpdEstimator
+{
+public:
+	virtual ~IIpdEstimator() {}
+	virtual int AddPupils(float leftX, float leftY, float leftZ, float rightX, float rightY, float rightZ, PupilDetect::IpdEstimate* estimate) = 0;
+	virtual void Reset() = 0;
+	virtual void SetSettings(PupilDetect::IpdEstimatorSettings*) = 0;
+	virtual PupilDetect::IpdEstimatorSettings* GetSettings() = 0;
+};
+
+extern "C" __declspec(dllexport) IIpdEstimator* CreateIpdEstimator();
+// Takes the left and right pupil centers of one frame in camera space (meters). Returns 1 if the IPD they give
+// was accepted, 0 if it was rejected as an outlier; estimate is filled in either way.
+extern "C" __declspec(dllexport) int AddPupils(IIpdEstimator*, float leftX, float leftY, float leftZ, float rightX, float rightY, float rightZ, PupilDetect::IpdEstimate* estimate);
+// starts over, e.g. for the next user
+extern "C" __declspec(dllexport) void ResetIpdEstimator(IIpdEstimator*);
+extern "C" __declspec(dllexport) void SetIpdEstimatorSettings(IIpdEstimator*, PupilDetect::IpdEstimatorSettings* settings);
+extern "C" __declspec(dllexport) PupilDetect::IpdEstimatorSettings* GetIpdEstimatorSettings(IIpdEstimator*);
+extern "C" __declspec(dllexport) void DestroyIpdEstimator(IIpdEstimator*);
@@ -11,6 +11,7 @@
 #include <opencv2/photo/photo.hpp>
 #include <opencv2/objdetect/objdetect.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <queue>
 #include <stdio.h>
@@ -21,6 +22,11 @@
 
 using namespace cv;
 
+// searches submitted and not polled yet, per detector
+const size_t kMaxPendingCenters = 8;
+// narrowest image a tracking window is searched at
+const int kMinFastEyeWidth = 8;
+
 IPupilDetect* CreatePupilDetect() {
 	return new PupilDetect::PupilDetect();
 }
@@ -32,6 +38,41 @@ int FindCenter(IPupilDetect* ii, BYTE * pixels, int width, int height, PupilDete
 	return ii->FindCenter(pixels, width, height, irisInfo, writeFiles, fileName);
 }
 
+int FindCenters(IPupilDetect* ii, const PupilDetect::PupilImage* images, int count, PupilDetect::PupilInfo* results, int* found)
+{
+	if (ii == nullptr)
+		return 0;
+	return ii->FindCenters(images, count, results, found);
+}
+
+int SubmitFindCenter(IPupilDetect* ii, BYTE * pixels, int width, int height)
+{
+	if (ii == nullptr)
+		return 0;
+	return ii->SubmitFindCenter(pixels, width, height);
+}
+
+int PollFindCenter(IPupilDetect* ii, int ticket, PupilDetect::PupilInfo* result)
+{
+	if (ii == nullptr)
+		return -2;
+	return ii->PollFindCenter(ticket, result);
+}
+
+int TrackCenter(IPupilDetect* ii, int eye, BYTE * pixels, int width, int height, int originX, int originY, PupilDetect::PupilTrack* track)
+{
+	if (ii == nullptr)
+		return 0;
+	return ii->TrackCenter(eye, pixels, width, height, originX, originY, track);
+}
+
+void ResetTracking(IPupilDetect* ii, int eye)
+{
+	if (ii == nullptr)
+		return;
+	ii->ResetTracking(eye);
+}
+
 void SetSettings(IPupilDetect* ii, PupilDetect::PupilDetectSettings* settings)
 {
 	if (ii == nullptr)
@@ -53,52 +94,233 @@ void DestroyPupilDetect(IPupilDetect* ii)
 
 namespace PupilDetect
 {
+	PupilDetect::~PupilDetect()
+	{
+		// the background searches use this, so they have to be done before anything goes away
+		std::unique_lock<std::mutex> lock(m_pendingLock);
+		m_pendingIdle.wait(lock, [this] { return m_running == 0; });
+	}
+
 	void PupilDetect::SetSettings(PupilDetectSettings* settings)
 	{
+		std::lock_guard<std::mutex> lock(m_settingsLock);
 		m_settings = *settings;
 	}
 
+	PupilDetectSettings PupilDetect::CopySettings()
+	{
+		std::lock_guard<std::mutex> lock(m_settingsLock);
+		return m_settings;
+	}
+
 	PupilDetectSettings* PupilDetect::GetSettings()
 	{
+		// the live settings, for reading the defaults before any search is started
 		return &m_settings;
 	}
 
-	PupilInfo info;
 	int PupilDetect::FindCenter(BYTE * pixels, int width, int height, PupilInfo** irisInfo, bool writeFiles, const char * fileNamePrefix)
 	{
+		// valid until the next call on the same thread, so nothing is left for the caller to free
+		thread_local PupilInfo info;
+
 		Mat newImg = Mat(height, width, CV_8UC4, pixels);
 		//Mat newImg = imread("DebugImages/20160201_072423/left_orig2.png", CV_8UC4);
+		int result = FindCenter(newImg, &info, writeFiles, std::string(fileNamePrefix));
+		*irisInfo = &info;
+		return result;
+	}
 
-		std::vector<int> compression_params;
-		compression_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
-		compression_params.push_back(9);
-		auto prefix = std::string(fileNamePrefix);
-		if (writeFiles)
-			imwrite(prefix + "_orig.png", newImg, compression_params);
+	int PupilDetect::FindCenters(const PupilImage* images, int count, PupilInfo* results, int* found)
+	{
+		if (images == nullptr || results == nullptr || found == nullptr || count <= 0)
+			return 0;
+
+		// the images are spread over the pool, and each search spreads its voting over it as well
+		m_pool.ParallelFor(count, [&](int i)
+		{
+			const PupilImage &image = images[i];
+			results[i] = PupilInfo{};
+			found[i] = 0;
+			if (image.Pixels != nullptr && image.Width > 0 && image.Height > 0)
+				found[i] = FindCenter(Mat(image.Height, image.Width, CV_8UC4, image.Pixels), &results[i], false, std::string());
+		});
 
-		Mat biggerImg;
-		int scale = m_settings.ScaleInput;
-		cv::resize(newImg, biggerImg, cvSize(width * scale, height * scale));
+		return (int)std::count(found, found + count, 1);
+	}
+
+	int PupilDetect::SubmitFindCenter(BYTE * pixels, int width, int height)
+	{
+		if (pixels == nullptr || width <= 0 || height <= 0)
+			return 0;
+
+		// the caller can reuse pixels as soon as this returns
+		auto copy = std::make_shared<std::vector<BYTE>>(pixels, pixels + (size_t)width * height * 4);
+
+		int ticket;
+		{
+			std::lock_guard<std::mutex> lock(m_pendingLock);
+			if (m_pending.size() >= kMaxPendingCenters)
+			{
+				// make room by forgetting the oldest result nobody polled
+				auto done = std::find_if(m_pending.begin(), m_pending.end(), [](const std::pair<const int, PendingCenter> &pending) { return pending.second.done; });
+				if (done == m_pending.end())
+					return 0;
+				m_pending.erase(done);
+			}
+
+			ticket = m_nextTicket++;
+			if (m_nextTicket <= 0)
+				m_nextTicket = 1;
+			m_pending[ticket] = PendingCenter{ false, 0, PupilInfo{} };
+			m_running++;
+		}
+
+		m_pool.Post([this, ticket, copy, width, height]()
+		{
+			PupilInfo info = {};
+			int found = FindCenter(Mat(height, width, CV_8UC4, copy->data()), &info, false, std::string());
+
+			std::lock_guard<std::mutex> lock(m_pendingLock);
+			auto pending = m_pending.find(ticket);
+			if (pending != m_pending.end())
+				pending->second = PendingCenter{ true, found, info };
+			if (--m_running == 0)
+				m_pendingIdle.notify_all();
+		});
+
+		return ticket;
+	}
+
+	int PupilDetect::PollFindCenter(int ticket, PupilInfo* result)
+	{
+		std::lock_guard<std::mutex> lock(m_pendingLock);
+		auto pending = m_pending.find(ticket);
+		if (pending == m_pending.end())
+			return -2;
+		if (!pending->second.done)
+			return -1;
+
+		int found = pending->second.found;
+		if (result != nullptr)
+			*result = pending->second.info;
+		m_pending.erase(pending);
+		return found;
+	}
+
+	int PupilDetect::TrackCenter(int eye, BYTE * pixels, int width, int height, int originX, int originY, PupilTrack* track)
+	{
+		if (eye < 0 || eye >= kTrackedEyes || pixels == nullptr || width <= 0 || height <= 0 || track == nullptr)
+			return 0;
+
+		std::lock_guard<std::mutex> lock(m_trackerLocks[eye]);
+		PupilTracker &tracker = m_trackers[eye];
+		const PupilDetectSettings settings = CopySettings();
+
+		cv::Point2f origin((float)originX, (float)originY);
+		cv::Rect crop(0, 0, width, height);
+		cv::Rect search = crop;
+		if (tracker.IsTracking())
+		{
+			cv::Point2f predicted = tracker.Predict() - origin;
+			if (tracker.Confidence() >= settings.TrackMinConfidence)
+			{
+				int radius = (std::max)(1, (int)ceil(settings.TrackRadius));
+				search = cv::Rect((int)floor(predicted.x + 0.5f) - radius, (int)floor(predicted.y + 0.5f) - radius, 2 * radius + 1, 2 * radius + 1) & crop;
+				if (search.area() == 0)
+					search = crop;
+			}
+		}
+		bool windowed = (search != crop);
+
+		// the window is searched at the resolution the whole crop would have been
+		int fastEyeWidth = 0;
+		if (windowed)
+			fastEyeWidth = (std::max)(kMinFastEyeWidth, (int)floor((float)settings.FastEyeWidth * search.width / width + 0.5f));
+
+		Mat image(height, width, CV_8UC4, pixels);
+		PupilInfo info = {};
+		float quality = 0.0f;
+		int found = FindCenter(image(search), &info, false, std::string(), fastEyeWidth, &quality);
+		if (found)
+		{
+			cv::Point2f measured = origin + cv::Point2f(search.x + info.CenterX, search.y + info.CenterY);
+			tracker.Correct(measured, quality, windowed ? settings.TrackRadius : (float)(std::max)(width, height));
+		}
+		else
+		{
+			tracker.Miss();
+		}
+
+		cv::Point2f center = tracker.Center() - origin;
+		*track = PupilTrack{ center.x, center.y, tracker.Confidence(), windowed ? 1 : 0 };
+		return found;
+	}
+
+	void PupilDetect::ResetTracking(int eye)
+	{
+		for (int i = 0; i < kTrackedEyes; i++)
+		{
+			if (eye == i || eye == -1)
+			{
+				std::lock_guard<std::mutex> lock(m_trackerLocks[i]);
+				m_trackers[i].Reset();
+			}
+		}
+	}
+
+	int PupilDetect::FindCenter(const cv::Mat &bgra, PupilInfo *info, bool writeFiles, const std::string &fileNamePrefix, int fastEyeWidth, float *confidence)
+	{
 		if (writeFiles)
-			imwrite(prefix + "_bigger.png", biggerImg, compression_params);
-
-
-		Mat grayImg;
-		cvtColor(biggerImg, grayImg, CV_BGRA2GRAY);
-		cv::Rect eyeRegion(0, 0, width * scale, height * scale);
-		auto eyeCenter = EyeCenter::EyeCenter();
-		eyeCenter.kFastEyeWidth = m_settings.FastEyeWidth;
-		eyeCenter.kWeightBlurSize = m_settings.WeightBlurSize;
-		eyeCenter.kEnableWeight = m_settings.EnableWeight;
-		eyeCenter.kWeightDivisor = m_settings.WeightDivisor;
-		eyeCenter.kGradientThreshold = m_settings.GradientThreshold;
-		eyeCenter.kEnablePostProcess = m_settings.EnablePostProcess;
-		eyeCenter.kPostProcessThreshold = m_settings.PostProcessThreshold;
-		eyeCenter.kMaxMag = m_settings.MaxMag;
-		cv::Point pupil = eyeCenter.findEyeCenter(grayImg, eyeRegion, "", writeFiles, prefix);
-		PupilInfo *info = new PupilInfo{ (float)pupil.x / scale, (float)pupil.y / scale };
-		*irisInfo = info;
-		return 1;// result;
+			m_debugSink.Write(fileNamePrefix + "_orig.png", bgra);
+
+		const PupilDetectSettings settings = CopySettings();
+		auto eyeCenter = AcquireEyeCenter();
+		eyeCenter->kFastEyeWidth = (fastEyeWidth > 0) ? fastEyeWidth : settings.FastEyeWidth;
+		eyeCenter->kWeightBlurSize = settings.WeightBlurSize;
+		eyeCenter->kEnableWeight = settings.EnableWeight;
+		eyeCenter->kWeightDivisor = settings.WeightDivisor;
+		eyeCenter->kGradientThreshold = settings.GradientThreshold;
+		eyeCenter->kEnablePostProcess = settings.EnablePostProcess;
+		eyeCenter->kPostProcessThreshold = settings.PostProcessThreshold;
+		eyeCenter->kMaxMag = settings.MaxMag;
+		eyeCenter->kPyramidLevels = settings.PyramidLevels;
+		eyeCenter->kPyramidCandidates = settings.PyramidCandidates;
+		eyeCenter->pool = &m_pool;
+		eyeCenter->debugSink = &m_debugSink;
+		try
+		{
+			// the BGRA pixels go straight to the fast size, there is no need to scale them up by ScaleInput first
+			cv::Point2f pupil = eyeCenter->findEyeCenterBGRA(bgra, writeFiles, fileNamePrefix);
+			*info = PupilInfo{ pupil.x, pupil.y };
+			if (confidence != nullptr)
+				*confidence = eyeCenter->confidence;
+		}
+		catch (const cv::Exception &)
+		{
+			// searches also run on the pool threads, where nobody could catch this
+			ReleaseEyeCenter(std::move(eyeCenter));
+			return 0;
+		}
+		ReleaseEyeCenter(std::move(eyeCenter));
+		return 1;
+	}
+
+	std::unique_ptr<EyeCenter> PupilDetect::AcquireEyeCenter()
+	{
+		std::lock_guard<std::mutex> lock(m_eyeCentersLock);
+		if (m_idleEyeCenters.empty())
+			return std::unique_ptr<EyeCenter>(new EyeCenter());
+
+		auto eyeCenter = std::move(m_idleEyeCenters.back());
+		m_idleEyeCenters.pop_back();
+		return eyeCenter;
+	}
+
+	void PupilDetect::ReleaseEyeCenter(std::unique_ptr<EyeCenter> eyeCenter)
+	{
+		std::lock_guard<std::mutex> lock(m_eyeCentersLock);
+		m_idleEyeCenters.push_back(std::move(eyeCenter));
 	}
 
 }
\ No newline at end of file
@@ -3,6 +3,15 @@
 
 #pragma once
 #include "PupilDetectExports.h"
+#include "WorkerPool.h"
+#include "DebugImageSink.h"
+#include "findEyeCenter.h"
+#include "PupilTracker.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace PupilDetect
 {
@@ -19,11 +28,59 @@ namespace PupilDetect
 			false, 		//	EnablePostProcess
 			0.95f,		//	PostProcessThreshold
 			50,			//	MaxMag
+			10.0f,		//	TrackRadius
+			0.2f,		//	TrackMinConfidence
+			0,			//	PyramidLevels
+			3,			//	PyramidCandidates
 		};
+		// SetSettings can come in while searches run on the pool, so they work from a copy taken under this
+		std::mutex m_settingsLock;
+		PupilDetectSettings CopySettings();
+
+		// shared by all FindCenter calls
+		WorkerPool m_pool;
+		// writeFiles images go through here
+		DebugImageSink m_debugSink;
+
+		// An EyeCenter keeps its scratch images between calls. Both eyes can be searched at once,
+		// so each call takes one nobody else is using.
+		std::mutex m_eyeCentersLock;
+		std::vector<std::unique_ptr<EyeCenter>> m_idleEyeCenters;
+
+		std::unique_ptr<EyeCenter> AcquireEyeCenter();
+		void ReleaseEyeCenter(std::unique_ptr<EyeCenter> eyeCenter);
+
+		// searches started by SubmitFindCenter, by ticket, until they are polled
+		struct PendingCenter
+		{
+			bool done;
+			int found;
+			PupilInfo info;
+		};
+		std::mutex m_pendingLock;
+		std::condition_variable m_pendingIdle;
+		std::map<int, PendingCenter> m_pending;
+		int m_nextTicket = 1;
+		int m_running = 0;
+
+		// TrackCenter state per eye, the two eyes can be tracked at the same time
+		static const int kTrackedEyes = 2;
+		PupilTracker m_trackers[kTrackedEyes];
+		std::mutex m_trackerLocks[kTrackedEyes];
+
+		// the search behind all of the FindCenter variants, 1 if a center was found.
+		// fastEyeWidth overrides the FastEyeWidth setting, confidence is the EyeCenter's for the search.
+		int FindCenter(const cv::Mat &bgra, PupilInfo *info, bool writeFiles, const std::string &fileNamePrefix, int fastEyeWidth = 0, float *confidence = nullptr);
 
 	public:
 		PupilDetect() {}
+		~PupilDetect();
 		int FindCenter(BYTE * pixels, int width, int height, PupilInfo** irisInfo, bool writeFiles, const char *fileNamePrefix);
+		int FindCenters(const PupilImage* images, int count, PupilInfo* results, int* found);
+		int SubmitFindCenter(BYTE * pixels, int width, int height);
+		int PollFindCenter(int ticket, PupilInfo* result);
+		int TrackCenter(int eye, BYTE * pixels, int width, int height, int originX, int originY, PupilTrack* track);
+		void ResetTracking(int eye);
 		void SetSettings(PupilDetectSettings*);
 		PupilDetectSettings* GetSettings();
 	};
@@ -7,13 +7,32 @@
 class __declspec(dllexport) IPupilDetect
 {
 public:
+	virtual ~IPupilDetect() {}
 	virtual int FindCenter(BYTE * pixels, int width, int height, PupilDetect::PupilInfo**, bool writeFiles, const char * fileName) = 0;
+	virtual int FindCenters(const PupilDetect::PupilImage* images, int count, PupilDetect::PupilInfo* results, int* found) = 0;
+	virtual int SubmitFindCenter(BYTE * pixels, int width, int height) = 0;
+	virtual int PollFindCenter(int ticket, PupilDetect::PupilInfo* result) = 0;
+	virtual int TrackCenter(int eye, BYTE * pixels, int width, int height, int originX, int originY, PupilDetect::PupilTrack* track) = 0;
+	virtual void ResetTracking(int eye) = 0;
 	virtual void SetSettings(PupilDetect::PupilDetectSettings*) = 0;
 	virtual PupilDetect::PupilDetectSettings* GetSettings() = 0;
 };
 
 extern "C" __declspec(dllexport) IPupilDetect* CreatePupilDetect();
 extern "C" __declspec(dllexport) int FindCenter(IPupilDetect*, BYTE * pixels, int width, int height, PupilDetect::PupilInfo**, bool writeFiles, const char * fileName);
+// Searches all of images at once, results[i] and found[i] are filled in for images[i]. Returns how many were found.
+extern "C" __declspec(dllexport) int FindCenters(IPupilDetect*, const PupilDetect::PupilImage* images, int count, PupilDetect::PupilInfo* results, int* found);
+// Copies the pixels and searches them in the background. Returns a ticket for PollFindCenter, or 0 if too many searches are pending.
+extern "C" __declspec(dllexport) int SubmitFindCenter(IPupilDetect*, BYTE * pixels, int width, int height);
+// 1 and result filled in if the search for ticket found a center, 0 if it did not, -1 while it is still running, -2 for an unknown ticket.
+// A ticket can no longer be polled once it returned 0 or 1.
+extern "C" __declspec(dllexport) int PollFindCenter(IPupilDetect*, int ticket, PupilDetect::PupilInfo* result);
+// Follows the pupil of eye (0 left, 1 right) over the frames, searching only around where it is predicted to be
+// while the confidence is high enough. originX/Y is where the crop is in the frame, so the crop itself can move.
+// track is filled in while the eye is tracked, returns 1 if a center was found in this frame.
+extern "C" __declspec(dllexport) int TrackCenter(IPupilDetect*, int eye, BYTE * pixels, int width, int height, int originX, int originY, PupilDetect::PupilTrack* track);
+// forgets what is known about eye, -1 for both
+extern "C" __declspec(dllexport) void ResetTracking(IPupilDetect*, int eye);
 extern "C" __declspec(dllexport) void SetSettings(IPupilDetect*, PupilDetect::PupilDetectSettings*);
 extern "C" __declspec(dllexport) PupilDetect::PupilDetectSettings* GetSettings(IPupilDetect*);
 extern "C" __declspec(dllexport) void DestroyPupilDetect(IPupilDetect*);
\ No newline at end of file
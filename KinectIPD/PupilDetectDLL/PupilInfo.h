@@ -11,9 +11,47 @@ namespace PupilDetect
 		float CenterY;
 	};
 
+	// result of TrackCenter, in pixels of the eye crop
+	struct PupilTrack
+	{
+		float CenterX;			// smoothed over the frames
+		float CenterY;
+		float Confidence;		// 0..1, the whole crop is searched again while this is below TrackMinConfidence
+		int Windowed;			// 1 if only the window around the prediction was searched
+	};
+
+	struct IpdEstimatorSettings
+	{
+		int WindowSize;			// latest samples the median and MAD are taken over
+		int MinSamples;			// accepted samples needed before the estimate can converge
+		float MinIpd;			// mm, samples outside of MinIpd..MaxIpd are rejected outright
+		float MaxIpd;
+		float OutlierThreshold;	// samples further from the median than this many robust standard deviations are rejected
+		float ConvergedHalfWidth;	// mm, converged once the 95% confidence interval is no wider than this either side
+	};
+
+	// where the IPD estimate stands after a sample, in mm
+	struct IpdEstimate
+	{
+		float Ipd;				// mean of the accepted samples
+		float Low;				// 95% confidence interval of Ipd
+		float High;
+		int Accepted;
+		int Rejected;
+		int Converged;
+	};
+
+	// one eye crop for FindCenters, BGRA
+	struct PupilImage
+	{
+		BYTE* Pixels;
+		int Width;
+		int Height;
+	};
+
 	struct PupilDetectSettings
 	{
-		int ScaleInput;
+		int ScaleInput;			// no longer used, the eye is resampled straight to FastEyeWidth
 		int FastEyeWidth;
 		int WeightBlurSize;
 		bool EnableWeight;
@@ -22,5 +60,9 @@ namespace PupilDetect
 		bool EnablePostProcess;
 		float PostProcessThreshold;
 		float MaxMag;
+		float TrackRadius;		// pixels of the eye crop around the predicted center that TrackCenter searches
+		float TrackMinConfidence;
+		int PyramidLevels;		// 0 searches at FastEyeWidth only, 1-2 vote on an image halved that often and refine upwards
+		int PyramidCandidates;	// centers carried up from the smallest level, more is slower but less likely to miss
 	};
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "PupilTracker.h"
+
+#include <algorithm>
+
+// state is x, y, vx, vy; one step per frame
+const float kProcessNoise = 0.5f;
+// pixels^2, for a measurement of quality 1
+const float kMeasurementNoise = 2.0f;
+// how much of the confidence comes from the latest frame
+const float kConfidenceRate = 0.5f;
+
+namespace PupilDetect
+{
+	PupilTracker::PupilTracker()
+		: m_filter(4, 2, 0, CV_32F)
+	{
+		m_filter.transitionMatrix = (cv::Mat_<float>(4, 4) <<
+			1, 0, 1, 0,
+			0, 1, 0, 1,
+			0, 0, 1, 0,
+			0, 0, 0, 1);
+		cv::setIdentity(m_filter.measurementMatrix);
+		cv::setIdentity(m_filter.processNoiseCov, cv::Scalar::all(kProcessNoise));
+		Reset();
+	}
+
+	void PupilTracker::Reset()
+	{
+		m_tracking = false;
+		m_confidence = 0.0f;
+	}
+
+	cv::Point2f PupilTracker::Predict()
+	{
+		if (!m_tracking)
+			return m_center;
+
+		const cv::Mat &prediction = m_filter.predict();
+		return cv::Point2f(prediction.at<float>(0), prediction.at<float>(1));
+	}
+
+	void PupilTracker::Correct(const cv::Point2f &measured, float quality, float searchRadius)
+	{
+		quality = (std::min)((std::max)(quality, 0.0f), 1.0f);
+
+		if (!m_tracking)
+		{
+			// start out at rest where the pupil was found
+			m_filter.statePost = (cv::Mat_<float>(4, 1) << measured.x, measured.y, 0, 0);
+			cv::setIdentity(m_filter.errorCovPost, cv::Scalar::all(kMeasurementNoise));
+			m_center = measured;
+			m_confidence = quality;
+			m_tracking = true;
+			return;
+		}
+
+		// a measurement far from the prediction, or one that barely stood out, counts for less
+		cv::Point2f predicted(m_filter.statePre.at<float>(0), m_filter.statePre.at<float>(1));
+		cv::Point2f innovation = measured - predicted;
+		float agreement = (std::max)(0.0f, 1.0f - (float)cv::norm(innovation) / (std::max)(searchRadius, 1.0f));
+		float frameConfidence = quality * agreement;
+
+		cv::setIdentity(m_filter.measurementNoiseCov, cv::Scalar::all(kMeasurementNoise / (std::max)(frameConfidence, 0.05f)));
+		const cv::Mat &state = m_filter.correct((cv::Mat_<float>(2, 1) << measured.x, measured.y));
+		m_center = cv::Point2f(state.at<float>(0), state.at<float>(1));
+		m_confidence += kConfidenceRate * (frameConfidence - m_confidence);
+	}
+
+	void PupilTracker::Miss()
+	{
+		if (!m_tracking)
+			return;
+
+		// coast on the prediction
+		m_filter.statePost = m_filter.statePre.clone();
+		m_filter.errorCovPost = m_filter.errorCovPre.clone();
+		m_center = cv::Point2f(m_filter.statePost.at<float>(0), m_filter.statePost.at<float>(1));
+		m_confidence -= kConfidenceRate * m_confidence;
+	}
+}
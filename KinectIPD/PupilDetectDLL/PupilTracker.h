@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include <opencv2/video/tracking.hpp>
+
+namespace PupilDetect
+{
+	// Follows one pupil from frame to frame with a constant velocity Kalman filter on its center, in frame pixels.
+	// The confidence says how well the measurements agree with the filter, below a threshold the caller
+	// should search the whole eye again instead of the window around the prediction.
+	class PupilTracker
+	{
+	public:
+		PupilTracker();
+
+		void Reset();
+		bool IsTracking() const { return m_tracking; }
+
+		// moves the filter on by one frame and returns the predicted center
+		cv::Point2f Predict();
+		// after Predict; quality is 0..1, how much the measured center stood out of the search, searchRadius is how far
+		// from the prediction it could have been
+		void Correct(const cv::Point2f &measured, float quality, float searchRadius);
+		// no center was found this frame
+		void Miss();
+
+		cv::Point2f Center() const { return m_center; }
+		float Confidence() const { return m_confidence; }
+
+	private:
+		cv::KalmanFilter m_filter;
+		cv::Point2f m_center;
+		float m_confidence = 0.0f;
+		bool m_tracking = false;
+	};
+}
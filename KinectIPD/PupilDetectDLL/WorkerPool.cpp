@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "WorkerPool.h"
+
+namespace PupilDetect
+{
+	WorkerPool::WorkerPool(int threadCount)
+	{
+		if (threadCount <= 0)
+		{
+			threadCount = (std::max)(1, (int)std::thread::hardware_concurrency() - 1);
+		}
+
+		for (int i = 0; i < threadCount; i++)
+		{
+			m_threads.emplace_back(&WorkerPool::Run, this);
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	void WorkerPool::Run()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				m_wake.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+				if (m_stop)
+				{
+					return;
+				}
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	void WorkerPool::Post(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_tasks.push_back(std::move(task));
+		}
+		m_wake.notify_one();
+	}
+
+	void WorkerPool::ParallelFor(int count, const std::function<void(int)>& task)
+	{
+		if (count <= 0)
+		{
+			return;
+		}
+
+		struct State
+		{
+			const std::function<void(int)>* task;
+			int count;
+			std::atomic<int> next;
+			std::atomic<int> completed;
+			std::mutex lock;
+			std::condition_variable done;
+		};
+
+		auto state = std::make_shared<State>();
+		state->task = &task;
+		state->count = count;
+		state->next = 0;
+		state->completed = 0;
+
+		// Whoever gets to an index first runs it.  A helper that starts after the last index was taken
+		// returns without touching task, which may be gone by then.
+		auto work = [state]()
+		{
+			int i;
+			while ((i = state->next++) < state->count)
+			{
+				(*state->task)(i);
+
+				if (++state->completed == state->count)
+				{
+					std::lock_guard<std::mutex> lock(state->lock);
+					state->done.notify_all();
+				}
+			}
+		};
+
+		int helpers = (std::min)(ThreadCount(), count - 1);
+		if (helpers > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				for (int i = 0; i < helpers; i++)
+				{
+					m_tasks.push_back(work);
+				}
+			}
+			m_wake.notify_all();
+		}
+
+		work();
+
+		std::unique_lock<std::mutex> lock(state->lock);
+		state->done.wait(lock, [&state] { return state->completed == state->count; });
+	}
+}
@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PupilDetect
+{
+	// Threads that live as long as the detector, so no threads are started per frame.
+	class WorkerPool
+	{
+	public:
+		// 0 uses one thread less than there are cores, the calling thread makes up the difference.
+		// There is always at least one thread, so posted tasks get run.
+		explicit WorkerPool(int threadCount = 0);
+		~WorkerPool();
+
+		int ThreadCount() const { return (int)m_threads.size(); }
+
+		// Runs task(0) .. task(count - 1) on the pool and the calling thread, returns once all of them are done.
+		// Safe to call from several threads at once.
+		void ParallelFor(int count, const std::function<void(int)>& task);
+
+		// Queues task to run on one of the pool threads and returns right away.
+		void Post(std::function<void()> task);
+
+	private:
+		void Run();
+
+		std::vector<std::thread> m_threads;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_lock;
+		std::condition_variable m_wake;
+		bool m_stop = false;
+	};
+}
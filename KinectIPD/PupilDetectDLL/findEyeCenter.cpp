@@ -20,12 +20,23 @@
 #include <iostream>
 #include <queue>
 #include <stdio.h>
+#include <emmintrin.h>
 
 #include "constants.h"
 #include "helpers.h"
+#include "WorkerPool.h"
+#include "DebugImageSink.h"
+
+// gradient rows voting into the same accumulator
+const int kVoteBandRows = 8;
+// the smallest pyramid level is kept at least this wide
+const int kMinPyramidWidth = 12;
+// how far around a candidate from the level below the refinement looks, and how far apart candidates are
+const int kRefineRadius = 2;
+const int kCandidateSpacing = 2;
 
 // Pre-declarations
-cv::Mat floodKillEdges(cv::Mat &mat);
+void floodKillEdges(cv::Mat &mat, cv::Mat &mask, std::vector<cv::Point> &stack);
 
 #pragma mark Visualization
 /*
@@ -68,83 +79,269 @@ void scaleToFastSize(const cv::Mat &src, cv::Mat &dst, float kFastEyeWidth) {
 	cv::resize(src, dst, cv::Size(kFastEyeWidth, (((float)kFastEyeWidth) / src.cols) * src.rows));
 }
 
-cv::Mat computeMatXGradient(const cv::Mat &mat) {
-	cv::Mat out(mat.rows, mat.cols, CV_64F);
+inline float bgraToGray(const uchar *p) {
+	// same weights as CV_BGRA2GRAY
+	return 0.114f * p[0] + 0.587f * p[1] + 0.299f * p[2];
+}
+
+// Bilinear resample of a BGRA image to width x height, converting it to gray in the same pass.
+// Pixel centers are mapped the way cv::resize maps them.
+void resampleToGray(const cv::Mat &bgra, cv::Mat &dst, int width, int height) {
+	dst.create(height, width, CV_8U);
+	float scaleX = (float)bgra.cols / width, scaleY = (float)bgra.rows / height;
 
-	for (int y = 0; y < mat.rows; ++y) {
-		const uchar *Mr = mat.ptr<uchar>(y);
-		double *Or = out.ptr<double>(y);
+	std::vector<int> srcX(width);
+	std::vector<float> weightX(width);
+	for (int x = 0; x < width; ++x) {
+		float sx = std::min(std::max((x + 0.5f) * scaleX - 0.5f, 0.0f), (float)(bgra.cols - 1));
+		srcX[x] = (int)sx;
+		weightX[x] = sx - srcX[x];
+	}
+
+	for (int y = 0; y < height; ++y) {
+		float sy = std::min(std::max((y + 0.5f) * scaleY - 0.5f, 0.0f), (float)(bgra.rows - 1));
+		int y0 = (int)sy, y1 = std::min(y0 + 1, bgra.rows - 1);
+		float wy = sy - y0;
+		const uchar *Tr = bgra.ptr<uchar>(y0), *Br = bgra.ptr<uchar>(y1);
+		uchar *Dr = dst.ptr<uchar>(y);
+		for (int x = 0; x < width; ++x) {
+			int x0 = srcX[x] * 4, x1 = std::min(srcX[x] + 1, bgra.cols - 1) * 4;
+			float wx = weightX[x];
+			float top = bgraToGray(Tr + x0) + (bgraToGray(Tr + x1) - bgraToGray(Tr + x0)) * wx;
+			float bottom = bgraToGray(Br + x0) + (bgraToGray(Br + x1) - bgraToGray(Br + x0)) * wx;
+			Dr[x] = cv::saturate_cast<uchar>(top + (bottom - top) * wy);
+		}
+	}
+}
 
-		Or[0] = Mr[1] - Mr[0];
-		for (int x = 1; x < mat.cols - 1; ++x) {
-			Or[x] = (Mr[x + 1] - Mr[x - 1]) / 2.0;
+// X and Y gradients of mat along with their magnitudes, in one pass and without transposing for Y.
+// Central differences inside, one sided at the edges. Returns the dynamic threshold of the magnitudes,
+// the same as computeDynamicThreshold(mags, stdDevFactor).
+double computeGradients(const cv::Mat &mat, cv::Mat &gradientX, cv::Mat &gradientY, cv::Mat &mags, double stdDevFactor) {
+	gradientX.create(mat.rows, mat.cols, CV_64F);
+	gradientY.create(mat.rows, mat.cols, CV_64F);
+	mags.create(mat.rows, mat.cols, CV_64F);
+
+	double sum = 0.0, sumSquares = 0.0;
+	for (int y = 0; y < mat.rows; ++y) {
+		int yUp = std::max(y - 1, 0), yDown = std::min(y + 1, mat.rows - 1);
+		double scaleY = (yDown - yUp == 2) ? 0.5 : 1.0;
+		const uchar *Mr = mat.ptr<uchar>(y), *Ur = mat.ptr<uchar>(yUp), *Dr = mat.ptr<uchar>(yDown);
+		double *Xr = gradientX.ptr<double>(y), *Yr = gradientY.ptr<double>(y), *Gr = mags.ptr<double>(y);
+		for (int x = 0; x < mat.cols; ++x) {
+			int xLeft = std::max(x - 1, 0), xRight = std::min(x + 1, mat.cols - 1);
+			double gX = (Mr[xRight] - Mr[xLeft]) * ((xRight - xLeft == 2) ? 0.5 : 1.0);
+			double gY = (Dr[x] - Ur[x]) * scaleY;
+			double magnitude = sqrt((gX * gX) + (gY * gY));
+			Xr[x] = gX;
+			Yr[x] = gY;
+			Gr[x] = magnitude;
+			sum += magnitude;
+			sumSquares += magnitude * magnitude;
 		}
-		Or[mat.cols - 1] = Mr[mat.cols - 1] - Mr[mat.cols - 2];
 	}
 
-	return out;
+	double count = (double)mat.rows * mat.cols;
+	double mean = sum / count;
+	double stdDev = sqrt(std::max(0.0, sumSquares / count - mean * mean));
+	return stdDevFactor * (stdDev / sqrt(count)) + mean;
 }
 
 #pragma mark Main Algorithm
 
-void testPossibleCentersFormula(int x, int y, const cv::Mat &weight, double gx, double gy, cv::Mat &out, bool kEnableWeight, float kWeightDivisor, float kMaxMag) {
-	// for all possible centers
-	for (int cy = 0; cy < out.rows; ++cy) {
-		double *Or = out.ptr<double>(cy);
-		const unsigned char *Wr = weight.ptr<unsigned char>(cy);
-		for (int cx = 0; cx < out.cols; ++cx) {
-			if (x == cx && y == cy) {
+// Only candidates within kMaxMag of the gradient can get a vote, so instead of visiting the whole
+// image each gradient votes into the (2 * radius + 1)^2 window around it, using the displacement table
+// in place of the sqrt and divides. Candidates outside of kMaxMag have a 0 entry in the table.
+void testPossibleCentersWindow(int x, int y, float gx, float gy, const cv::Mat &weight, cv::Mat &out, const float *displacementX, const float *displacementY, int radius) {
+	int stride = 2 * radius + 1;
+	int x0 = std::max(0, x - radius), x1 = std::min(out.cols - 1, x + radius);
+	int y0 = std::max(0, y - radius), y1 = std::min(out.rows - 1, y + radius);
+	int count = x1 - x0 + 1;
+
+	const __m128 gxv = _mm_set1_ps(gx);
+	const __m128 gyv = _mm_set1_ps(gy);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int cy = y0; cy <= y1; ++cy) {
+		float *Or = out.ptr<float>(cy) + x0;
+		const float *Wr = weight.ptr<float>(cy) + x0;
+		int offset = (cy - y + radius) * stride + (x0 - x + radius);
+		const float *Dx = displacementX + offset;
+		const float *Dy = displacementY + offset;
+
+		int cx = 0;
+		for (; cx + 4 <= count; cx += 4) {
+			__m128 dotProduct = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(Dx + cx), gxv), _mm_mul_ps(_mm_loadu_ps(Dy + cx), gyv));
+			dotProduct = _mm_max_ps(dotProduct, zero);
+			// square and multiply by the weight
+			__m128 vote = _mm_mul_ps(_mm_mul_ps(dotProduct, dotProduct), _mm_loadu_ps(Wr + cx));
+			_mm_storeu_ps(Or + cx, _mm_add_ps(_mm_loadu_ps(Or + cx), vote));
+		}
+		for (; cx < count; ++cx) {
+			float dotProduct = std::max(0.0f, Dx[cx] * gx + Dy[cx] * gy);
+			Or[cx] += dotProduct * dotProduct * Wr[cx];
+		}
+	}
+}
+
+// The table testPossibleCentersWindow votes with, for each candidate center in the window the normalized vector
+// to the gradient at its middle. 0 for the middle itself and for candidates further away than maxMag.
+void buildDisplacementTable(int radius, float maxMag, std::vector<float> &displacementX, std::vector<float> &displacementY) {
+	int stride = 2 * radius + 1;
+	displacementX.assign(stride * stride, 0.0f);
+	displacementY.assign(stride * stride, 0.0f);
+	for (int oy = -radius; oy <= radius; ++oy) {
+		for (int ox = -radius; ox <= radius; ++ox) {
+			if (ox == 0 && oy == 0) {
 				continue;
 			}
-			// create a vector from the possible center to the gradient origin
-			double dx = x - cx;
-			double dy = y - cy;
-			// normalize d
-			double magnitude = sqrt((dx * dx) + (dy * dy));
-			if (magnitude > kMaxMag)
+			// the vector goes from the candidate center at (ox, oy) to the gradient at (0, 0)
+			double magnitude = sqrt((double)(ox * ox + oy * oy));
+			if (magnitude > maxMag)
 				continue;
-			dx = dx / magnitude;
-			dy = dy / magnitude;
-			double dotProduct = dx*gx + dy*gy;
-			dotProduct = std::max(0.0, dotProduct);
-			// square and multiply by the weight
-			if (kEnableWeight) {
-				Or[cx] += dotProduct * dotProduct * (Wr[cx] / kWeightDivisor);
-			}
-			else {
-				Or[cx] += dotProduct * dotProduct;
-			}
+			int i = (oy + radius) * stride + (ox + radius);
+			displacementX[i] = (float)(-ox / magnitude);
+			displacementY[i] = (float)(-oy / magnitude);
 		}
 	}
 }
 
+void EyeCenter::updateDisplacementTable(int radius, float maxMag) {
+	if (radius == m_displacementRadius && maxMag == m_displacementMaxMag) {
+		return;
+	}
+
+	buildDisplacementTable(radius, maxMag, m_displacementX, m_displacementY);
+	m_displacementRadius = radius;
+	m_displacementMaxMag = maxMag;
+}
+
+void EyeCenter::writeDebugImage(const std::string &fileName, const cv::Mat &image) {
+	if (debugSink != nullptr) {
+		debugSink->Write(fileName, image);
+	}
+	else {
+		cv::imwrite(fileName, image);
+	}
+}
+
 cv::Point EyeCenter::findEyeCenter(cv::Mat face, cv::Rect eye, std::string debugWindow, bool writeFiles, const std::string fileNamePrefix) {
 	cv::Mat eyeROIUnscaled = face(eye);
-	cv::Mat eyeROI;
-	scaleToFastSize(eyeROIUnscaled, eyeROI, kFastEyeWidth);
+	scaleToFastSize(eyeROIUnscaled, m_eyeROI, kFastEyeWidth);
 	//cv::equalizeHist(eyeROI, eyeROI);
 	// draw eye region
 	//rectangle(face,eye,1234);
-	int width = eyeROI.cols;
-	int height = eyeROI.rows;
-
-	//-- Find the gradient
-	cv::Mat gradientX = computeMatXGradient(eyeROI);
-	cv::Mat gradientY = computeMatXGradient(eyeROI.t()).t();
-	
-
-	//-- Normalize and threshold the gradient
-	// compute all the magnitudes
-	cv::Mat mags = matrixMagnitude(gradientX, gradientY);
-	//compute the threshold
-	double gradientThresh = computeDynamicThreshold(mags, kGradientThreshold);
+	if (writeFiles)
+		writeDebugImage(fileNamePrefix + "_eyeROIUnscaled.png", eyeROIUnscaled);
+
+	cv::Point maxP = findFastEyeCenter(m_eyeROI, writeFiles, fileNamePrefix);
+
+	if (writeFiles) {
+		cv::Mat visual;
+		cvtColor(face, visual, CV_GRAY2BGR);
+		auto center = unscalePoint(maxP, eye, kFastEyeWidth);
+		line(visual, cv::Point2f(center.x, 0), cv::Point2f(center.x, visual.rows), cv::Scalar(0, 0, 255, 0), 2);
+		line(visual, cv::Point2f(0, center.y), cv::Point2f(visual.cols, center.y), cv::Scalar(0, 0, 255, 0), 2);
+		writeDebugImage(fileNamePrefix + "_center.png", visual);
+	}
+	return unscalePoint(maxP, eye, kFastEyeWidth);
+}
+
+cv::Point2f EyeCenter::findEyeCenterBGRA(const cv::Mat &bgra, bool writeFiles, const std::string &fileNamePrefix) {
+	int height = std::max(1, (int)((((float)kFastEyeWidth) / bgra.cols) * bgra.rows));
+	resampleToGray(bgra, m_eyeROI, kFastEyeWidth, height);
+	if (writeFiles)
+		writeDebugImage(fileNamePrefix + "_eyeROI.png", m_eyeROI);
+
+	cv::Point maxP = findFastEyeCenter(m_eyeROI, writeFiles, fileNamePrefix);
+
+	// back through the pixel center mapping the resample used
+	cv::Point2f center((maxP.x + 0.5f) * bgra.cols / m_eyeROI.cols - 0.5f, (maxP.y + 0.5f) * bgra.rows / m_eyeROI.rows - 0.5f);
+	if (writeFiles) {
+		cv::Mat visual;
+		cvtColor(bgra, visual, CV_BGRA2BGR);
+		line(visual, cv::Point2f(center.x, 0), cv::Point2f(center.x, visual.rows), cv::Scalar(0, 0, 255, 0), 1);
+		line(visual, cv::Point2f(0, center.y), cv::Point2f(visual.cols, center.y), cv::Scalar(0, 0, 255, 0), 1);
+		writeDebugImage(fileNamePrefix + "_center.png", visual);
+	}
+	return center;
+}
+
+cv::Point EyeCenter::findFastEyeCenter(const cv::Mat &eyeROI, bool writeFiles, const std::string &fileNamePrefix) {
+	int levels = std::max(0, kPyramidLevels);
+	while (levels > 0 && (eyeROI.cols >> levels) < kMinPyramidWidth) {
+		--levels;
+	}
+	m_levels.resize(levels + 1);
+	m_levels[0].eye = eyeROI;
+	for (int l = 1; l <= levels; ++l) {
+		cv::pyrDown(m_levels[l - 1].eye, m_levels[l].eye);
+	}
+	for (int l = 0; l <= levels; ++l) {
+		prepareLevel(m_levels[l], std::max(1, (kWeightBlurSize >> l) | 1), writeFiles && l == 0, fileNamePrefix);
+	}
+
+	cv::Point maxP = voteAllCenters(m_levels[levels], kMaxMag / (1 << levels), writeFiles, fileNamePrefix);
+	if (levels == 0 || maxP.x < 0) {
+		return maxP;
+	}
+
+	//-- Take the best few centers of the smallest level, keeping them apart
+	if (!kEnablePostProcess) {
+		m_mask.create(m_outSum.rows, m_outSum.cols, CV_8U);
+		m_mask.setTo(255);
+	}
+	m_candidates.assign(1, maxP);
+	for (int i = 1; i < kPyramidCandidates; ++i) {
+		cv::circle(m_mask, m_candidates.back(), kCandidateSpacing, cv::Scalar(0), -1);
+		cv::Point p;
+		double value;
+		cv::minMaxLoc(m_outSum, NULL, &value, NULL, &p, m_mask);
+		if (p.x < 0 || value <= 0.0) {
+			break;
+		}
+		m_candidates.push_back(p);
+	}
+
+	//-- Refine them on the way up, only looking near where they were on the level below
+	cv::Point best = maxP;
+	for (int l = levels - 1; l >= 0; --l) {
+		const SearchLevel &level = m_levels[l];
+		float maxMag = kMaxMag / (1 << l);
+		double bestValue = -1.0;
+		for (cv::Point &candidate : m_candidates) {
+			int x0 = std::max(0, candidate.x * 2 - kRefineRadius), x1 = std::min(level.eye.cols - 1, candidate.x * 2 + kRefineRadius);
+			int y0 = std::max(0, candidate.y * 2 - kRefineRadius), y1 = std::min(level.eye.rows - 1, candidate.y * 2 + kRefineRadius);
+			double candidateValue = -1.0;
+			for (int cy = y0; cy <= y1; ++cy) {
+				for (int cx = x0; cx <= x1; ++cx) {
+					double value = evaluateCenter(level, cx, cy, maxMag);
+					if (value > candidateValue) {
+						candidateValue = value;
+						candidate = cv::Point(cx, cy);
+					}
+				}
+			}
+			if (candidateValue > bestValue) {
+				bestValue = candidateValue;
+				best = candidate;
+			}
+		}
+	}
+	return best;
+}
+
+void EyeCenter::prepareLevel(SearchLevel &level, int weightBlurSize, bool writeFiles, const std::string &fileNamePrefix) {
+	const cv::Mat &eye = level.eye;
+	//-- Find the gradient, compute all the magnitudes and the threshold
+	double gradientThresh = computeGradients(eye, level.gradientX, level.gradientY, level.mags, kGradientThreshold);
 	//double gradientThresh = kGradientThreshold;
 	//double gradientThresh = 0;
 	//normalize
-	for (int y = 0; y < eyeROI.rows; ++y) {
-		double *Xr = gradientX.ptr<double>(y), *Yr = gradientY.ptr<double>(y);
-		const double *Mr = mags.ptr<double>(y);
-		for (int x = 0; x < eyeROI.cols; ++x) {
+	for (int y = 0; y < eye.rows; ++y) {
+		double *Xr = level.gradientX.ptr<double>(y), *Yr = level.gradientY.ptr<double>(y);
+		const double *Mr = level.mags.ptr<double>(y);
+		for (int x = 0; x < eye.cols; ++x) {
 			double gX = Xr[x], gY = Yr[x];
 			double magnitude = Mr[x];
 			if (magnitude > gradientThresh) {
@@ -158,51 +355,73 @@ cv::Point EyeCenter::findEyeCenter(cv::Mat face, cv::Rect eye, std::string debug
 		}
 	}
 
-	
-
-	if (writeFiles)
-		;// cv::imwrite(fileNamePrefix + "_grad.png", gradientX);
-
 	if (writeFiles)
-		cv::imwrite(fileNamePrefix + "_mags.png", mags);
+		writeDebugImage(fileNamePrefix + "_mags.png", level.mags);
 	//imshow(debugWindow,gradientX);
   //-- Create a blurred and inverted image for weighting
-	cv::Mat weight;
-	GaussianBlur(eyeROI, weight, cv::Size(kWeightBlurSize, kWeightBlurSize), 0, 0);
-	for (int y = 0; y < weight.rows; ++y) {
-		unsigned char *row = weight.ptr<unsigned char>(y);
-		for (int x = 0; x < weight.cols; ++x) {
-			row[x] = (255 - row[x]);
-		}
-	}
+	GaussianBlur(eye, level.weight, cv::Size(weightBlurSize, weightBlurSize), 0, 0);
 	if (writeFiles)
-		cv::imwrite(fileNamePrefix + "_weight.png", weight);
+		writeDebugImage(fileNamePrefix + "_weight.png", 255 - level.weight);
 	//imshow(debugWindow,weight);
+	if (kEnableWeight) {
+		// inverted and scaled in one go
+		level.weight.convertTo(level.weightScaled, CV_32F, -1.0 / kWeightDivisor, 255.0 / kWeightDivisor);
+	}
+	else {
+		level.weightScaled.create(eye.rows, eye.cols, CV_32F);
+		level.weightScaled.setTo(1.0f);
+	}
+}
+
+cv::Point EyeCenter::voteAllCenters(SearchLevel &level, float maxMag, bool writeFiles, const std::string &fileNamePrefix) {
+	const cv::Mat &eye = level.eye;
+	// the window never needs to be bigger than the image
+	int radius = std::max(0, std::min((int)floor(maxMag), std::max(eye.rows, eye.cols) - 1));
+	updateDisplacementTable(radius, maxMag);
 	//-- Run the algorithm!
-	cv::Mat outSum = cv::Mat::zeros(eyeROI.rows, eyeROI.cols, CV_64F);
 	// for each possible gradient location
 	// Note: these loops are reversed from the way the paper does them
 	// it evaluates every possible center for each gradient location instead of
 	// every possible gradient location for every center.
-	printf("Eye Size: %ix%i\n", outSum.cols, outSum.rows);
-	for (int y = 0; y < weight.rows; ++y) {
-		const double *Xr = gradientX.ptr<double>(y), *Yr = gradientY.ptr<double>(y);
-		for (int x = 0; x < weight.cols; ++x) {
-			double gX = Xr[x], gY = Yr[x];
-			if (gX == 0.0 && gY == 0.0) {
-				continue;
+	// Each band of gradient rows votes into its own accumulator and the bands are summed in order,
+	// so the result is the same however many threads did the voting.
+	int bandCount = (eye.rows + kVoteBandRows - 1) / kVoteBandRows;
+	m_bandSums.resize(bandCount);
+	auto voteBand = [&](int band) {
+		cv::Mat &bandSum = m_bandSums[band];
+		bandSum.create(eye.rows, eye.cols, CV_32F);
+		bandSum.setTo(0.0f);
+		int bandEnd = std::min(eye.rows, (band + 1) * kVoteBandRows);
+		for (int y = band * kVoteBandRows; y < bandEnd; ++y) {
+			const double *Xr = level.gradientX.ptr<double>(y), *Yr = level.gradientY.ptr<double>(y);
+			for (int x = 0; x < eye.cols; ++x) {
+				double gX = Xr[x], gY = Yr[x];
+				if (gX == 0.0 && gY == 0.0) {
+					continue;
+				}
+				testPossibleCentersWindow(x, y, (float)gX, (float)gY, level.weightScaled, bandSum, m_displacementX.data(), m_displacementY.data(), radius);
 			}
-			testPossibleCentersFormula(x, y, weight, gX, gY, outSum, kEnableWeight, kWeightDivisor, kMaxMag);
 		}
+	};
+	if (pool != nullptr) {
+		pool->ParallelFor(bandCount, voteBand);
+	}
+	else {
+		for (int band = 0; band < bandCount; ++band) {
+			voteBand(band);
+		}
+	}
+	m_outSum.create(eye.rows, eye.cols, CV_32F);
+	m_outSum.setTo(0.0f);
+	for (int band = 0; band < bandCount; ++band) {
+		m_outSum += m_bandSums[band];
 	}
 	// scale all the values down, basically averaging them
-	double numGradients = (weight.rows*weight.cols);
-	cv::Mat out;
-	outSum.convertTo(out, CV_32F, 1.0 / numGradients);
+	double numGradients = (eye.rows*eye.cols);
+	m_outSum *= 1.0 / numGradients;
+	cv::Mat &out = m_outSum;
 
 	//imshow(debugWindow,out);
-	if (writeFiles)
-		;// cv::imwrite(fileNamePrefix + "outSum.png", out);
 	if (writeFiles)
 		;// cv::imwrite(fileNamePrefix + "_out.png", out);
 	//-- Find the maximum point
@@ -211,68 +430,98 @@ cv::Point EyeCenter::findEyeCenter(cv::Mat face, cv::Rect eye, std::string debug
 	cv::minMaxLoc(out, NULL, &maxVal, NULL, &maxP);
 	//-- Flood fill the edges
 	if (kEnablePostProcess) {
-		cv::Mat floodClone;
+		cv::Mat &floodClone = m_floodClone;
 		//double floodThresh = computeDynamicThreshold(out, 1.5);
 		double floodThresh = maxVal *kPostProcessThreshold;
 		cv::threshold(out, floodClone, floodThresh, 0.0f, cv::THRESH_TOZERO);
 		if (kPlotVectorField) {
 			//plotVecField(gradientX, gradientY, floodClone);
-			imwrite("eyeFrame.png", eyeROIUnscaled);
+			imwrite("eyeFrame.png", eye);
 		}
-		if (writeFiles)
-			cv::imwrite(fileNamePrefix + "_eyeROIUnscaled.png", eyeROIUnscaled);
 		if (writeFiles)
 			;// cv::imwrite(fileNamePrefix + "_floodClone.png", floodClone);
-		cv::Mat mask = floodKillEdges(floodClone);
+		cv::Mat &mask = m_mask;
+		floodKillEdges(floodClone, mask, m_floodStack);
 		//imshow(debugWindow + " Mask",mask);
 		if (writeFiles)
-			cv::imwrite(fileNamePrefix + "_mask.png", mask);
+			writeDebugImage(fileNamePrefix + "_mask.png", mask);
 		//imshow(debugWindow,out);
 		// redo max
 		cv::minMaxLoc(out, NULL, &maxVal, NULL, &maxP, mask);
 	}
-	if (writeFiles) {
-		cv::Mat visual;
-		cvtColor(face, visual, CV_GRAY2BGR);
-		auto center = unscalePoint(maxP, eye, kFastEyeWidth);
-		line(visual, cv::Point2f(center.x, 0), cv::Point2f(center.x, visual.rows), cv::Scalar(0, 0, 255, 0), 2);
-		line(visual, cv::Point2f(0, center.y), cv::Point2f(visual.cols, center.y), cv::Scalar(0, 0, 255, 0), 2);
-		cv::imwrite(fileNamePrefix + "_center.png", visual);
+	double meanVal = cv::mean(out)[0];
+	confidence = (maxVal > 0.0) ? (float)std::min(1.0, std::max(0.0, 1.0 - meanVal / maxVal)) : 0.0f;
+	return maxP;
+}
+
+double EyeCenter::evaluateCenter(const SearchLevel &level, int cx, int cy, float maxMag) {
+	// only gradients within maxMag vote for a center
+	int radius = (int)floor(maxMag);
+	int x0 = std::max(0, cx - radius), x1 = std::min(level.eye.cols - 1, cx + radius);
+	int y0 = std::max(0, cy - radius), y1 = std::min(level.eye.rows - 1, cy + radius);
+	double maxMagSquared = (double)maxMag * maxMag;
+	double sum = 0.0;
+	for (int y = y0; y <= y1; ++y) {
+		const double *Xr = level.gradientX.ptr<double>(y), *Yr = level.gradientY.ptr<double>(y);
+		int dy = y - cy;
+		for (int x = x0; x <= x1; ++x) {
+			double gX = Xr[x], gY = Yr[x];
+			int dx = x - cx;
+			if ((gX == 0.0 && gY == 0.0) || (dx == 0 && dy == 0)) {
+				continue;
+			}
+			double magnitudeSquared = (double)(dx * dx + dy * dy);
+			if (magnitudeSquared > maxMagSquared) {
+				continue;
+			}
+			// the vector goes from the center to the gradient
+			double dotProduct = std::max(0.0, (dx * gX + dy * gY) / sqrt(magnitudeSquared));
+			sum += dotProduct * dotProduct;
+		}
 	}
-	return unscalePoint(maxP, eye, kFastEyeWidth);
+	return sum * level.weightScaled.at<float>(cy, cx);
 }
 
 #pragma mark Postprocessing
 
-bool floodShouldPushPoint(const cv::Point &np, const cv::Mat &mat) {
-	return inMat(np, mat.rows, mat.cols);
-}
-
-// returns a mask
-cv::Mat floodKillEdges(cv::Mat &mat) {
+// Clears the 4-connected region of non-zero pixels touching the edges of mat, in mat and in the mask
+// that is returned in mask. Each span of the region is filled in one go, and only the start of each span
+// found on the rows above and below is pushed, so stack stays small and is reused between calls.
+void floodKillEdges(cv::Mat &mat, cv::Mat &mask, std::vector<cv::Point> &stack) {
 	rectangle(mat, cv::Rect(0, 0, mat.cols, mat.rows), 255);
 
-	cv::Mat mask(mat.rows, mat.cols, CV_8U, 255);
-	std::queue<cv::Point> toDo;
-	toDo.push(cv::Point(0, 0));
-	while (!toDo.empty()) {
-		cv::Point p = toDo.front();
-		toDo.pop();
-		if (mat.at<float>(p) == 0.0f) {
+	mask.create(mat.rows, mat.cols, CV_8U);
+	mask.setTo(255);
+	stack.clear();
+	stack.push_back(cv::Point(0, 0));
+	while (!stack.empty()) {
+		cv::Point p = stack.back();
+		stack.pop_back();
+		float *Mr = mat.ptr<float>(p.y);
+		if (Mr[p.x] == 0.0f) {
 			continue;
 		}
-		// add in every direction
-		cv::Point np(p.x + 1, p.y); // right
-		if (floodShouldPushPoint(np, mat)) toDo.push(np);
-		np.x = p.x - 1; np.y = p.y; // left
-		if (floodShouldPushPoint(np, mat)) toDo.push(np);
-		np.x = p.x; np.y = p.y + 1; // down
-		if (floodShouldPushPoint(np, mat)) toDo.push(np);
-		np.x = p.x; np.y = p.y - 1; // up
-		if (floodShouldPushPoint(np, mat)) toDo.push(np);
+		// the whole span the point is in
+		int left = p.x, right = p.x;
+		while (left > 0 && Mr[left - 1] != 0.0f) --left;
+		while (right < mat.cols - 1 && Mr[right + 1] != 0.0f) ++right;
 		// kill it
-		mat.at<float>(p) = 0.0f;
-		mask.at<uchar>(p) = 0;
+		uchar *Kr = mask.ptr<uchar>(p.y);
+		for (int x = left; x <= right; ++x) {
+			Mr[x] = 0.0f;
+			Kr[x] = 0;
+		}
+		// the spans touching it above and below
+		for (int ny = p.y - 1; ny <= p.y + 1; ny += 2) {
+			if (ny < 0 || ny >= mat.rows) {
+				continue;
+			}
+			const float *Nr = mat.ptr<float>(ny);
+			for (int x = left; x <= right; ++x) {
+				if (Nr[x] != 0.0f && (x == left || Nr[x - 1] == 0.0f)) {
+					stack.push_back(cv::Point(x, ny));
+				}
+			}
+		}
 	}
-	return mask;
 }
\ No newline at end of file
@@ -2,6 +2,13 @@
 #define EYE_CENTER_H
 #pragma once
 #include <opencv2/imgproc/imgproc.hpp>
+#include <vector>
+
+namespace PupilDetect
+{
+	class WorkerPool;
+	class DebugImageSink;
+}
 
 class EyeCenter
 {
@@ -15,7 +22,58 @@ public:
 	bool kEnablePostProcess = true;
 	float kPostProcessThreshold = 0.95;
 	float kMaxMag = 50;
+	// 0 votes over the whole fast size image. Otherwise the image is halved this many times, the votes are
+	// taken on the smallest one, and the kPyramidCandidates best centers are refined on the way back up.
+	int kPyramidLevels = 0;
+	int kPyramidCandidates = 3;
+	// spreads the voting over several threads when set
+	PupilDetect::WorkerPool *pool = nullptr;
+	// writes the writeFiles images in the background when set
+	PupilDetect::DebugImageSink *debugSink = nullptr;
+	// set by each search, how much the center stood out of the average, 0..1
+	float confidence = 0.0f;
 
 cv::Point findEyeCenter(cv::Mat face, cv::Rect eye, std::string debugWindow, bool writeFiles, const std::string fileNamePrefix);
+	// BGRA input, resampled straight to the fast size in gray; the center is in pixels of bgra
+	cv::Point2f findEyeCenterBGRA(const cv::Mat &bgra, bool writeFiles, const std::string &fileNamePrefix);
+
+private:
+	// the search itself, on a gray eye already at the fast size
+	cv::Point findFastEyeCenter(const cv::Mat &eyeROI, bool writeFiles, const std::string &fileNamePrefix);
+	void updateDisplacementTable(int radius, float maxMag);
+	void writeDebugImage(const std::string &fileName, const cv::Mat &image);
+
+	// one resolution of the eye with its normalized gradients and weights
+	struct SearchLevel
+	{
+		cv::Mat eye;
+		cv::Mat gradientX;
+		cv::Mat gradientY;
+		cv::Mat mags;
+		cv::Mat weight;
+		cv::Mat weightScaled;
+	};
+	void prepareLevel(SearchLevel &level, int weightBlurSize, bool writeFiles, const std::string &fileNamePrefix);
+	// every center of the level gets the votes of all gradients, returns the best one
+	cv::Point voteAllCenters(SearchLevel &level, float maxMag, bool writeFiles, const std::string &fileNamePrefix);
+	// the objective at one center, the same sum the votes add up to
+	double evaluateCenter(const SearchLevel &level, int cx, int cy, float maxMag);
+
+	// scratch images, kept between calls so they are only reallocated when the eye size changes
+	cv::Mat m_eyeROI;
+	// [0] is the fast size, each next one half of the one before
+	std::vector<SearchLevel> m_levels;
+	std::vector<cv::Point> m_candidates;
+	std::vector<cv::Mat> m_bandSums;
+	cv::Mat m_outSum;
+	cv::Mat m_floodClone;
+	cv::Mat m_mask;
+	std::vector<cv::Point> m_floodStack;
+
+	// normalized vectors from each candidate center in the voting window to the gradient at its middle
+	std::vector<float> m_displacementX;
+	std::vector<float> m_displacementY;
+	int m_displacementRadius = -1;
+	float m_displacementMaxMag = 0;
 };
 #endif
\ No newline at end of file
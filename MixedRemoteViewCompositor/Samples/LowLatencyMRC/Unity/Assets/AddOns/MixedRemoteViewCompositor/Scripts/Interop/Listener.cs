@@ -14,6 +14,9 @@ namespace MixedRemoteViewCompositor
     {
         public ushort Port { get; set; }
 
+        // when set, listens for a connector on this machine at shm://SharedMemoryName instead of on Port
+        public string SharedMemoryName { get; set; }
+
         public Listener()
         {
             this.handle = Plugin.InvalidHandle;
@@ -26,7 +29,9 @@ namespace MixedRemoteViewCompositor
 
         public override void StartAsync()
         {
-            var result = Wrapper.exStartListener(this.Port, ref this.handle, this.connectedHandler);
+            var result = string.IsNullOrEmpty(this.SharedMemoryName)
+                ? Wrapper.exStartListener(this.Port, ref this.handle, this.connectedHandler)
+                : Wrapper.exStartSharedMemoryListener(this.SharedMemoryName, ref this.handle, this.connectedHandler);
 
             Plugin.CheckResult(result, "Listener.StartAsync()");
 
@@ -45,6 +50,9 @@ namespace MixedRemoteViewCompositor
             [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcListenerCreateAndStart")]
             internal static extern int exStartListener(ushort port, ref uint listenerHandle, [MarshalAs(UnmanagedType.FunctionPtr)]PluginCallbackHandler StartedHandler);
 
+            [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcListenerCreateAndStartSharedMemory")]
+            internal static extern int exStartSharedMemoryListener([MarshalAsAttribute(UnmanagedType.LPWStr)]string name, ref uint listenerHandle, [MarshalAs(UnmanagedType.FunctionPtr)]PluginCallbackHandler StartedHandler);
+
             [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcListenerStopAndClose")]
             internal static extern int exStopListener(uint listenerHandle);
         };
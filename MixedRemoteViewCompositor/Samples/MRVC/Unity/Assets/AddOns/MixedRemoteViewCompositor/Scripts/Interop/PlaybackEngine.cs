@@ -36,6 +36,18 @@ namespace MixedRemoteViewCompositor
         public SpatialTranformHelper.Matrix4x4 cameraAffine;
     };
 
+    [StructLayout(LayoutKind.Sequential)]
+    public struct PlaybackStats
+    {
+        public ulong timestamp;
+        public long decodeTime;
+        public long presentLatency;
+        public long receiveLatency;
+        public uint queueDepth;
+        public uint framesPresented;
+        public uint framesDropped;
+    };
+
     [UnmanagedFunctionPointer(CallingConvention.StdCall)]
     public delegate void MediaSampleUpdated(ref MediaSampleUpdateArgs args);
 
@@ -161,6 +173,16 @@ namespace MixedRemoteViewCompositor
             return (Wrapper.exGetFrameData(this.Handle, ref args) == 0);
         }
 
+        public void SetLowLatency(bool enabled)
+        {
+            Plugin.CheckResult(Wrapper.exSetLowLatency(this.Handle, enabled), "PlaybackEngine.SetLowLatency()");
+        }
+
+        public bool GetStats(ref PlaybackStats stats)
+        {
+            return (Wrapper.exGetStats(this.Handle, ref stats) == 0);
+        }
+
 
         private PlaybackEngine()
         {
@@ -299,6 +321,12 @@ namespace MixedRemoteViewCompositor
 
             [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcPlaybackGetFrameData")]
             internal static extern int exGetFrameData(uint playerHandle, ref MediaSampleUpdateArgs args);
+
+            [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcPlaybackSetLowLatency")]
+            internal static extern int exSetLowLatency(uint playerHandle, bool enabled);
+
+            [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcPlaybackGetStats")]
+            internal static extern int exGetStats(uint playerHandle, ref PlaybackStats stats);
         }
     }
 }
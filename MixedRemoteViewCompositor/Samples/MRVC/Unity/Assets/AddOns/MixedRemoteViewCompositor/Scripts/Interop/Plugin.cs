@@ -36,6 +36,11 @@ namespace MixedRemoteViewCompositor
 
         public const string DataUrlFormat = "data://{0}:{1}";
 
+        /// <summary>
+        /// Reconnecting playback starts with the last media description from the same sender
+        /// </summary>
+        public bool CacheMediaDescriptions = false;
+
         public static bool IsHoloLens
         {
             get { return SystemInfo.deviceModel.ToUpperInvariant().Contains("HOLOLENS"); }
@@ -62,6 +67,7 @@ namespace MixedRemoteViewCompositor
         private void Awake()
         {
             Wrapper.exSetStreamingAssetsPath(Application.streamingAssetsPath);
+            Wrapper.exSetMediaDescriptionCacheEnabled(this.CacheMediaDescriptions);
         }
         
         private void OnEnable()
@@ -138,6 +144,9 @@ namespace MixedRemoteViewCompositor
             [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcSetTime")]
             public static extern void exSetTime(float t);
 
+            [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcSetMediaDescriptionCacheEnabled")]
+            public static extern void exSetMediaDescriptionCacheEnabled(bool enabled);
+
             [DllImport("MixedRemoteViewCompositor", CallingConvention = CallingConvention.StdCall, EntryPoint = "MrvcGetPluginEventFunc")]
             public static extern IntPtr exGetPluginEventFunction();
         }
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace MixedRemoteViewCompositor
+{
+    namespace Media
+    {
+        // what the low latency queue policy needs to know about each entry of a stream's sample queue
+        enum QueuedEntryType
+        {
+            QueuedEntry_Sample,
+            QueuedEntry_CleanPoint,
+            // format changes and ticks, never skipped over
+            QueuedEntry_Other
+        };
+
+        // video samples low latency playback lets wait, even when there is no key frame to skip to
+        const size_t c_cMaxLowLatencyQueueDepth = 8;
+
+        // Number of entries to drop from the front of a video queue in low latency mode.
+        // Only the run of samples in front of the first other entry is looked at. Samples in front of the newest key
+        // frame are dropped. If more than maxDepth samples would still be waiting, with or without a key frame, the
+        // whole run is dropped and *pWaitForCleanPoint is set: samples have to be dropped until the next key frame.
+        // Kept free of Windows types so the policy can be tested on its own.
+        inline size_t GetLowLatencySkipCount(
+            const std::vector<QueuedEntryType>& entries,
+            size_t maxDepth,
+            bool* pWaitForCleanPoint)
+        {
+            *pWaitForCleanPoint = false;
+
+            size_t cSamples = 0;
+            size_t nNewestCleanPoint = 0;
+            bool fCleanPoint = false;
+            for (; cSamples < entries.size() && entries[cSamples] != QueuedEntry_Other; ++cSamples)
+            {
+                if (entries[cSamples] == QueuedEntry_CleanPoint)
+                {
+                    nNewestCleanPoint = cSamples;
+                    fCleanPoint = true;
+                }
+            }
+
+            size_t cToDrop = fCleanPoint ? nNewestCleanPoint : 0;
+            if (cSamples - cToDrop > maxDepth)
+            {
+                *pWaitForCleanPoint = true;
+                cToDrop = cSamples;
+            }
+
+            return cToDrop;
+        }
+    }
+}
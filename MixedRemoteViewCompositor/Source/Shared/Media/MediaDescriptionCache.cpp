@@ -0,0 +1,122 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+#include "MediaDescriptionCache.h"
+
+Wrappers::CriticalSection MediaDescriptionCache::s_lock;
+bool MediaDescriptionCache::s_enabled = false;
+std::map<std::wstring, MediaDescriptionCache::Entry> MediaDescriptionCache::s_entries;
+
+_Use_decl_annotations_
+void MediaDescriptionCache::SetEnabled(
+    bool enabled)
+{
+    auto lock = s_lock.Lock();
+
+    s_enabled = enabled;
+    if (!s_enabled)
+    {
+        s_entries.clear();
+    }
+}
+
+bool MediaDescriptionCache::IsEnabled()
+{
+    auto lock = s_lock.Lock();
+
+    return s_enabled;
+}
+
+_Use_decl_annotations_
+UINT64 MediaDescriptionCache::ComputeHash(
+    const BYTE* pDescription,
+    DWORD cbDescription)
+{
+    // FNV-1a, the description is only a few hundred bytes
+    UINT64 hash = 14695981039346656037ULL;
+    for (DWORD i = 0; i < cbDescription; ++i)
+    {
+        hash ^= pDescription[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+_Use_decl_annotations_
+HRESULT MediaDescriptionCache::CopyDescription(
+    IDataBundle* pBundle,
+    std::vector<BYTE>* pDescription)
+{
+    NULL_CHK(pBundle);
+    NULL_CHK(pDescription);
+
+    DataBundleImpl* pBundleImpl = static_cast<DataBundleImpl*>(pBundle);
+    NULL_CHK(pBundleImpl);
+
+    DWORD cbTotalLen = 0;
+    IFR(pBundleImpl->get_TotalSize(&cbTotalLen));
+
+    pDescription->resize(cbTotalLen);
+    if (cbTotalLen == 0)
+    {
+        return S_OK;
+    }
+
+    DWORD cbCopied = 0;
+    IFR(pBundleImpl->CopyTo(0, cbTotalLen, pDescription->data(), &cbCopied));
+
+    return (cbCopied == cbTotalLen) ? S_OK : E_UNEXPECTED;
+}
+
+_Use_decl_annotations_
+void MediaDescriptionCache::Store(
+    const std::wstring& senderId,
+    std::vector<BYTE>&& description)
+{
+    auto lock = s_lock.Lock();
+
+    if (!s_enabled || senderId.empty())
+    {
+        return;
+    }
+
+    Entry& entry = s_entries[senderId];
+    entry.hash = ComputeHash(description.data(), static_cast<DWORD>(description.size()));
+    entry.description = std::move(description);
+}
+
+_Use_decl_annotations_
+bool MediaDescriptionCache::Lookup(
+    const std::wstring& senderId,
+    std::vector<BYTE>* pDescription,
+    UINT64* pHash)
+{
+    auto lock = s_lock.Lock();
+
+    if (!s_enabled || nullptr == pDescription || nullptr == pHash)
+    {
+        return false;
+    }
+
+    auto iter = s_entries.find(senderId);
+    if (iter == s_entries.end())
+    {
+        return false;
+    }
+
+    *pDescription = iter->second.description;
+    *pHash = iter->second.hash;
+
+    return true;
+}
+
+_Use_decl_annotations_
+void MediaDescriptionCache::Remove(
+    const std::wstring& senderId)
+{
+    auto lock = s_lock.Lock();
+
+    s_entries.erase(senderId);
+}
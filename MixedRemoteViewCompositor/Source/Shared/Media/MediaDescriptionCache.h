@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+namespace MixedRemoteViewCompositor
+{
+    namespace Media
+    {
+        // Media descriptions last received from each sender, keyed by the sender's host and port
+        // (or shared memory channel name), so senders on one host don't share an entry.
+        // A source that reconnects to a sender it has seen opens with the cached description and sends
+        // RequestMediaDescriptionAndStart with its hash, so the sink starts streaming right away. The sink
+        // confirms an unchanged description, or sends the new one, which the source then opens from instead.
+        // The cache is process wide and off until enabled.
+        class MediaDescriptionCache
+        {
+        public:
+            static void SetEnabled(_In_ bool enabled);
+            static bool IsEnabled();
+
+            // hash of a SendMediaDescription payload, computed the same way by the sink and the source
+            static UINT64 ComputeHash(
+                _In_reads_bytes_(cbDescription) const BYTE* pDescription,
+                _In_ DWORD cbDescription);
+
+            // copy of the SendMediaDescription payload in pBundle, without consuming it
+            static HRESULT CopyDescription(
+                _In_ ABI::MixedRemoteViewCompositor::Network::IDataBundle* pBundle,
+                _Out_ std::vector<BYTE>* pDescription);
+
+            static void Store(
+                _In_ const std::wstring& senderId,
+                _In_ std::vector<BYTE>&& description);
+
+            // false if nothing is cached for senderId
+            static bool Lookup(
+                _In_ const std::wstring& senderId,
+                _Out_ std::vector<BYTE>* pDescription,
+                _Out_ UINT64* pHash);
+
+            static void Remove(
+                _In_ const std::wstring& senderId);
+
+        private:
+            struct Entry
+            {
+                std::vector<BYTE> description;
+                UINT64 hash;
+            };
+
+            static Wrappers::CriticalSection s_lock;
+            static bool s_enabled;
+            static std::map<std::wstring, Entry> s_entries;
+        };
+    }
+}
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "NetworkMediaSink.h"
+#include "MediaDescriptionCache.h"
 #include "Media.h"
 
 class ShutdownFunc
@@ -283,13 +284,15 @@ HRESULT NetworkMediaSinkImpl::RuntimeClassInitialize(
             IFC(SendDescription());
             break;
         case PayloadType_RequestMediaStart:
-            // triggers the _connected state
-            if (nullptr != _presentationClock)
-            {
-                LOG_RESULT_MSG(_presentationClock->GetTime(&_llStartTime), L"NetworkSinkImpl - MediaStartRequested, Not able to set start time from presentation clock");
-            }
-            IFC(ForEach(_streams, ConnectedFunc(true, _llStartTime)));
+            IFC(StartStreaming());
             break;
+        case PayloadType_RequestMediaDescriptionAndStart:
+        {
+            ComPtr<IDataBundle> spBundle;
+            IFC(args->get_DataBundle(&spBundle));
+            IFC(ProcessDescribeAndStartRequest(spBundle.Get()));
+            break;
+        }
         case PayloadType_RequestMediaStop:
             IFC(ForEach(_streams, ConnectedFunc(false, _llStartTime)));
             break;
@@ -747,7 +750,25 @@ HRESULT NetworkMediaSinkImpl::SendCaptureStopped()
 _Use_decl_annotations_
 HRESULT NetworkMediaSinkImpl::SendDescription(void)
 {
-    Log(Log_Level_Info, L"NetworkSinkImpl::SendDescription() begin...\n");
+    ComPtr<IDataBundle> spDataBundle;
+    UINT64 hash = 0;
+    IFR(CreateDescription(&spDataBundle, &hash));
+
+    // Send the data, set callback
+    Log(Log_Level_Info, L"NetworkMediaSink::SendDescription()\n");
+
+    return _spConnection->SendBundle(spDataBundle.Get());
+}
+
+_Use_decl_annotations_
+HRESULT NetworkMediaSinkImpl::CreateDescription(
+    IDataBundle** ppDataBundle,
+    UINT64* pHash)
+{
+    Log(Log_Level_Info, L"NetworkSinkImpl::CreateDescription() begin...\n");
+
+    NULL_CHK(ppDataBundle);
+    NULL_CHK(pHash);
 
     // Size of the constant buffer header
     const DWORD c_cStreams = _streams.GetCount();
@@ -829,11 +850,57 @@ HRESULT NetworkMediaSinkImpl::SendDescription(void)
         IFR(spDataBundle->AddBuffer(svStreamMFAttributes[nStream].Get()));
     }
 
-    // Send the data, set callback
-    Log(Log_Level_Info, L"NetworkMediaSink::SendDescription()\n");
+    // hash the payload the same way the source does when it receives it
+    std::vector<BYTE> description;
+    IFR(MediaDescriptionCache::CopyDescription(spDataBundle.Get(), &description));
+    *pHash = MediaDescriptionCache::ComputeHash(
+        description.data() + c_cbPayloadHeaderSize,
+        static_cast<DWORD>(description.size()) - c_cbPayloadHeaderSize);
 
-    return _spConnection->SendBundle(spDataBundle.Get());
- }
+    return spDataBundle.CopyTo(ppDataBundle);
+}
+
+_Use_decl_annotations_
+HRESULT NetworkMediaSinkImpl::ProcessDescribeAndStartRequest(
+    IDataBundle* pBundle)
+{
+    Log(Log_Level_Info, L"NetworkSinkImpl::ProcessDescribeAndStartRequest()\n");
+
+    DataBundleImpl* pBundleImpl = static_cast<DataBundleImpl*>(pBundle);
+    NULL_CHK(pBundleImpl);
+
+    CachedMediaDescription cached;
+    IFR(pBundleImpl->MoveLeft(sizeof(CachedMediaDescription), &cached));
+
+    ComPtr<IDataBundle> spDataBundle;
+    UINT64 hash = 0;
+    IFR(CreateDescription(&spDataBundle, &hash));
+
+    // the player already has this description, confirm it and only start streaming
+    if (hash == cached.DescriptionHash)
+    {
+        IFR(_spConnection->SendPayloadType(PayloadType_State_MediaDescriptionUnchanged));
+    }
+    else
+    {
+        Log(Log_Level_Info, L"NetworkSinkImpl::ProcessDescribeAndStartRequest() - description changed, sending it\n");
+
+        IFR(_spConnection->SendBundle(spDataBundle.Get()));
+    }
+
+    return StartStreaming();
+}
+
+HRESULT NetworkMediaSinkImpl::StartStreaming()
+{
+    // triggers the _connected state
+    if (nullptr != _presentationClock)
+    {
+        LOG_RESULT_MSG(_presentationClock->GetTime(&_llStartTime), L"NetworkSinkImpl - MediaStartRequested, Not able to set start time from presentation clock");
+    }
+
+    return ForEach(_streams, ConnectedFunc(true, _llStartTime));
+}
 
 _Use_decl_annotations_
 HRESULT NetworkMediaSinkImpl::SetMediaStreamProperties(
@@ -128,6 +128,14 @@ namespace MixedRemoteViewCompositor
             HRESULT FormatChanged(_In_ IMFMediaType* pMediaType);
             HRESULT SampleUpdated(_In_ IMFSample* pSample);
 
+            // SendMediaDescription bundle, and the hash of its payload
+            HRESULT CreateDescription(
+                _COM_Outptr_ ABI::MixedRemoteViewCompositor::Network::IDataBundle** ppDataBundle,
+                _Out_ UINT64* pHash);
+            HRESULT ProcessDescribeAndStartRequest(
+                _In_ ABI::MixedRemoteViewCompositor::Network::IDataBundle* pBundle);
+            HRESULT StartStreaming();
+
         private:
             Wrappers::CriticalSection _lock;
 
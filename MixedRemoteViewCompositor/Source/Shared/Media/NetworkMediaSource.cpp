@@ -5,6 +5,7 @@
 #include "Media.h"
 #include "NetworkMediaSource.h"
 #include "NetworkMediaSourceStream.h"
+#include "MediaDescriptionCache.h"
 #include <IntSafe.h>
 
 _Use_decl_annotations_
@@ -81,8 +82,12 @@ _Use_decl_annotations_
 NetworkMediaSourceImpl::NetworkMediaSourceImpl()
     : OpQueue<NetworkMediaSourceImpl, SourceOperation>(this)
     , _spConnection(nullptr)
+    , _descriptionHash(0)
+    , _fOpenedFromCache(false)
+    , _fStartRequested(false)
     , _eSourceState(SourceStreamState_Invalid)
     , _flRate(1.0f)
+    , _fLowLatency(false)
 {
 }
 
@@ -126,9 +131,35 @@ HRESULT NetworkMediaSourceImpl::RuntimeClassInitialize(
     // client is connected we need to send the Describe request
     _eSourceState = SourceStreamState_Opening;
 
-    IFR(SendDescribeRequest());
+    IFR(AsyncBase::Start());
 
-    return AsyncBase::Start();
+    if (MediaDescriptionCache::IsEnabled())
+    {
+        LOG_RESULT(GetSenderId(&_senderId));
+    }
+
+    // a sender we have seen before can open with the description it sent last time,
+    // the sink starts streaming right away and only sends the description again if it changed.
+    // The open completes when the sink confirms the description, or once the new one is opened
+    std::vector<BYTE> description;
+    if (!_senderId.empty() && MediaDescriptionCache::Lookup(_senderId, &description, &_descriptionHash))
+    {
+        auto lock = _lock.Lock();
+
+        HRESULT hr = OpenFromCachedDescription(description);
+        if (SUCCEEDED(hr))
+        {
+            return SendDescribeAndStartRequest();
+        }
+
+        LOG_RESULT(hr);
+
+        // the cached description is no good, open the usual way
+        MediaDescriptionCache::Remove(_senderId);
+        DiscardCachedOpen();
+    }
+
+    return SendDescribeRequest();
 }
 
 // IMFMediaEventGenerator methods.
@@ -286,6 +317,14 @@ HRESULT NetworkMediaSourceImpl::Shutdown()
 
     CompleteOpen(MF_E_SHUTDOWN);
 
+    ShutdownStreams();
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void NetworkMediaSourceImpl::ShutdownStreams()
+{
     StreamContainer::POSITION pos = _streams.FrontPosition();
     while (pos != _streams.EndPosition())
     {
@@ -305,8 +344,6 @@ HRESULT NetworkMediaSourceImpl::Shutdown()
         _spPresentationDescriptor->DeleteAllItems();
         _spPresentationDescriptor.Reset();
     }
-
-    return S_OK;
 }
 
 _Use_decl_annotations_
@@ -737,7 +774,15 @@ HRESULT NetworkMediaSourceImpl::DoStart(
 
         _eSourceState = SourceStreamState_Starting;
 
-        IFC(SendStartRequest());
+        // the first start was already requested along with the cached description
+        if (_fStartRequested)
+        {
+            _fStartRequested = false;
+        }
+        else
+        {
+            IFC(SendStartRequest());
+        }
 
         _eSourceState = SourceStreamState_Started;
         IFC(_spEventQueue->QueueEventParamVar(MESourceStarted, GUID_NULL, S_OK, &pOp->GetData()));
@@ -824,6 +869,15 @@ done:
     return _spEventQueue->QueueEventParamVar(MESourceRateChanged, GUID_NULL, hr, nullptr);
 }
 
+_Use_decl_annotations_
+void NetworkMediaSourceImpl::SetLowLatency(
+    bool enabled)
+{
+    auto lock = _lock.Lock();
+
+    _fLowLatency = enabled;
+}
+
 _Use_decl_annotations_
 bool NetworkMediaSourceImpl::IsRateSupported(
     float flRate, float* pflAdjustedRate)
@@ -870,6 +924,9 @@ HRESULT NetworkMediaSourceImpl::OnDataReceived(
     case PayloadType_SendMediaDescription:
         IFC(ProcessMediaDescription(spDataBundle.Get()));
         break;
+    case PayloadType_State_MediaDescriptionUnchanged:
+        IFC(ProcessMediaDescriptionUnchanged());
+        break;
     case PayloadType_SendMediaSample:
         IFC(ProcessMediaSample(spDataBundle.Get()));
         break;
@@ -901,6 +958,43 @@ HRESULT NetworkMediaSourceImpl::SendDescribeRequest()
     return _spConnection->SendPayloadType(PayloadType_RequestMediaDescription);
 }
 
+_Use_decl_annotations_
+HRESULT NetworkMediaSourceImpl::SendDescribeAndStartRequest()
+{
+    Log(Log_Level_Info, L"NetworkMediaSourceImpl::SendDescribeAndStartRequest()\n");
+
+    NULL_CHK_HR(_spConnection, E_POINTER);
+
+    const DWORD c_cbPayloadHeaderSize = sizeof(PayloadHeader);
+    const DWORD c_cbBufferSize = c_cbPayloadHeaderSize + sizeof(CachedMediaDescription);
+
+    ComPtr<IDataBuffer> spDataBuffer;
+    IFR(MakeAndInitialize<DataBufferImpl>(&spDataBuffer, c_cbBufferSize));
+
+    ComPtr<IBuffer> spBuffer;
+    IFR(spDataBuffer.As(&spBuffer));
+
+    BYTE* pBuf = GetDataType<BYTE*>(spBuffer.Get());
+    NULL_CHK(pBuf);
+
+    PayloadHeader* pOpHeader = reinterpret_cast<PayloadHeader*>(pBuf);
+    pOpHeader->ePayloadType = PayloadType_RequestMediaDescriptionAndStart;
+    pOpHeader->cbPayloadSize = sizeof(CachedMediaDescription);
+
+    CachedMediaDescription* pCached = reinterpret_cast<CachedMediaDescription*>(pBuf + c_cbPayloadHeaderSize);
+    pCached->DescriptionHash = _descriptionHash;
+
+    IFR(spDataBuffer->put_CurrentLength(c_cbBufferSize));
+
+    ComPtr<IDataBundle> spDataBundle;
+    IFR(MakeAndInitialize<DataBundleImpl>(&spDataBundle));
+    IFR(spDataBundle->AddBuffer(spDataBuffer.Get()));
+
+    _fStartRequested = true;
+
+    return _spConnection->SendBundle(spDataBundle.Get());
+}
+
 _Use_decl_annotations_
 HRESULT NetworkMediaSourceImpl::SendStartRequest()
 {
@@ -922,6 +1016,51 @@ HRESULT NetworkMediaSourceImpl::SendStopRequest()
 }
 
 
+_Use_decl_annotations_
+HRESULT NetworkMediaSourceImpl::GetSenderId(
+    std::wstring* pSenderId)
+{
+    NULL_CHK(pSenderId);
+
+    ConnectionImpl* pConnectionImpl = static_cast<ConnectionImpl*>(_spConnection.Get());
+    NULL_CHK(pConnectionImpl);
+
+    // the remote uri only names the host, the port tells apart the senders on it
+    return pConnectionImpl->GetRemoteId(pSenderId);
+}
+
+_Use_decl_annotations_
+HRESULT NetworkMediaSourceImpl::OpenFromCachedDescription(
+    const std::vector<BYTE>& description)
+{
+    Log(Log_Level_Info, L"NetworkMediaSourceImpl::OpenFromCachedDescription()\n");
+
+    const DWORD c_cbDescription = static_cast<DWORD>(description.size());
+
+    // same bundle the sink would have sent
+    ComPtr<IDataBuffer> spDataBuffer;
+    IFR(MakeAndInitialize<DataBufferImpl>(&spDataBuffer, c_cbDescription));
+
+    ComPtr<IBuffer> spBuffer;
+    IFR(spDataBuffer.As(&spBuffer));
+
+    BYTE* pBuf = GetDataType<BYTE*>(spBuffer.Get());
+    NULL_CHK(pBuf);
+
+    CopyMemory(pBuf, description.data(), c_cbDescription);
+
+    IFR(spDataBuffer->put_CurrentLength(c_cbDescription));
+
+    ComPtr<IDataBundle> spDataBundle;
+    IFR(MakeAndInitialize<DataBundleImpl>(&spDataBundle));
+    IFR(spDataBundle->AddBuffer(spDataBuffer.Get()));
+
+    _fOpenedFromCache = true;
+
+    return ProcessMediaDescription(spDataBundle.Get());
+}
+
+
 // Helper methods to handle received network bundles
 _Use_decl_annotations_
 HRESULT NetworkMediaSourceImpl::ProcessCaptureReady()
@@ -960,6 +1099,16 @@ HRESULT NetworkMediaSourceImpl::ProcessMediaDescription(
 {
     Log(Log_Level_Info, L"NetworkMediaSourceImpl::ProcessMediaDescription()\n");
 
+    // the sink only sends a description after a cached open if it no longer matches.
+    // The open hasn't completed, so nobody has seen the streams yet: drop them and open from this one,
+    // which also puts it in the cache
+    if (_fOpenedFromCache && _streams.GetCount() > 0)
+    {
+        Log(Log_Level_Warning, L"NetworkMediaSourceImpl::ProcessMediaDescription() - cached description is out of date\n");
+
+        DiscardCachedOpen();
+    }
+
     if (_eSourceState == SourceStreamState_Started
         &&
         _streams.GetCount() > 0)
@@ -1002,6 +1151,13 @@ HRESULT NetworkMediaSourceImpl::ProcessMediaDescription(
 
     HRESULT hr = S_OK;
 
+    // kept for the next connection to this sender once the streams are created
+    std::vector<BYTE> description;
+    if (!_senderId.empty() && !_fOpenedFromCache)
+    {
+        IFC(MediaDescriptionCache::CopyDescription(pBundle, &description));
+    }
+
     IFC(pBundleImpl->get_TotalSize(&cbTotalLen));
 
     // Minimum size of the operation payload is size of Description structure
@@ -1078,14 +1234,58 @@ HRESULT NetworkMediaSourceImpl::ProcessMediaDescription(
     // Everything succeeded we are in stopped state now
     _eSourceState = SourceStreamState_Stopped;
 
-    SendStopRequest();
+    // a cached open is followed by the start request instead
+    if (!_fOpenedFromCache)
+    {
+        if (!description.empty())
+        {
+            MediaDescriptionCache::Store(_senderId, std::move(description));
+        }
+
+        SendStopRequest();
+    }
 
 done:
     delete[] pPtr;
 
+    // a cached open completes when the sink answers the start request, a failure falls back to a describe request
+    if (_fOpenedFromCache)
+    {
+        return hr;
+    }
+
     return CompleteOpen(hr);
 }
 
+_Use_decl_annotations_
+HRESULT NetworkMediaSourceImpl::ProcessMediaDescriptionUnchanged()
+{
+    Log(Log_Level_Info, L"NetworkMediaSourceImpl::ProcessMediaDescriptionUnchanged()\n");
+
+    if (!_fOpenedFromCache)
+    {
+        return S_OK;
+    }
+
+    // the streams made from the cached description are the right ones
+    _fOpenedFromCache = false;
+
+    return CompleteOpen(S_OK);
+}
+
+_Use_decl_annotations_
+void NetworkMediaSourceImpl::DiscardCachedOpen()
+{
+    ShutdownStreams();
+
+    _fOpenedFromCache = false;
+
+    // the usual open stops the sink again, and the first start sends its own request
+    _fStartRequested = false;
+
+    _eSourceState = SourceStreamState_Opening;
+}
+
 _Use_decl_annotations_
 HRESULT NetworkMediaSourceImpl::ProcessMediaSample(
     IDataBundle* pBundle)
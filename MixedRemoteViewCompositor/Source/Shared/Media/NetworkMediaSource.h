@@ -167,6 +167,11 @@ namespace MixedRemoteViewCompositor
 
             // INetworkMediaSouce
 
+            // NetworkMediaSourceImpl
+            // When video samples back up, skip to the newest key frame instead of trimming the queue to the oldest one.
+            void SetLowLatency(_In_ bool enabled);
+            bool IsLowLatency() const { return _fLowLatency; }
+
         protected:
             HRESULT OnDataReceived(
                 _In_ IConnection *sender,
@@ -182,11 +187,19 @@ namespace MixedRemoteViewCompositor
 
             HRESULT CompleteOpen(HRESULT hResult);
             HRESULT SendDescribeRequest();
+            HRESULT SendDescribeAndStartRequest();
             HRESULT SendStartRequest();
             HRESULT SendStopRequest();
 
+            HRESULT GetSenderId(_Out_ std::wstring* pSenderId);
+            HRESULT OpenFromCachedDescription(_In_ const std::vector<BYTE>& description);
+            // drops the streams made from a cached description, so the source can open from a received one
+            void DiscardCachedOpen();
+            void ShutdownStreams();
+
             HRESULT ProcessCaptureReady();
             HRESULT ProcessMediaDescription(_In_ IDataBundle* pBundle);
+            HRESULT ProcessMediaDescriptionUnchanged();
             HRESULT ProcessMediaSample(_In_ IDataBundle* pBundle);
             HRESULT ProcessMediaTick(_In_ IDataBundle* pBundle);
             HRESULT ProcessMediaFormatChange(_In_ IDataBundle* pBundle);
@@ -221,6 +234,11 @@ namespace MixedRemoteViewCompositor
             ComPtr<IConnection> _spConnection; // Network sender
             EventRegistrationToken _evtReceivedToken;
 
+            std::wstring _senderId; // Description cache key, empty if the cache is off
+            UINT64 _descriptionHash; // Hash of the cached description the streams were created from
+            bool _fOpenedFromCache; // Streams were made from the cached description and wait for the sink to confirm it
+            bool _fStartRequested; // The sink was asked to start along with the describe request
+
             SourceStreamState _eSourceState; // Flag to indicate if Shutdown() method was called.
             Microsoft::WRL::ComPtr<IMFMediaEventQueue> _spEventQueue; // Event queue
 
@@ -228,6 +246,7 @@ namespace MixedRemoteViewCompositor
             StreamContainer _streams; // Collection of streams associated with the source
 
             float _flRate;
+            bool _fLowLatency;
         };
 
         class NetworkMediaSourceStaticsImpl
@@ -48,6 +48,7 @@ NetworkMediaSourceStreamImpl::NetworkMediaSourceStreamImpl(NetworkMediaSourceImp
     , _fDropTime(false)
     , _fInitDropTime(false)
     , _fWaitingForCleanPoint(true)
+    , _fSkipToCleanPoint(false)
     , _hnsStartDroppingAt(0)
     , _hnsAmountToDrop(0)
 {
@@ -789,6 +790,13 @@ HRESULT NetworkMediaSourceStreamImpl::DeliverSamples()
         {
             fDrop = ShouldDropSample(spSample.Get());
 
+            if (!fDrop && _fSkipToCleanPoint)
+            {
+                // the decoder can only pick up again from a key frame
+                _fSkipToCleanPoint = MFGetAttributeUINT32(spSample.Get(), MFSampleExtension_CleanPoint, 0) == 0;
+                fDrop = _fSkipToCleanPoint;
+            }
+
             if (!fDrop)
             {
                 // Get the request token
@@ -807,6 +815,10 @@ HRESULT NetworkMediaSourceStreamImpl::DeliverSamples()
                     _fDiscontinuity = false;
                 }
 
+                // playback stats
+                LOG_RESULT(spSample->SetUINT64(Mrvc_SampleDeliveryTime, MFGetSystemTime()));
+                LOG_RESULT(spSample->SetUINT32(Mrvc_SampleQueueDepth, _samples.GetCount()));
+
                 // Send a sample event.
                 LOG_RESULT_MSG(_spEventQueue->QueueEventParamUnk(MEMediaSample, GUID_NULL, S_OK, spSample.Get()), L"send sample event");
             }
@@ -830,9 +842,17 @@ HRESULT NetworkMediaSourceStreamImpl::DeliverSamples()
 
     if (!_samples.IsEmpty())
     {
-        CleanSampleQueue();
+        if (_fVideo && static_cast<NetworkMediaSourceImpl*>(_spSource.Get())->IsLowLatency())
+        {
+            // keep every sample the decoder still needs
+            SkipToNewestCleanPoint();
+        }
+        else
+        {
+            CleanSampleQueue();
 
-        _fDiscontinuity = true;
+            _fDiscontinuity = true;
+        }
     }
 
     return S_OK;
@@ -854,6 +874,7 @@ HRESULT NetworkMediaSourceStreamImpl::SetSampleAttributes(
     MediaSampleTransforms* pSampleTransforms,
     IMFSample* pSample)
 {
+    IFR_MSG(pSample->SetUINT64(Mrvc_SampleReceiveTime, MFGetSystemTime()), L"setting receive time");
     IFR_MSG(pSample->SetSampleTime(pSampleHeader->hnsTimestamp), L"setting sample time");
     IFR_MSG(pSample->SetSampleDuration(pSampleHeader->hnsDuration), L"setting sample duration");
 
@@ -947,6 +968,53 @@ void NetworkMediaSourceStreamImpl::CleanSampleQueue()
     }
 }
 
+// Drops the samples queued in front of the newest key frame, or all of them once more than
+// c_cMaxLowLatencyQueueDepth are waiting, see GetLowLatencySkipCount.
+_Use_decl_annotations_
+void NetworkMediaSourceStreamImpl::SkipToNewestCleanPoint()
+{
+    _queuedEntries.clear();
+
+    auto pos = _samples.FrontPosition();
+
+    ComPtr<IUnknown> spEntry;
+    for (; SUCCEEDED(_samples.GetItemPos(pos, &spEntry)); pos = _samples.Next(pos))
+    {
+        ComPtr<IMFSample> spSample;
+        if (FAILED(spEntry.As(&spSample)))
+        {
+            _queuedEntries.push_back(QueuedEntry_Other);
+            break;
+        }
+
+        _queuedEntries.push_back(MFGetAttributeUINT32(spSample.Get(), MFSampleExtension_CleanPoint, 0)
+            ? QueuedEntry_CleanPoint : QueuedEntry_Sample);
+    }
+
+    bool fWaitForCleanPoint = false;
+    size_t cToDrop = GetLowLatencySkipCount(_queuedEntries, c_cMaxLowLatencyQueueDepth, &fWaitForCleanPoint);
+    if (fWaitForCleanPoint)
+    {
+        _fSkipToCleanPoint = true;
+    }
+
+    if (cToDrop == 0)
+    {
+        return;
+    }
+
+    Log(Log_Level_Info, L"NetworkMediaSourceStreamImpl::SkipToNewestCleanPoint() - dropping %d samples%s\n",
+        static_cast<DWORD>(cToDrop), fWaitForCleanPoint ? L", waiting for a key frame" : L"");
+
+    for (size_t nDrop = 0; nDrop < cToDrop; ++nDrop)
+    {
+        ComPtr<IUnknown> spDropped;
+        LOG_RESULT(_samples.RemoveFront(&spDropped));
+    }
+
+    _fDiscontinuity = true;
+}
+
 _Use_decl_annotations_
 void NetworkMediaSourceStreamImpl::ResetDropTime()
 {
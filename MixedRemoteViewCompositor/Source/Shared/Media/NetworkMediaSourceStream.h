@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "LowLatencyQueue.h"
+
 namespace MixedRemoteViewCompositor
 {
     namespace Media
@@ -106,6 +108,7 @@ namespace MixedRemoteViewCompositor
 
             bool ShouldDropSample(IMFSample* pSample);
             void CleanSampleQueue();
+            void SkipToNewestCleanPoint();
             void ResetDropTime();
 
         private:
@@ -127,6 +130,8 @@ namespace MixedRemoteViewCompositor
             bool                        _fDropTime;
             bool                        _fInitDropTime;
             bool                        _fWaitingForCleanPoint;
+            bool                        _fSkipToCleanPoint;         // low latency queue was over its depth, drop samples until a key frame
+            std::vector<QueuedEntryType> _queuedEntries;
             LONGLONG                    _hnsStartDroppingAt;
             LONGLONG                    _hnsAmountToDrop;
         };
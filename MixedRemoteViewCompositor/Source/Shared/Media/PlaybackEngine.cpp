@@ -51,7 +51,11 @@ PlaybackEngineImpl::PlaybackEngineImpl()
     , _videoContext(nullptr)
     , _videoWidth(0)
     , _videoHeight(0)
+    , _captureClockOffset(0)
+    , _lastSampleTime(0)
+    , _hasCaptureClockOffset(false)
 {
+    ZeroMemory(&_stats, sizeof(_stats));
 }
 
 _Use_decl_annotations_
@@ -90,6 +94,8 @@ HRESULT PlaybackEngineImpl::RuntimeClassInitialize(
     ComPtr<IMFMediaSource> spMediaSource;
     IFR(MakeAndInitialize<NetworkMediaSourceImpl>(&spMediaSource, spConnection.Get()));
 
+    _mediaSource = spMediaSource;
+
     ComPtr<IAsyncAction> spInitSourceAction;
     IFR(spMediaSource.As(&spInitSourceAction));
 
@@ -262,6 +268,8 @@ HRESULT PlaybackEngineImpl::Uninitialize(void)
     _videoDevice = nullptr;
     _videoContext = nullptr;
 
+    _mediaSource = nullptr;
+
     _isInitialized = false;
 
     return S_OK;
@@ -288,9 +296,23 @@ HRESULT PlaybackEngineImpl::OnReadSample(
     }
 
     // since we don't render, store the data
-    _latestMediaSample[dwStreamIndex].Sample = pSample;
-    _latestMediaSample[dwStreamIndex].StreamFlags = dwStreamFlags;
-    _latestMediaSample[dwStreamIndex].Timestamp = llTimestamp;
+    {
+        auto lock = _lock.Lock();
+
+        if (nullptr != pSample
+            && nullptr != _latestMediaSample[dwStreamIndex].Sample
+            && !_latestMediaSample[dwStreamIndex].Presented)
+        {
+            // the previous frame was never presented
+            ++_stats.framesDropped;
+        }
+
+        _latestMediaSample[dwStreamIndex].Sample = pSample;
+        _latestMediaSample[dwStreamIndex].StreamFlags = dwStreamFlags;
+        _latestMediaSample[dwStreamIndex].Timestamp = llTimestamp;
+        _latestMediaSample[dwStreamIndex].DecodedTime = MFGetSystemTime();
+        _latestMediaSample[dwStreamIndex].Presented = false;
+    }
 
     if (_waitForFirstVideoSample)
     {
@@ -492,12 +514,15 @@ HRESULT PlaybackEngineImpl::GetFrameData(MediaSampleArgs* pSampleargs)
     HRESULT hr = MF_E_CAPTURE_NO_SAMPLES_IN_QUEUE;
 
     ComPtr<IMFSample> spSample;
+    MFTIME decodedTime = 0;
 
     if (nullptr != _latestMediaSample[0].Sample)
     {
         auto lock = _lock.Lock();
 
         pSampleargs->timestamp = _latestMediaSample[0].Timestamp;
+        decodedTime = _latestMediaSample[0].DecodedTime;
+        _latestMediaSample[0].Presented = true;
         IFR(_latestMediaSample[0].Sample.As(&spSample));
     }
     else
@@ -570,6 +595,8 @@ HRESULT PlaybackEngineImpl::GetFrameData(MediaSampleArgs* pSampleargs)
             pSampleargs->width = _videoWidth;
             pSampleargs->height = _videoHeight;
 
+            UpdateStats(spSample.Get(), decodedTime);
+
             LONGLONG timestamp;
             HRESULT hr = spSample->GetSampleTime(&timestamp);
             if (SUCCEEDED(hr))
@@ -627,6 +654,77 @@ done:
     return hr;
 }
 
+_Use_decl_annotations_
+HRESULT PlaybackEngineImpl::SetLowLatency(
+    bool enabled)
+{
+    Log(Log_Level_Info, L"PlaybackEngineImpl::SetLowLatency(%d)\n", enabled);
+
+    auto lock = _lock.Lock();
+
+    NULL_CHK_HR(_mediaSource, E_NOT_VALID_STATE);
+
+    // the reader is always created with MF_LOW_LATENCY, the rest is up to the source
+    static_cast<NetworkMediaSourceImpl*>(_mediaSource.Get())->SetLowLatency(enabled);
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT PlaybackEngineImpl::GetStats(
+    PlaybackStats* pStats)
+{
+    NULL_CHK(pStats);
+
+    auto lock = _lock.Lock();
+
+    *pStats = _stats;
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void PlaybackEngineImpl::UpdateStats(
+    IMFSample* pSample,
+    MFTIME decodedTime)
+{
+    auto lock = _lock.Lock();
+
+    LONGLONG sampleTime = 0;
+    _stats.timestamp = SUCCEEDED(pSample->GetSampleTime(&sampleTime)) ? sampleTime : 0;
+
+    // the decoder carries these over from the network sample, they are missing if it didn't
+    UINT64 deliveryTime = 0;
+    _stats.decodeTime = SUCCEEDED(pSample->GetUINT64(Mrvc_SampleDeliveryTime, &deliveryTime))
+        ? decodedTime - static_cast<MFTIME>(deliveryTime) : 0;
+
+    MFTIME presentTime = MFGetSystemTime();
+    UINT64 receiveTime = 0;
+    if (SUCCEEDED(pSample->GetUINT64(Mrvc_SampleReceiveTime, &receiveTime)))
+    {
+        // sample times start over when the sender restarts the stream
+        MFTIME captureClockOffset = static_cast<MFTIME>(receiveTime) - sampleTime;
+        if (!_hasCaptureClockOffset || sampleTime < _lastSampleTime || captureClockOffset < _captureClockOffset)
+        {
+            _captureClockOffset = captureClockOffset;
+            _hasCaptureClockOffset = true;
+        }
+        _lastSampleTime = sampleTime;
+
+        _stats.presentLatency = presentTime - (sampleTime + _captureClockOffset);
+        _stats.receiveLatency = presentTime - static_cast<MFTIME>(receiveTime);
+    }
+    else
+    {
+        _stats.presentLatency = 0;
+        _stats.receiveLatency = 0;
+    }
+
+    _stats.queueDepth = MFGetAttributeUINT32(pSample, Mrvc_SampleQueueDepth, 0);
+
+    ++_stats.framesPresented;
+}
+
 _Use_decl_annotations_
 HRESULT PlaybackEngineStaticsImpl::Create(
     IConnection* pConnection, 
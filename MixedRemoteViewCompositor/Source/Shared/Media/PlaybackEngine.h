@@ -18,6 +18,8 @@ namespace MixedRemoteViewCompositor
             ProcessMediaSample()
                 : StreamFlags(-1)
                 , Timestamp(0)
+                , DecodedTime(0)
+                , Presented(false)
                 , Sample(nullptr)
             {
             }
@@ -25,12 +27,16 @@ namespace MixedRemoteViewCompositor
             ProcessMediaSample(DWORD dwStreamFlags, LONGLONG llTimestamp, IMFSample* pSample)
                 : StreamFlags(dwStreamFlags)
                 , Timestamp(llTimestamp)
+                , DecodedTime(0)
+                , Presented(false)
                 , Sample(pSample)
             {
             }
 
             DWORD StreamFlags;
             LONGLONG Timestamp;
+            MFTIME DecodedTime;
+            bool Presented;
             ComPtr<IMFSample> Sample;
         };
 
@@ -247,11 +253,21 @@ namespace MixedRemoteViewCompositor
             HRESULT GetFrameData(
                 _In_ MixedRemoteViewCompositor::Plugin::MediaSampleArgs* args);
 
+            // Frames are always replaced by the newest decoded one, in low latency mode the source also
+            // skips queued video to the newest key frame instead of trimming it to the oldest one.
+            HRESULT SetLowLatency(
+                _In_ bool enabled);
+            HRESULT GetStats(
+                _Out_ MixedRemoteViewCompositor::Plugin::PlaybackStats* pStats);
+
         protected:
             HRESULT CompleteAsyncAction(
                 _In_ HRESULT hResult);
             HRESULT RequestNextSampleAsync(
                 _In_ DWORD streamId = MF_SOURCE_READER_FIRST_VIDEO_STREAM);
+            void UpdateStats(
+                _In_ IMFSample* pSample,
+                _In_ MFTIME decodedTime);
 
         private:
             Wrappers::CriticalSection _lock;
@@ -264,6 +280,7 @@ namespace MixedRemoteViewCompositor
             EventSource<ABI::MixedRemoteViewCompositor::Media::IFormatChangedEventHandler> _evtFormatChanged;
             EventSource<ABI::MixedRemoteViewCompositor::Media::ISampleUpdatedEventHandler> _evtSampleUpdated;
 
+            ComPtr<IMFMediaSource> _mediaSource;
             ComPtr<IMFSourceReader> _sourceReader;
             UINT32 _videoWidth, _videoHeight;
 
@@ -275,6 +292,12 @@ namespace MixedRemoteViewCompositor
             ComPtr<ID3D11VideoContext> _videoContext;
 
             ProcessMediaSample _latestMediaSample[2];
+
+            MixedRemoteViewCompositor::Plugin::PlaybackStats _stats;
+            // receive time minus sample time, the smallest seen since the sample times last started over
+            MFTIME _captureClockOffset;
+            LONGLONG _lastSampleTime;
+            bool _hasCaptureClockOffset;
         };
 
         class PlaybackEngineStaticsImpl
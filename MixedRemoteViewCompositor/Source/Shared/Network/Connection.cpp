@@ -6,28 +6,18 @@
 
 _Use_decl_annotations_
 inline HRESULT PrepareRemoteUrl(
-    _In_ IStreamSocketInformation* pInfo, 
+    _In_ LPCWSTR pszScheme,
+    _In_ LPCWSTR pszHost,
     _Out_ IUriRuntimeClass** ppUri)
 {
-    NULL_CHK(pInfo);
+    NULL_CHK(pszScheme);
+    NULL_CHK(pszHost);
     NULL_CHK(ppUri);
 
-    ComPtr<IStreamSocketInformation> spInfo(pInfo);
-    
-    ComPtr<IHostName> spHostName;
-    IFR(spInfo->get_RemoteHostName(&spHostName));
-
-    HostNameType spHostNameType;
-    IFR(spHostName->get_Type(&spHostNameType));
-
-    HString rawName;
-    IFR(spHostName->get_RawName(rawName.GetAddressOf()));
-
-    UINT32 length = 0;
     WCHAR pszUri[MAX_PATH];
-    IFR(StringCchPrintf(pszUri, _countof(pszUri), L"%s://%s", c_szNetworkScheme, rawName.GetRawBuffer(&length)));
+    IFR(StringCchPrintf(pszUri, _countof(pszUri), L"%s://%s", pszScheme, pszHost));
 
-    length = static_cast<UINT32>(std::wcslen(pszUri));
+    UINT32 length = static_cast<UINT32>(std::wcslen(pszUri));
 
     Microsoft::WRL::Wrappers::HString uriHString;
     IFR(WindowsCreateString(pszUri, length, uriHString.GetAddressOf()));
@@ -47,6 +37,44 @@ inline HRESULT PrepareRemoteUrl(
     return spUri.CopyTo(ppUri);
 }
 
+// media samples start with a sample header and optional camera data, which are received into a buffer of their own
+// so the sample lands at offset 0 of a pooled buffer and is attached to the IMFSample as is
+const DWORD c_cbMaxSamplePrefix = sizeof(MediaSampleHeader) + sizeof(MediaSampleTransforms);
+
+_Use_decl_annotations_
+inline bool IsSamplePrefixValid(
+    _In_ const MediaSampleHeader* pSampleHeader,
+    _In_ DWORD cbPayloadSize)
+{
+    // the receiver copies the camera data into a MediaSampleTransforms, so it can't be any larger
+    return pSampleHeader->cbCameraDataSize <= sizeof(MediaSampleTransforms)
+        &&
+        sizeof(MediaSampleHeader) + pSampleHeader->cbCameraDataSize <= cbPayloadSize;
+}
+
+_Use_decl_annotations_
+inline HRESULT PrepareRemoteUrl(
+    _In_ IStreamSocketInformation* pInfo, 
+    _Out_ IUriRuntimeClass** ppUri)
+{
+    NULL_CHK(pInfo);
+    NULL_CHK(ppUri);
+
+    ComPtr<IStreamSocketInformation> spInfo(pInfo);
+    
+    ComPtr<IHostName> spHostName;
+    IFR(spInfo->get_RemoteHostName(&spHostName));
+
+    HostNameType spHostNameType;
+    IFR(spHostName->get_Type(&spHostNameType));
+
+    HString rawName;
+    IFR(spHostName->get_RawName(rawName.GetAddressOf()));
+
+    UINT32 length = 0;
+    return PrepareRemoteUrl(c_szNetworkScheme, rawName.GetRawBuffer(&length), ppUri);
+}
+
 
 _Use_decl_annotations_
 ConnectionImpl::ConnectionImpl()
@@ -55,6 +83,11 @@ ConnectionImpl::ConnectionImpl()
     , _concurrentFailedBundles(0)
     , _streamSocket(nullptr)
     , _receivedBundle(nullptr)
+    , _payloadPool(DataBufferPool::Create())
+    , _receivedPrefixBuffer(nullptr)
+    , _cbReceivedPrefix(0)
+    , _receivedPayloadBuffer(nullptr)
+    , _cbReceivedPayload(0)
 {
     ZeroMemory(&_receivedHeader, sizeof(PayloadHeader));
 }
@@ -97,6 +130,33 @@ HRESULT ConnectionImpl::RuntimeClassInitialize(
     return WaitForHeader();
 }
 
+_Use_decl_annotations_
+HRESULT ConnectionImpl::RuntimeClassInitialize(
+    std::shared_ptr<SharedMemoryChannel> channel)
+{
+    Log(Log_Level_Info, L"ConnectionImpl::RuntimeClassInitialize(channel)\n");
+
+    NULL_CHK(channel);
+
+    auto lock = _lock.Lock();
+
+    _isInitialized = true;
+
+    _channel = channel;
+
+    ZeroMemory(&_receivedHeader, sizeof(PayloadHeader));
+    _receivedHeader.ePayloadType = PayloadType_Unknown;
+
+    ComPtr<IThreadPoolStatics> threadPoolStatics;
+    IFR(Windows::Foundation::GetActivationFactory(
+        Wrappers::HStringReference(RuntimeClass_Windows_System_Threading_ThreadPool).Get(),
+        &threadPoolStatics));
+
+    IFR(threadPoolStatics.As(&_threadPoolStatics));
+
+    return StartChannelReader();
+}
+
 
 // IModule
 _Use_decl_annotations_
@@ -136,7 +196,7 @@ HRESULT ConnectionImpl::Close(void)
 {
     Log(Log_Level_Info, L"ConnectionImpl::Close()\n");
 
-    if (nullptr == _streamSocket)
+    if (FAILED(CheckClosed()))
     {
         return S_OK;
     }
@@ -144,14 +204,24 @@ HRESULT ConnectionImpl::Close(void)
     LOG_RESULT(ResetBundle());
 
     // cleanup socket
-    ComPtr<ABI::Windows::Foundation::IClosable> closeable;
-    if SUCCEEDED(_streamSocket.As(&closeable))
+    if (nullptr != _streamSocket)
     {
-        LOG_RESULT(closeable->Close());
+        ComPtr<ABI::Windows::Foundation::IClosable> closeable;
+        if SUCCEEDED(_streamSocket.As(&closeable))
+        {
+            LOG_RESULT(closeable->Close());
+        }
+
+        _streamSocket.Reset();
+        _streamSocket = nullptr;
     }
 
-    _streamSocket.Reset();
-    _streamSocket = nullptr;
+    // the other end sees the channel closed as well
+    if (nullptr != _channel)
+    {
+        _channel->Close();
+        _channel.reset();
+    }
 
     ComPtr<IConnection> spThis(this);
     return _evtDisconnected.InvokeAll(spThis.Get());
@@ -169,12 +239,9 @@ HRESULT ConnectionImpl::get_IsConnected(
 
     auto lock = _lock.Lock();
 
-    if (nullptr == _streamSocket)
-    {
-        return MF_E_SHUTDOWN;
-    }
+    IFR(CheckClosed());
 
-    *connected = (nullptr != _streamSocket);
+    *connected = true;
 
     return S_OK;
 }
@@ -191,10 +258,7 @@ HRESULT ConnectionImpl::add_Disconnected(
 
     auto lock = _lock.Lock();
 
-    if (nullptr == _streamSocket)
-    {
-        return MF_E_SHUTDOWN;
-    }
+    IFR(CheckClosed());
 
     return _evtDisconnected.Add(eventHandler, token);
 }
@@ -222,10 +286,7 @@ HRESULT ConnectionImpl::add_Received(
 
     auto lock = _lock.Lock();
 
-    if (nullptr == _streamSocket)
-    {
-        return MF_E_SHUTDOWN;
-    }
+    IFR(CheckClosed());
 
     return _evtBundleReceived.Add(eventHandler, token);
 }
@@ -287,12 +348,23 @@ HRESULT ConnectionImpl::SendBundle(
 
     // get the output stream for socket
     ComPtr<IOutputStream> spOutputStream;
+    bool useChannel = false;
     {
         auto lock = _lock.Lock();
 
         IFR(CheckClosed());
 
-        IFR(_streamSocket->get_OutputStream(&spOutputStream));
+        useChannel = (nullptr != _channel);
+        if (!useChannel)
+        {
+            IFR(_streamSocket->get_OutputStream(&spOutputStream));
+        }
+    }
+
+    // writing can wait on the other end, so it is done outside the lock
+    if (useChannel)
+    {
+        return WriteToChannel(dataBundle);
     }
 
     DataBundleImpl* bundleImpl = static_cast<DataBundleImpl*>(dataBundle);
@@ -363,12 +435,28 @@ HRESULT ConnectionImpl::SendBundleAsync(
             {
                 IFC(_streamSocket->get_OutputStream(&spOutputStream));
             }
-            else
+            else if (nullptr == _channel)
             {
                 IFC(E_UNEXPECTED);
             }
         }
 
+        // the channel takes the whole bundle at once
+        if (nullptr == spOutputStream)
+        {
+            UINT32 bufferCount = 0;
+            IFC(spDataBundle->get_BufferCount(&bufferCount));
+
+            IFC(WriteToChannel(spDataBundle.Get()));
+
+            for (UINT32 i = 0; i < bufferCount; ++i)
+            {
+                spWriteAction->SignalCompleted(S_OK);
+            }
+
+            return S_OK;
+        }
+
         DataBundleImpl* bundleImpl = static_cast<DataBundleImpl*>(spDataBundle.Get());
         if (nullptr == bundleImpl)
         {
@@ -504,29 +592,95 @@ HRESULT ConnectionImpl::WaitForPayload()
         IFR(HRESULT_FROM_WIN32(ERROR_INVALID_STATE));
     }
 
-    ComPtr<DataBufferImpl> payloadBuffer;
-    IFR(MakeAndInitialize<DataBufferImpl>(&payloadBuffer, _receivedHeader.cbPayloadSize));
+    // a media sample's header and camera data are read first, into a small buffer of their own
+    DWORD cbPrefix = 0;
+    IFR(GetPayloadPrefixSize(&cbPrefix));
 
-    // get the underlying buffer and makes sure it the right size
-    ComPtr<IMFMediaBuffer> spMediaBuffer;
-    IFR(payloadBuffer->get_MediaBuffer(&spMediaBuffer));
+    if (_cbReceivedPrefix < cbPrefix)
+    {
+        if (nullptr == _receivedPrefixBuffer)
+        {
+            IFR(MFCreateMemoryBuffer(c_cbMaxSamplePrefix, &_receivedPrefixBuffer));
+            _cbReceivedPrefix = 0;
+        }
 
-    DWORD bufferLen = 0;
-    IFR(spMediaBuffer->GetMaxLength(&bufferLen));
+        return ReadPayloadAsync(_receivedPrefixBuffer.Get(), _cbReceivedPrefix, cbPrefix - _cbReceivedPrefix);
+    }
 
-    // should be the same as sizeof(PayloadHeader)
-    if (bufferLen != _receivedHeader.cbPayloadSize)
+    // the rest of the payload is read into one pooled buffer,
+    // so it reaches the bundle (and the decoder) in one piece without any copies
+    DWORD cbBody = _receivedHeader.cbPayloadSize - cbPrefix;
+    if (nullptr == _receivedPayloadBuffer)
+    {
+        IFR(_payloadPool->CreateBuffer(cbBody, &_receivedPayloadBuffer));
+        _cbReceivedPayload = 0;
+    }
+
+    return ReadPayloadAsync(_receivedPayloadBuffer.Get(), _cbReceivedPayload, cbBody - _cbReceivedPayload);
+}
+
+_Use_decl_annotations_
+HRESULT ConnectionImpl::GetPayloadPrefixSize(
+    DWORD* pcbPrefix)
+{
+    NULL_CHK(pcbPrefix);
+
+    *pcbPrefix = 0;
+
+    if (PayloadType_SendMediaSample != _receivedHeader.ePayloadType
+        ||
+        sizeof(MediaSampleHeader) > _receivedHeader.cbPayloadSize)
     {
-        IFR(spMediaBuffer->SetCurrentLength(_receivedHeader.cbPayloadSize))
+        return S_OK;
     }
 
+    *pcbPrefix = sizeof(MediaSampleHeader);
+
+    // the camera data size is known once the sample header is in
+    if (_cbReceivedPrefix >= sizeof(MediaSampleHeader))
+    {
+        NULL_CHK_HR(_receivedPrefixBuffer, E_NOT_VALID_STATE);
+
+        BYTE* pbPrefix = nullptr;
+        IFR(_receivedPrefixBuffer->Lock(&pbPrefix, nullptr, nullptr));
+
+        MediaSampleHeader sampleHeader = *reinterpret_cast<MediaSampleHeader*>(pbPrefix);
+
+        LOG_RESULT(_receivedPrefixBuffer->Unlock());
+
+        if (!IsSamplePrefixValid(&sampleHeader, _receivedHeader.cbPayloadSize))
+        {
+            IFR(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+        }
+
+        *pcbPrefix += sampleHeader.cbCameraDataSize;
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT ConnectionImpl::ReadPayloadAsync(
+    IMFMediaBuffer* pBuffer,
+    DWORD cbOffset,
+    DWORD cbRead)
+{
+    NULL_CHK(pBuffer);
+
+    // after a partial read, continue where it stopped in the same memory
+    IFR(pBuffer->SetCurrentLength(cbOffset));
+
+    ComPtr<DataBufferImpl> readBuffer;
+    IFR(MakeAndInitialize<DataBufferImpl>(&readBuffer, pBuffer));
+    IFR(readBuffer->put_Offset(cbOffset));
+
     // get the socket input stream reader
     ComPtr<IInputStream> spInputStream;
     IFR(_streamSocket->get_InputStream(&spInputStream));
 
     // set the read operation and wait for data
     ComPtr<IStreamReadOperation> readOperation;
-    IFR(spInputStream->ReadAsync(payloadBuffer.Get(), _receivedHeader.cbPayloadSize, InputStreamOptions::InputStreamOptions_None, &readOperation));
+    IFR(spInputStream->ReadAsync(readBuffer.Get(), cbRead, InputStreamOptions::InputStreamOptions_None, &readOperation));
 
     ComPtr<ConnectionImpl> spThis(this);
     return StartAsyncThen(
@@ -559,6 +713,11 @@ HRESULT ConnectionImpl::ResetBundle()
 
     ZeroMemory(&_receivedHeader, sizeof(PayloadHeader));
 
+    _receivedPrefixBuffer.Reset();
+    _cbReceivedPrefix = 0;
+    _receivedPayloadBuffer.Reset();
+    _cbReceivedPayload = 0;
+
     return S_OK;
 }
 
@@ -582,6 +741,289 @@ HRESULT ConnectionImpl::ProcessHeaderBuffer(
     return dataBundle.Reset();
 }
 
+_Use_decl_annotations_
+HRESULT ConnectionImpl::GetRemoteUri(
+    IUriRuntimeClass** remoteUri)
+{
+    NULL_CHK(remoteUri);
+    *remoteUri = nullptr;
+
+    IFR(CheckClosed());
+
+    if (nullptr != _channel)
+    {
+        return PrepareRemoteUrl(c_szSharedMemoryScheme, _channel->GetName().c_str(), remoteUri);
+    }
+
+    ComPtr<IStreamSocketInformation> spInfo;
+    IFR(_streamSocket->get_Information(&spInfo));
+
+    return PrepareRemoteUrl(spInfo.Get(), remoteUri);
+}
+
+_Use_decl_annotations_
+HRESULT ConnectionImpl::GetRemoteId(
+    std::wstring* remoteId)
+{
+    NULL_CHK(remoteId);
+
+    IFR(CheckClosed());
+
+    if (nullptr != _channel)
+    {
+        *remoteId = std::wstring(c_szSharedMemoryScheme) + L"://" + _channel->GetName();
+
+        return S_OK;
+    }
+
+    ComPtr<IStreamSocketInformation> spInfo;
+    IFR(_streamSocket->get_Information(&spInfo));
+
+    ComPtr<IHostName> spHostName;
+    IFR(spInfo->get_RemoteHostName(&spHostName));
+
+    HString rawName;
+    IFR(spHostName->get_RawName(rawName.GetAddressOf()));
+
+    HString remotePort;
+    IFR(spInfo->get_RemotePort(remotePort.GetAddressOf()));
+
+    UINT32 length = 0;
+    *remoteId = std::wstring(c_szNetworkScheme) + L"://" + rawName.GetRawBuffer(&length);
+    *remoteId += L":";
+    *remoteId += remotePort.GetRawBuffer(&length);
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT ConnectionImpl::StartChannelReader()
+{
+    Log(Log_Level_Info, L"ConnectionImpl::StartChannelReader()\n");
+
+    IFR(CheckClosed());
+
+    // the reader keeps its own reference, a close resets _channel while it is blocked in a read
+    std::shared_ptr<SharedMemoryChannel> channel = _channel;
+    NULL_CHK_HR(channel, E_NOT_VALID_STATE);
+
+    ComPtr<ConnectionImpl> spThis(this);
+    auto workItem =
+        Microsoft::WRL::Callback<ABI::Windows::System::Threading::IWorkItemHandler>(
+            [this, spThis, channel](IAsyncAction* asyncAction) -> HRESULT
+    {
+        HRESULT hr = S_OK;
+        do
+        {
+            hr = ReadFromChannel(channel.get());
+        } while (SUCCEEDED(hr));
+
+        LOG_RESULT(hr);
+
+        auto lock = _lock.Lock();
+
+        if (_channel != channel)
+        {
+            return S_OK;
+        }
+
+        return Close();
+    });
+
+    // runs for as long as the connection, so it gets a thread of its own
+    ComPtr<IAsyncAction> workerAsync;
+    return _threadPoolStatics->RunWithPriorityAndOptionsAsync(
+        workItem.Get(),
+        WorkItemPriority::WorkItemPriority_Normal,
+        WorkItemOptions::WorkItemOptions_TimeSliced,
+        &workerAsync);
+}
+
+_Use_decl_annotations_
+HRESULT ConnectionImpl::ReadFromChannel(
+    SharedMemoryChannel* pChannel)
+{
+    NULL_CHK(pChannel);
+
+    PayloadHeader header;
+    IFR(pChannel->Read(reinterpret_cast<BYTE*>(&header), sizeof(PayloadHeader)));
+
+    // unlike the socket there is nothing to resync on, a bad header ends the connection
+    if (header.ePayloadType == PayloadType_Unknown
+        ||
+        header.ePayloadType >= PayloadType_ENDOFLIST
+        ||
+        header.cbPayloadSize > c_cbMaxBundleSize)
+    {
+        IFR(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+    }
+
+    ComPtr<DataBufferImpl> dataBuffer;
+    if (0 == header.cbPayloadSize)
+    {
+        // same as the socket, the header is the bundle
+        IFR(MakeAndInitialize<DataBufferImpl>(&dataBuffer, static_cast<DWORD>(sizeof(PayloadHeader))));
+
+        ComPtr<Windows::Storage::Streams::IBufferByteAccess> spByteAccess;
+        IFR(dataBuffer.As(&spByteAccess));
+
+        BYTE* buffer = nullptr;
+        IFR(spByteAccess->Buffer(&buffer));
+        NULL_CHK(buffer);
+
+        CopyMemory(buffer, &header, sizeof(PayloadHeader));
+
+        IFR(dataBuffer->put_CurrentLength(sizeof(PayloadHeader)));
+    }
+
+    ComPtr<IDataBundle> dataBundle;
+    IFR(MakeAndInitialize<DataBundleImpl>(&dataBundle));
+
+    if (nullptr != dataBuffer)
+    {
+        IFR(dataBundle->AddBuffer(dataBuffer.Get()));
+    }
+
+    // same split as the socket, a media sample's header and camera data go into a buffer of their own
+    DWORD cbPrefix = 0;
+    if (PayloadType_SendMediaSample == header.ePayloadType
+        &&
+        sizeof(MediaSampleHeader) <= header.cbPayloadSize)
+    {
+        ComPtr<IMFMediaBuffer> spPrefixBuffer;
+        IFR(MFCreateMemoryBuffer(c_cbMaxSamplePrefix, &spPrefixBuffer));
+
+        BYTE* pbPrefix = nullptr;
+        IFR(spPrefixBuffer->Lock(&pbPrefix, nullptr, nullptr));
+
+        HRESULT hr = pChannel->Read(pbPrefix, sizeof(MediaSampleHeader));
+        if (SUCCEEDED(hr))
+        {
+            MediaSampleHeader* pSampleHeader = reinterpret_cast<MediaSampleHeader*>(pbPrefix);
+            if (!IsSamplePrefixValid(pSampleHeader, header.cbPayloadSize))
+            {
+                hr = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            else
+            {
+                cbPrefix = sizeof(MediaSampleHeader) + pSampleHeader->cbCameraDataSize;
+                hr = pChannel->Read(pbPrefix + sizeof(MediaSampleHeader), pSampleHeader->cbCameraDataSize);
+            }
+        }
+
+        LOG_RESULT(spPrefixBuffer->Unlock());
+
+        IFR(hr);
+
+        IFR(spPrefixBuffer->SetCurrentLength(cbPrefix));
+
+        ComPtr<DataBufferImpl> prefixBuffer;
+        IFR(MakeAndInitialize<DataBufferImpl>(&prefixBuffer, spPrefixBuffer.Get()));
+
+        IFR(dataBundle->AddBuffer(prefixBuffer.Get()));
+    }
+
+    // the rest is copied once, straight out of the ring into a pooled buffer
+    DWORD cbBody = header.cbPayloadSize - cbPrefix;
+    if (0 < cbBody)
+    {
+        ComPtr<IMFMediaBuffer> spMediaBuffer;
+        IFR(_payloadPool->CreateBuffer(cbBody, &spMediaBuffer));
+
+        BYTE* pbPayload = nullptr;
+        IFR(spMediaBuffer->Lock(&pbPayload, nullptr, nullptr));
+
+        HRESULT hr = pChannel->Read(pbPayload, cbBody);
+
+        LOG_RESULT(spMediaBuffer->Unlock());
+
+        IFR(hr);
+
+        IFR(spMediaBuffer->SetCurrentLength(cbBody));
+
+        ComPtr<DataBufferImpl> payloadBuffer;
+        IFR(MakeAndInitialize<DataBufferImpl>(&payloadBuffer, spMediaBuffer.Get()));
+
+        IFR(dataBundle->AddBuffer(payloadBuffer.Get()));
+    }
+
+    auto lock = _lock.Lock();
+
+    LOG_RESULT(NotifyBundleComplete(header.ePayloadType, dataBundle.Get()));
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT ConnectionImpl::WriteToChannel(
+    IDataBundle* dataBundle)
+{
+    NULL_CHK(dataBundle);
+
+    std::shared_ptr<SharedMemoryChannel> channel;
+    {
+        auto lock = _lock.Lock();
+
+        IFR(CheckClosed());
+
+        channel = _channel;
+    }
+    NULL_CHK_HR(channel, E_NOT_VALID_STATE);
+
+    DataBundleImpl* bundleImpl = static_cast<DataBundleImpl*>(dataBundle);
+    NULL_CHK_HR(bundleImpl, E_INVALIDARG);
+
+    DataBundleImpl::Container buffers;
+    IFR(bundleImpl->get_Buffers(&buffers));
+
+    HRESULT hr = S_OK;
+    {
+        // the buffers of a bundle make up one message, they can't interleave with another one
+        auto writeLock = _channelWriteLock.Lock();
+
+        DataBundleImpl::Iterator iter = buffers.begin();
+        for (; SUCCEEDED(hr) && iter != buffers.end(); ++iter)
+        {
+            ComPtr<IBuffer> rawBuffer;
+            hr = (*iter).As(&rawBuffer);
+            if (FAILED(hr))
+            {
+                break;
+            }
+
+            UINT32 length = 0;
+            hr = rawBuffer->get_Length(&length);
+            if (FAILED(hr))
+            {
+                break;
+            }
+
+            BYTE* pData = GetDataType<BYTE*>(rawBuffer.Get());
+            hr = (nullptr != pData) ? channel->Write(pData, length) : E_INVALIDARG;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        return S_OK;
+    }
+
+    LOG_RESULT(hr);
+
+    // part of the message may already be in the ring and the reader can't resync on it,
+    // so the channel is closed before anything else gets written
+    channel->Close();
+
+    auto lock = _lock.Lock();
+
+    if (_channel == channel)
+    {
+        LOG_RESULT(Close());
+    }
+
+    return hr;
+}
+
 _Use_decl_annotations_
 HRESULT ConnectionImpl::NotifyBundleComplete(
     PayloadType payloadType,
@@ -596,11 +1038,8 @@ HRESULT ConnectionImpl::NotifyBundleComplete(
         return S_OK;
     }
 
-    ComPtr<IStreamSocketInformation> spInfo;
-    IFR(_streamSocket->get_Information(&spInfo));
-
     ComPtr<IUriRuntimeClass> spUri;
-    IFR(PrepareRemoteUrl(spInfo.Get(), &spUri));
+    IFR(GetRemoteUri(&spUri));
 
     ComPtr<IBundleReceivedArgs> args;
     IFR(MakeAndInitialize<DataBundleArgsImpl>(&args, payloadType, this, dataBundle, spUri.Get()));
@@ -718,64 +1157,91 @@ HRESULT ConnectionImpl::OnPayloadReceived(
     UINT32 bytesRead = -1;
     IFR(buffer->get_Length(&bytesRead));
 
-    ComPtr<IDataBuffer> dataBuffer;
-    IFR(buffer.As(&dataBuffer));
+    DWORD cbPrefix = 0;
+    DWORD cbExpected = 0;
+    boolean fPrefixRead = false;
 
-    DWORD bufferSize = -1;
-    IFR(dataBuffer->get_CurrentLength(&bufferSize));
-
-    // makes sure this is the expected size
-    if (c_cbMaxBundleSize < _receivedHeader.cbPayloadSize
-        ||
-        bytesRead > _receivedHeader.cbPayloadSize
+    // still have a valid payload type
+    if (_receivedHeader.ePayloadType == PayloadType_Unknown
         ||
-        bytesRead == 0
+        _receivedHeader.ePayloadType >= PayloadType_ENDOFLIST
         ||
-        bytesRead != bufferSize)
+        FAILED(GetPayloadPrefixSize(&cbPrefix)))
     {
         _concurrentFailedBundles++;
 
         goto done;
     }
 
-    // still have a valid payload type
-    if (_receivedHeader.ePayloadType == PayloadType_Unknown
+    // the read was for the sample header and camera data until they are complete, then for the rest
+    fPrefixRead = _cbReceivedPrefix < cbPrefix;
+    cbExpected = fPrefixRead
+        ? cbPrefix - _cbReceivedPrefix
+        : _receivedHeader.cbPayloadSize - cbPrefix - _cbReceivedPayload;
+
+    // makes sure this is the expected size
+    if (c_cbMaxBundleSize < _receivedHeader.cbPayloadSize
         ||
-        _receivedHeader.ePayloadType >= PayloadType_ENDOFLIST)
+        bytesRead > cbExpected
+        ||
+        bytesRead == 0)
     {
         _concurrentFailedBundles++;
 
         goto done;
     }
 
-    // create bundle to hold all buffers
+    if (fPrefixRead)
+    {
+        _cbReceivedPrefix += bytesRead;
+
+        // the sample header may have just come in, with the size of the camera data after it
+        if (FAILED(GetPayloadPrefixSize(&cbPrefix)))
+        {
+            _concurrentFailedBundles++;
+
+            goto done;
+        }
+    }
+    else
+    {
+        _cbReceivedPayload += bytesRead;
+    }
+
+    // do we have the complete payload?
+    if (_cbReceivedPrefix < cbPrefix
+        ||
+        _cbReceivedPayload < _receivedHeader.cbPayloadSize - cbPrefix)
+    {
+        return WaitForPayload();
+    }
+
+    // create bundle to hold the payload
     if (nullptr == _receivedBundle)
     {
         IFR(MakeAndInitialize<DataBundleImpl>(&_receivedBundle));
     }
 
-    ULONG bundleSize = 0;
-    IFR(_receivedBundle->get_TotalSize(&bundleSize));
-
-    // before adding the new buffer, make sure that doesn't exceed the payload size
-    ULONG expectedSize = _receivedHeader.cbPayloadSize - bundleSize;
-    if (bufferSize > expectedSize)
+    // a media sample's header and camera data come first in a buffer of their own,
+    // once they are moved out the sample is left in the pooled buffer at offset 0
+    if (0 < cbPrefix)
     {
-        ComPtr<IDataBuffer> spTrimmed;
-        IFR(dataBuffer->TrimRight(expectedSize, &spTrimmed))
-    };
+        IFR(_receivedPrefixBuffer->SetCurrentLength(cbPrefix));
 
-    // add the buffer to the bundle
-    _receivedBundle->AddBuffer(dataBuffer.Get());
+        ComPtr<DataBufferImpl> prefixBuffer;
+        IFR(MakeAndInitialize<DataBufferImpl>(&prefixBuffer, _receivedPrefixBuffer.Get()));
 
-    // recalculate the bundle size
-    bundleSize = 0;
-    IFR(_receivedBundle->get_TotalSize(&bundleSize));
+        IFR(_receivedBundle->AddBuffer(prefixBuffer.Get()));
+    }
 
-    // do we have a complete bundle?
-    if (bundleSize < _receivedHeader.cbPayloadSize)
+    if (nullptr != _receivedPayloadBuffer)
     {
-        return WaitForPayload();
+        IFR(_receivedPayloadBuffer->SetCurrentLength(_cbReceivedPayload));
+
+        ComPtr<DataBufferImpl> payloadBuffer;
+        IFR(MakeAndInitialize<DataBufferImpl>(&payloadBuffer, _receivedPayloadBuffer.Get()));
+
+        IFR(_receivedBundle->AddBuffer(payloadBuffer.Get()));
     }
 
     // store the bundle data to be used for notification
@@ -124,6 +124,8 @@ namespace MixedRemoteViewCompositor
             // RuntimeClass
             STDMETHODIMP RuntimeClassInitialize(
                 _In_ ABI::Windows::Networking::Sockets::IStreamSocket *socket);
+            STDMETHODIMP RuntimeClassInitialize(
+                _In_ std::shared_ptr<MixedRemoteViewCompositor::Network::SharedMemoryChannel> channel);
 
             // IModule
             IFACEMETHOD(get_IsInitialized)(
@@ -154,11 +156,18 @@ namespace MixedRemoteViewCompositor
                 _In_ ABI::MixedRemoteViewCompositor::Network::IDataBundle *dataBundle,
                 _Out_ ABI::Windows::Foundation::IAsyncAction **sendAction);
 
+            // remote end of the socket as an mrvc:// uri (shm:// for shared memory), the same one passed with each received bundle
+            STDMETHODIMP GetRemoteUri(
+                _COM_Outptr_ ABI::Windows::Foundation::IUriRuntimeClass** remoteUri);
+            // remote end including the port (the channel name for shared memory), which tells apart senders on one host
+            STDMETHODIMP GetRemoteId(
+                _Out_ std::wstring* remoteId);
+
         protected:
             // IConnectionInternal
             inline IFACEMETHOD(CheckClosed)()
             {
-                return (nullptr != _streamSocket) ? S_OK : MF_E_SHUTDOWN;
+                return (nullptr != _streamSocket || nullptr != _channel) ? S_OK : MF_E_SHUTDOWN;
             }
             IFACEMETHOD(WaitForHeader)();
             IFACEMETHOD(WaitForPayload)();
@@ -180,6 +189,22 @@ namespace MixedRemoteViewCompositor
                 _In_ PayloadHeader* header,
                 _In_ ABI::MixedRemoteViewCompositor::Network::IDataBuffer *dataBuffer);
 
+            // size of the media sample header and camera data at the start of the incoming payload, 0 for other payloads
+            HRESULT GetPayloadPrefixSize(
+                _Out_ DWORD* pcbPrefix);
+            // reads cbRead bytes of the incoming payload into pBuffer, after the cbOffset bytes already there
+            HRESULT ReadPayloadAsync(
+                _In_ IMFMediaBuffer* pBuffer,
+                _In_ DWORD cbOffset,
+                _In_ DWORD cbRead);
+
+            // shared memory counterparts of WaitForHeader/WaitForPayload and the socket writes
+            HRESULT StartChannelReader();
+            HRESULT ReadFromChannel(
+                _In_ MixedRemoteViewCompositor::Network::SharedMemoryChannel* pChannel);
+            HRESULT WriteToChannel(
+                _In_ ABI::MixedRemoteViewCompositor::Network::IDataBundle *dataBundle);
+
         private:
             Wrappers::CriticalSection _lock;
 
@@ -190,11 +215,23 @@ namespace MixedRemoteViewCompositor
             ComPtr<IThreadPoolStatics> _threadPoolStatics;
             ComPtr<ABI::Windows::Networking::Sockets::IStreamSocket>    _streamSocket;
 
+            // set instead of the socket for a same machine connection
+            std::shared_ptr<MixedRemoteViewCompositor::Network::SharedMemoryChannel> _channel;
+            Wrappers::CriticalSection _channelWriteLock;
+
             ComPtr<MixedRemoteViewCompositor::Network::DataBufferImpl>  _spHeaderBuffer;
 
             // currently bundle that is incoming
             PayloadHeader _receivedHeader;
             ComPtr<ABI::MixedRemoteViewCompositor::Network::IDataBundle>    _receivedBundle;
+
+            // payload that is incoming, a media sample's header and camera data in a small buffer
+            // and the rest read straight into one buffer from the pool
+            std::shared_ptr<MixedRemoteViewCompositor::Network::DataBufferPool> _payloadPool;
+            ComPtr<IMFMediaBuffer> _receivedPrefixBuffer;
+            DWORD _cbReceivedPrefix;
+            ComPtr<IMFMediaBuffer> _receivedPayloadBuffer;
+            DWORD _cbReceivedPayload;
             EventSource<ABI::MixedRemoteViewCompositor::Network::IDisconnectedEventHandler>    _evtDisconnected;
             EventSource<ABI::MixedRemoteViewCompositor::Network::IBundleReceivedEventHandler>    _evtBundleReceived;
         };
@@ -41,6 +41,21 @@ HRESULT ConnectorImpl::RuntimeClassInitialize(
     return S_OK;
 }
 
+_Use_decl_annotations_
+HRESULT ConnectorImpl::RuntimeClassInitialize(
+    LPCWSTR sharedMemoryName)
+{
+    Log(Log_Level_Info, L"ConnectorImpl::RuntimeClassInitialize(%s)\n", sharedMemoryName);
+
+    NULL_CHK(sharedMemoryName);
+
+    _sharedMemoryName = sharedMemoryName;
+
+    _isInitialized = true;
+
+    return S_OK;
+}
+
 _Use_decl_annotations_
 HRESULT ConnectorImpl::get_IsInitialized(
     boolean* initialized)
@@ -145,7 +160,16 @@ HRESULT ConnectorImpl::GetResults(
     IFR(AsyncBase::CheckValidStateForResultsCall());
 
     ComPtr<ConnectionImpl> spConnection;
-    IFR(Microsoft::WRL::MakeAndInitialize<ConnectionImpl>(&spConnection, _streamSocketResult.Detach()));
+    if (nullptr != _channelResult)
+    {
+        // the connection owns the channel from here on
+        IFR(Microsoft::WRL::MakeAndInitialize<ConnectionImpl>(&spConnection, _channelResult));
+        _channelResult.reset();
+    }
+    else
+    {
+        IFR(Microsoft::WRL::MakeAndInitialize<ConnectionImpl>(&spConnection, _streamSocketResult.Detach()));
+    }
 
     NULL_CHK_HR(spConnection, E_NOT_SET);
 
@@ -157,6 +181,20 @@ HRESULT ConnectorImpl::GetResults(
 _Use_decl_annotations_
 HRESULT ConnectorImpl::OnStart(void)
 {
+    if (!_sharedMemoryName.empty())
+    {
+        auto lock = _lock.Lock();
+
+        // the listener has already created the channel, so there is nothing to wait for
+        HRESULT hr = SharedMemoryChannel::Open(_sharedMemoryName.c_str(), &_channelResult);
+        if (FAILED(hr))
+        {
+            TryTransitionToError(hr);
+        }
+
+        return FireCompletion();
+    }
+
     // set port as a string
     std::wstring wsPort = to_wstring(_port);
 
@@ -232,4 +270,14 @@ void ConnectorImpl::CloseInternal(void)
     }
     _streamSocketResult.Reset();
     _streamSocketResult = nullptr;
+
+    // not handed to a connection yet
+    if (nullptr != _channelResult)
+    {
+        _channelResult->Close();
+
+        ComPtr<IConnector> spThis(this);
+        LOG_RESULT(_evtClosed.InvokeAll(spThis.Get()));
+    }
+    _channelResult.reset();
 }
@@ -25,6 +25,9 @@ namespace MixedRemoteViewCompositor
             STDMETHODIMP RuntimeClassInitialize(
                 _In_ IHostName* hostName,
                 _In_ UINT16 port);
+            // connects to a listener on this machine through the shared memory channel named sharedMemoryName
+            STDMETHODIMP RuntimeClassInitialize(
+                _In_ LPCWSTR sharedMemoryName);
 
             // IModule
             IFACEMETHOD(get_IsInitialized)(
@@ -66,6 +69,9 @@ namespace MixedRemoteViewCompositor
             Microsoft::WRL::EventSource<IClosedEventHandler> _evtClosed;
 
             ComPtr<IStreamSocket> _streamSocketResult;
+
+            std::wstring _sharedMemoryName;
+            std::shared_ptr<SharedMemoryChannel> _channelResult;
         };
 
         class ConnectorStaticsImpl
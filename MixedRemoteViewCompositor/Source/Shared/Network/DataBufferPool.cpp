@@ -0,0 +1,199 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+#include "DataBufferPool.h"
+
+std::shared_ptr<DataBufferPool> DataBufferPool::Create()
+{
+    return std::shared_ptr<DataBufferPool>(new DataBufferPool());
+}
+
+DataBufferPool::~DataBufferPool()
+{
+    for (auto& sizeBlocks : _freeBlocks)
+    {
+        for (BYTE* pBlock : sizeBlocks.second)
+        {
+            _aligned_free(pBlock);
+        }
+    }
+    _freeBlocks.clear();
+}
+
+_Use_decl_annotations_
+HRESULT DataBufferPool::CreateBuffer(
+    DWORD cbMaxLength,
+    IMFMediaBuffer** ppBuffer)
+{
+    NULL_CHK(ppBuffer);
+    *ppBuffer = nullptr;
+
+    // round up to the block size
+    DWORD cbBlockSize = c_cbMinPooledBlockSize;
+    while (cbBlockSize < cbMaxLength)
+    {
+        if (cbBlockSize > (MAXDWORD >> 1))
+        {
+            IFR(E_INVALIDARG);
+        }
+        cbBlockSize <<= 1;
+    }
+
+    BYTE* pBlock = nullptr;
+    {
+        auto lock = _lock.Lock();
+
+        auto iter = _freeBlocks.find(cbBlockSize);
+        if (iter != _freeBlocks.end() && !iter->second.empty())
+        {
+            pBlock = iter->second.back();
+            iter->second.pop_back();
+        }
+    }
+
+    if (nullptr == pBlock)
+    {
+        pBlock = static_cast<BYTE*>(_aligned_malloc(cbBlockSize, 16));
+        NULL_CHK_HR(pBlock, E_OUTOFMEMORY);
+    }
+
+    ComPtr<PooledBufferImpl> spBuffer;
+    HRESULT hr = MakeAndInitialize<PooledBufferImpl>(&spBuffer, shared_from_this(), pBlock, cbBlockSize);
+    if (FAILED(hr))
+    {
+        Recycle(pBlock, cbBlockSize);
+        IFR(hr);
+    }
+
+    return spBuffer.CopyTo(ppBuffer);
+}
+
+_Use_decl_annotations_
+void DataBufferPool::Recycle(
+    BYTE* pBlock,
+    DWORD cbBlockSize)
+{
+    if (nullptr == pBlock)
+    {
+        return;
+    }
+
+    {
+        auto lock = _lock.Lock();
+
+        auto& sizeBlocks = _freeBlocks[cbBlockSize];
+        if (sizeBlocks.size() < c_cPooledBlocksPerSize)
+        {
+            sizeBlocks.push_back(pBlock);
+            return;
+        }
+    }
+
+    _aligned_free(pBlock);
+}
+
+
+PooledBufferImpl::PooledBufferImpl()
+    : _pool(nullptr)
+    , _pBlock(nullptr)
+    , _cbBlockSize(0)
+    , _cbCurrentLength(0)
+{
+}
+
+PooledBufferImpl::~PooledBufferImpl()
+{
+    if (nullptr != _pool)
+    {
+        _pool->Recycle(_pBlock, _cbBlockSize);
+    }
+    else
+    {
+        _aligned_free(_pBlock);
+    }
+
+    _pBlock = nullptr;
+}
+
+_Use_decl_annotations_
+HRESULT PooledBufferImpl::RuntimeClassInitialize(
+    std::shared_ptr<DataBufferPool> pool,
+    BYTE* pBlock,
+    DWORD cbBlockSize)
+{
+    NULL_CHK(pBlock);
+
+    _pool = pool;
+    _pBlock = pBlock;
+    _cbBlockSize = cbBlockSize;
+    _cbCurrentLength = 0;
+
+    return S_OK;
+}
+
+// IMFMediaBuffer
+_Use_decl_annotations_
+HRESULT PooledBufferImpl::Lock(
+    BYTE** ppbBuffer,
+    DWORD* pcbMaxLength,
+    DWORD* pcbCurrentLength)
+{
+    NULL_CHK(ppbBuffer);
+
+    *ppbBuffer = _pBlock;
+
+    if (nullptr != pcbMaxLength)
+    {
+        *pcbMaxLength = _cbBlockSize;
+    }
+
+    if (nullptr != pcbCurrentLength)
+    {
+        *pcbCurrentLength = _cbCurrentLength;
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT PooledBufferImpl::Unlock()
+{
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT PooledBufferImpl::GetCurrentLength(
+    DWORD* pcbCurrentLength)
+{
+    NULL_CHK(pcbCurrentLength);
+
+    *pcbCurrentLength = _cbCurrentLength;
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT PooledBufferImpl::SetCurrentLength(
+    DWORD cbCurrentLength)
+{
+    if (cbCurrentLength > _cbBlockSize)
+    {
+        IFR(E_INVALIDARG);
+    }
+
+    _cbCurrentLength = cbCurrentLength;
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT PooledBufferImpl::GetMaxLength(
+    DWORD* pcbMaxLength)
+{
+    NULL_CHK(pcbMaxLength);
+
+    *pcbMaxLength = _cbBlockSize;
+
+    return S_OK;
+}
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+namespace MixedRemoteViewCompositor
+{
+    namespace Network
+    {
+        // number of blocks of each size kept for reuse
+        const UINT32 c_cPooledBlocksPerSize = 4;
+        // smallest block handed out, smaller requests are rounded up to it
+        const DWORD c_cbMinPooledBlockSize = 4096;
+
+        // Memory for received payloads.  Blocks are rounded up to a power of 2 so payloads of similar size
+        // (eg: encoded frames) reuse the same blocks, and a block goes back to the pool when the last
+        // reference to its media buffer is released, which can be after a decoder is done with it.
+        class DataBufferPool
+            : public std::enable_shared_from_this<DataBufferPool>
+        {
+        public:
+            static std::shared_ptr<DataBufferPool> Create();
+            ~DataBufferPool();
+
+            // media buffer of at least cbMaxLength bytes, with a current length of 0
+            HRESULT CreateBuffer(
+                _In_ DWORD cbMaxLength,
+                _COM_Outptr_ IMFMediaBuffer** ppBuffer);
+
+            void Recycle(
+                _In_ BYTE* pBlock,
+                _In_ DWORD cbBlockSize);
+
+        private:
+            DataBufferPool() {}
+
+            Wrappers::CriticalSection _lock;
+
+            std::map<DWORD, std::vector<BYTE*>> _freeBlocks;
+        };
+
+        class PooledBufferImpl
+            : public RuntimeClass
+            < RuntimeClassFlags<ClassicCom>
+            , IMFMediaBuffer >
+        {
+        public:
+            PooledBufferImpl();
+            ~PooledBufferImpl();
+
+            STDMETHODIMP RuntimeClassInitialize(
+                _In_ std::shared_ptr<DataBufferPool> pool,
+                _In_ BYTE* pBlock,
+                _In_ DWORD cbBlockSize);
+
+            // IMFMediaBuffer
+            IFACEMETHOD(Lock)(
+                _Outptr_result_bytebuffer_to_(*pcbMaxLength, *pcbCurrentLength) BYTE** ppbBuffer,
+                _Out_opt_ DWORD* pcbMaxLength,
+                _Out_opt_ DWORD* pcbCurrentLength);
+            IFACEMETHOD(Unlock)();
+            IFACEMETHOD(GetCurrentLength)(
+                _Out_ DWORD* pcbCurrentLength);
+            IFACEMETHOD(SetCurrentLength)(
+                _In_ DWORD cbCurrentLength);
+            IFACEMETHOD(GetMaxLength)(
+                _Out_ DWORD* pcbMaxLength);
+
+        private:
+            std::shared_ptr<DataBufferPool> _pool;
+
+            BYTE* _pBlock;
+            DWORD _cbBlockSize;
+            DWORD _cbCurrentLength;
+        };
+    }
+}
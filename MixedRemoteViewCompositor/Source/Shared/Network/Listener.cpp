@@ -37,6 +37,22 @@ HRESULT ListenerImpl::RuntimeClassInitialize(UINT16 port)
     return S_OK;
 }
 
+_Use_decl_annotations_
+HRESULT ListenerImpl::RuntimeClassInitialize(LPCWSTR sharedMemoryName)
+{
+    Log(Log_Level_Info, L"ListenerImpl::RuntimeClassInitialize(%s)\n", sharedMemoryName);
+
+    NULL_CHK(sharedMemoryName);
+
+    auto lock = _lock.Lock();
+
+    _isInitialized = true;
+
+    _sharedMemoryName = sharedMemoryName;
+
+    return S_OK;
+}
+
 // ModuleBaseImpl
 _Use_decl_annotations_
 HRESULT ListenerImpl::get_IsInitialized(
@@ -167,7 +183,16 @@ HRESULT ListenerImpl::GetResults(
     IFR(AsyncBase::CheckValidStateForResultsCall());
 
     ComPtr<ConnectionImpl> spConnection;
-    IFR(Microsoft::WRL::MakeAndInitialize<ConnectionImpl>(&spConnection, _streamSocketResult.Detach()));
+    if (nullptr != _channel)
+    {
+        // the connection owns the channel from here on
+        IFR(Microsoft::WRL::MakeAndInitialize<ConnectionImpl>(&spConnection, _channel));
+        _channel.reset();
+    }
+    else
+    {
+        IFR(Microsoft::WRL::MakeAndInitialize<ConnectionImpl>(&spConnection, _streamSocketResult.Detach()));
+    }
 
     NULL_CHK_HR(spConnection, E_OUTOFMEMORY);
 
@@ -183,6 +208,11 @@ HRESULT ListenerImpl::OnStart(void)
 
     Log(Log_Level_Info, L"ListenerImpl::OnStart()\n");
 
+    if (!_sharedMemoryName.empty())
+    {
+        return StartSharedMemory();
+    }
+
     // convert port to string
     std::wstring wsPort = to_wstring(_port);
 
@@ -226,6 +256,41 @@ HRESULT ListenerImpl::OnStart(void)
     });
 }
 
+_Use_decl_annotations_
+HRESULT ListenerImpl::StartSharedMemory()
+{
+    Log(Log_Level_Info, L"ListenerImpl::StartSharedMemory()\n");
+
+    IFR(SharedMemoryChannel::Create(_sharedMemoryName.c_str(), &_channel));
+
+    ComPtr<IThreadPoolStatics> threadPoolStatics;
+    IFR(Windows::Foundation::GetActivationFactory(
+        Wrappers::HStringReference(RuntimeClass_Windows_System_Threading_ThreadPool).Get(),
+        &threadPoolStatics));
+
+    // there is no ConnectionReceived event, wait for the connector on the thread pool instead
+    std::shared_ptr<SharedMemoryChannel> channel = _channel;
+    ComPtr<ListenerImpl> spThis(this);
+    auto workItem =
+        Microsoft::WRL::Callback<ABI::Windows::System::Threading::IWorkItemHandler>(
+            [this, spThis, channel](IAsyncAction* asyncAction) -> HRESULT
+    {
+        HRESULT hr = channel->WaitForConnection();
+
+        auto lock = _lock.Lock();
+
+        if (FAILED(hr))
+        {
+            TryTransitionToError(hr);
+        }
+
+        return FireCompletion();
+    });
+
+    ComPtr<IAsyncAction> workerAsync;
+    return threadPoolStatics->RunAsync(workItem.Get(), &workerAsync);
+}
+
 _Use_decl_annotations_
 void ListenerImpl::OnClose(void)
 {
@@ -270,4 +335,14 @@ void ListenerImpl::CloseInternal()
     }
     _streamSocketResult.Reset();
     _streamSocketResult = nullptr;
+
+    // not handed to a connection yet
+    if (nullptr != _channel)
+    {
+        _channel->Close();
+
+        ComPtr<IListener> spThis(this);
+        LOG_RESULT(_evtClosed.InvokeAll(spThis.Get()));
+    }
+    _channel.reset();
 }
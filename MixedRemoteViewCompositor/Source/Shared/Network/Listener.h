@@ -27,6 +27,9 @@ namespace MixedRemoteViewCompositor
 
             STDMETHODIMP RuntimeClassInitialize(
                 _In_ UINT16 port);
+            // same machine connections only, through a shared memory channel named sharedMemoryName
+            STDMETHODIMP RuntimeClassInitialize(
+                _In_ LPCWSTR sharedMemoryName);
 
             // IModule
             IFACEMETHOD(get_IsInitialized)(
@@ -62,6 +65,7 @@ namespace MixedRemoteViewCompositor
 
         private:
             STDMETHODIMP_(void) CloseInternal();
+            HRESULT StartSharedMemory();
 
             inline HRESULT CheckClosed() const
             {
@@ -80,6 +84,9 @@ namespace MixedRemoteViewCompositor
             EventRegistrationToken          _connectionReceivedEventToken;
 
             ComPtr<IStreamSocket>           _streamSocketResult;
+
+            std::wstring                    _sharedMemoryName;
+            std::shared_ptr<SharedMemoryChannel>    _channel;
         };
 
         class ListenerStaticsImpl
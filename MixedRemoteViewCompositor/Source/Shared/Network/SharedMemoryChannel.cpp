@@ -0,0 +1,293 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+#include "SharedMemoryChannel.h"
+
+// 'MRVC'
+const LONG c_lSharedMemoryMagic = 0x4D525643;
+
+// the rings start on the page after the header
+const DWORD c_cbSharedMemoryHeaderSize = 4096;
+
+_Use_decl_annotations_
+HRESULT SharedMemoryChannel::Create(
+    LPCWSTR pszName,
+    std::shared_ptr<SharedMemoryChannel>* pChannel)
+{
+    Log(Log_Level_Info, L"SharedMemoryChannel::Create(%s)\n", pszName);
+
+    NULL_CHK(pszName);
+    NULL_CHK(pChannel);
+
+    std::shared_ptr<SharedMemoryChannel> channel(new SharedMemoryChannel(true));
+    NULL_CHK_HR(channel, E_OUTOFMEMORY);
+
+    IFR(channel->Initialize(pszName));
+
+    *pChannel = channel;
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT SharedMemoryChannel::Open(
+    LPCWSTR pszName,
+    std::shared_ptr<SharedMemoryChannel>* pChannel)
+{
+    Log(Log_Level_Info, L"SharedMemoryChannel::Open(%s)\n", pszName);
+
+    NULL_CHK(pszName);
+    NULL_CHK(pChannel);
+
+    std::shared_ptr<SharedMemoryChannel> channel(new SharedMemoryChannel(false));
+    NULL_CHK_HR(channel, E_OUTOFMEMORY);
+
+    IFR(channel->Initialize(pszName));
+
+    *pChannel = channel;
+
+    return S_OK;
+}
+
+SharedMemoryChannel::SharedMemoryChannel(bool isListener)
+    : _pHeader(nullptr)
+    , _generation(0)
+    , _isListener(isListener)
+    , _isAttached(false)
+{
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+    Log(Log_Level_Info, L"SharedMemoryChannel::~SharedMemoryChannel()\n");
+
+    Close();
+
+    if (nullptr != _pHeader)
+    {
+        UnmapViewOfFile(_pHeader);
+        _pHeader = nullptr;
+    }
+}
+
+_Use_decl_annotations_
+HRESULT SharedMemoryChannel::Initialize(
+    LPCWSTR pszName)
+{
+    // names are compared like host names, both ends have to end up with the same kernel object names
+    _name = pszName;
+    CharLowerBuffW(&_name[0], static_cast<DWORD>(_name.size()));
+
+    std::wstring wsMapping = L"mrvc_shm_" + _name;
+
+    ULONG64 cbRegion = c_cbSharedMemoryHeaderSize + 2 * static_cast<ULONG64>(c_cbSharedMemoryRingSize);
+
+    _hMapping.Attach(CreateFileMappingFromApp(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, cbRegion, wsMapping.c_str()));
+    if (!_hMapping.IsValid())
+    {
+        IFR(HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    bool alreadyExists = (ERROR_ALREADY_EXISTS == GetLastError());
+    if (!_isListener && !alreadyExists)
+    {
+        // created a new region, so there is no listener
+        IFR(HRESULT_FROM_WIN32(ERROR_CONNECTION_REFUSED));
+    }
+
+    _pHeader = static_cast<RegionHeader*>(MapViewOfFileFromApp(_hMapping.Get(), FILE_MAP_READ | FILE_MAP_WRITE, 0, static_cast<SIZE_T>(cbRegion)));
+    NULL_CHK_HR(_pHeader, HRESULT_FROM_WIN32(GetLastError()));
+
+    // the region outlives a closed channel for as long as the other end still has it mapped,
+    // so only a region with a live listener on it is refused, a closed one is taken over below
+    if (_isListener
+        &&
+        alreadyExists
+        &&
+        c_lSharedMemoryMagic == _pHeader->magic
+        &&
+        0 == _pHeader->closed)
+    {
+        IFR(HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS));
+    }
+
+    BYTE* pRingData = reinterpret_cast<BYTE*>(_pHeader) + c_cbSharedMemoryHeaderSize;
+
+    UINT32 writeIndex = _isListener ? 0 : 1;
+    UINT32 readIndex = _isListener ? 1 : 0;
+
+    _writeRing.Attach(&_pHeader->rings[writeIndex], pRingData + writeIndex * c_cbSharedMemoryRingSize, c_cbSharedMemoryRingSize);
+    _readRing.Attach(&_pHeader->rings[readIndex], pRingData + readIndex * c_cbSharedMemoryRingSize, c_cbSharedMemoryRingSize);
+
+    // events are opened if they exist, auto reset
+    std::wstring wsEvent = wsMapping + L"_connect";
+    _hConnectEvent.Attach(CreateEventEx(nullptr, wsEvent.c_str(), 0, EVENT_ALL_ACCESS));
+    NULL_CHK_HR(_hConnectEvent.Get(), HRESULT_FROM_WIN32(GetLastError()));
+
+    wsEvent = wsMapping + L"_data" + to_wstring(writeIndex);
+    _hWriteDataEvent.Attach(CreateEventEx(nullptr, wsEvent.c_str(), 0, EVENT_ALL_ACCESS));
+    NULL_CHK_HR(_hWriteDataEvent.Get(), HRESULT_FROM_WIN32(GetLastError()));
+
+    wsEvent = wsMapping + L"_space" + to_wstring(writeIndex);
+    _hWriteSpaceEvent.Attach(CreateEventEx(nullptr, wsEvent.c_str(), 0, EVENT_ALL_ACCESS));
+    NULL_CHK_HR(_hWriteSpaceEvent.Get(), HRESULT_FROM_WIN32(GetLastError()));
+
+    wsEvent = wsMapping + L"_data" + to_wstring(readIndex);
+    _hReadDataEvent.Attach(CreateEventEx(nullptr, wsEvent.c_str(), 0, EVENT_ALL_ACCESS));
+    NULL_CHK_HR(_hReadDataEvent.Get(), HRESULT_FROM_WIN32(GetLastError()));
+
+    wsEvent = wsMapping + L"_space" + to_wstring(readIndex);
+    _hReadSpaceEvent.Attach(CreateEventEx(nullptr, wsEvent.c_str(), 0, EVENT_ALL_ACCESS));
+    NULL_CHK_HR(_hReadSpaceEvent.Get(), HRESULT_FROM_WIN32(GetLastError()));
+
+    if (_isListener)
+    {
+        // a new generation first, so an old end that still has the region mapped sees its channel as closed
+        // and leaves the rings alone while they are reset
+        _generation = InterlockedIncrement(&_pHeader->generation);
+
+        InterlockedExchange(&_pHeader->magic, 0);
+        _pHeader->cbRingSize = c_cbSharedMemoryRingSize;
+        _pHeader->connected = 0;
+        _pHeader->closed = 0;
+        for (SpscRingPositions& positions : _pHeader->rings)
+        {
+            positions.writePos.store(0);
+            positions.readPos.store(0);
+        }
+
+        // a connector checks the magic, so it goes in last
+        MemoryBarrier();
+        InterlockedExchange(&_pHeader->magic, c_lSharedMemoryMagic);
+
+        _isAttached = true;
+
+        return S_OK;
+    }
+
+    if (c_lSharedMemoryMagic != _pHeader->magic
+        ||
+        c_cbSharedMemoryRingSize != _pHeader->cbRingSize
+        ||
+        0 != _pHeader->closed)
+    {
+        IFR(HRESULT_FROM_WIN32(ERROR_CONNECTION_REFUSED));
+    }
+
+    _generation = _pHeader->generation;
+
+    // only one connector per listener
+    if (0 != InterlockedCompareExchange(&_pHeader->connected, 1, 0))
+    {
+        IFR(HRESULT_FROM_WIN32(ERROR_CONNECTION_REFUSED));
+    }
+
+    _isAttached = true;
+
+    SetEvent(_hConnectEvent.Get());
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT SharedMemoryChannel::WaitForConnection()
+{
+    Log(Log_Level_Info, L"SharedMemoryChannel::WaitForConnection()\n");
+
+    while (0 == _pHeader->connected)
+    {
+        IFR(CheckClosed());
+
+        WaitForSingleObjectEx(_hConnectEvent.Get(), c_dwSharedMemoryWaitSlice, FALSE);
+    }
+
+    return CheckClosed();
+}
+
+_Use_decl_annotations_
+HRESULT SharedMemoryChannel::Write(
+    const BYTE* pData,
+    DWORD cbData)
+{
+    NULL_CHK(pData);
+
+    ULONGLONG lastProgress = GetTickCount64();
+
+    while (cbData > 0)
+    {
+        IFR(CheckClosed());
+
+        DWORD cbChunk = _writeRing.Write(pData, cbData);
+        if (0 == cbChunk)
+        {
+            if (GetTickCount64() - lastProgress > c_dwSharedMemoryWriteTimeout)
+            {
+                IFR(HRESULT_FROM_WIN32(ERROR_TIMEOUT));
+            }
+
+            WaitForSingleObjectEx(_hWriteSpaceEvent.Get(), c_dwSharedMemoryWaitSlice, FALSE);
+
+            continue;
+        }
+
+        SetEvent(_hWriteDataEvent.Get());
+
+        pData += cbChunk;
+        cbData -= cbChunk;
+        lastProgress = GetTickCount64();
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT SharedMemoryChannel::Read(
+    BYTE* pData,
+    DWORD cbData)
+{
+    NULL_CHK(pData);
+
+    while (cbData > 0)
+    {
+        DWORD cbChunk = _readRing.Read(pData, cbData);
+        if (0 == cbChunk)
+        {
+            IFR(CheckClosed());
+
+            WaitForSingleObjectEx(_hReadDataEvent.Get(), c_dwSharedMemoryWaitSlice, FALSE);
+
+            continue;
+        }
+
+        SetEvent(_hReadSpaceEvent.Get());
+
+        pData += cbChunk;
+        cbData -= cbChunk;
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void SharedMemoryChannel::Close()
+{
+    // after a new listener took over the region, its channel is not ours to close
+    if (!_isAttached
+        ||
+        _generation != _pHeader->generation
+        ||
+        0 != InterlockedExchange(&_pHeader->closed, 1))
+    {
+        return;
+    }
+
+    Log(Log_Level_Info, L"SharedMemoryChannel::Close()\n");
+
+    // wake up both ends
+    SetEvent(_hConnectEvent.Get());
+    SetEvent(_hWriteDataEvent.Get());
+    SetEvent(_hWriteSpaceEvent.Get());
+    SetEvent(_hReadDataEvent.Get());
+    SetEvent(_hReadSpaceEvent.Get());
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include "SpscRing.h"
+
+namespace MixedRemoteViewCompositor
+{
+    namespace Network
+    {
+        // bytes in each direction, must be a power of 2
+        const DWORD c_cbSharedMemoryRingSize = 4 * 1024 * 1024;
+        // how long a writer waits for the reader to make room before the channel is considered dead
+        const DWORD c_dwSharedMemoryWriteTimeout = 5000;
+        // waits are done in slices so a close from the other end is noticed
+        const DWORD c_dwSharedMemoryWaitSlice = 500;
+
+        // Connection between two processes on the same machine, through a named shared memory region.
+        // The region holds one SpscRing for each direction, carrying the same PayloadHeader framed messages
+        // as the socket; named events wake the other end when data or room is available.
+        // The listener end creates the region and the connector end opens it, only one connector is accepted.
+        class SharedMemoryChannel
+        {
+        public:
+            // listener end, fails if another listener is live on pszName; a region left mapped by the
+            // other end of a closed channel is reset and reused
+            static HRESULT Create(
+                _In_ LPCWSTR pszName,
+                _Out_ std::shared_ptr<SharedMemoryChannel>* pChannel);
+            // connector end, fails if nobody is listening on pszName
+            static HRESULT Open(
+                _In_ LPCWSTR pszName,
+                _Out_ std::shared_ptr<SharedMemoryChannel>* pChannel);
+            ~SharedMemoryChannel();
+
+            const std::wstring& GetName() const { return _name; }
+
+            // listener end, blocks until a connector opened the region or the channel was closed
+            HRESULT WaitForConnection();
+
+            // blocks until all of pData is in the ring, callers keep messages from interleaving
+            HRESULT Write(
+                _In_reads_bytes_(cbData) const BYTE* pData,
+                _In_ DWORD cbData);
+
+            // blocks until cbData bytes were read
+            HRESULT Read(
+                _Out_writes_bytes_all_(cbData) BYTE* pData,
+                _In_ DWORD cbData);
+
+            // closes both ends, wakes up anyone waiting
+            void Close();
+
+            inline HRESULT CheckClosed() const
+            {
+                return (!_isAttached || 0 != _pHeader->closed || _generation != _pHeader->generation) ? MF_E_SHUTDOWN : S_OK;
+            }
+
+        private:
+            struct RegionHeader
+            {
+                volatile LONG magic;
+                DWORD cbRingSize;
+                volatile LONG connected;
+                volatile LONG closed;
+                // counts the listeners that set up the region, each end keeps the one it attached to
+                volatile LONG generation;
+                // [0] is written by the listener, [1] by the connector
+                SpscRingPositions rings[2];
+            };
+
+            SharedMemoryChannel(bool isListener);
+
+            HRESULT Initialize(
+                _In_ LPCWSTR pszName);
+
+            Wrappers::HandleT<Wrappers::HandleTraits::HANDLENullTraits> _hMapping;
+            RegionHeader* _pHeader;
+            LONG _generation;
+
+            SpscRing _writeRing;
+            SpscRing _readRing;
+
+            Wrappers::Event _hConnectEvent;
+            Wrappers::Event _hWriteDataEvent;
+            Wrappers::Event _hWriteSpaceEvent;
+            Wrappers::Event _hReadDataEvent;
+            Wrappers::Event _hReadSpaceEvent;
+
+            bool _isListener;
+            // a connector that was refused must not close the listener's channel
+            bool _isAttached;
+            std::wstring _name;
+        };
+    }
+}
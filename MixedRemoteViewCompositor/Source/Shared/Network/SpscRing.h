@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace MixedRemoteViewCompositor
+{
+    namespace Network
+    {
+        // Positions of a ring, each only ever advanced by its owner and on its own cache line.
+        // They count bytes since the ring was created and are only masked down to an offset when indexing,
+        // so a full ring and an empty one can be told apart.
+        struct SpscRingPositions
+        {
+            std::atomic<int64_t> writePos;
+            uint8_t padWrite[56];
+            std::atomic<int64_t> readPos;
+            uint8_t padRead[56];
+        };
+
+        // positions may be shared between processes, that only works without a lock behind them
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64 bit atomics have to be lock free");
+
+        // Single producer/single consumer byte ring over memory owned by somebody else, e.g. a shared memory region.
+        // Write and Read never block, they move as many bytes as fit and the caller decides how to wait.
+        // Kept free of Windows types so the indexing and wrap logic can be tested on its own.
+        class SpscRing
+        {
+        public:
+            SpscRing()
+                : _pPositions(nullptr)
+                , _pData(nullptr)
+                , _cbSize(0)
+            {
+            }
+
+            // cbSize must be a power of 2
+            void Attach(
+                SpscRingPositions* pPositions,
+                uint8_t* pData,
+                uint32_t cbSize)
+            {
+                _pPositions = pPositions;
+                _pData = pData;
+                _cbSize = cbSize;
+            }
+
+            // producer end, returns the number of bytes copied in, 0 if the ring is full
+            uint32_t Write(
+                const uint8_t* pData,
+                uint32_t cbData)
+            {
+                // only this end moves writePos
+                int64_t writePos = _pPositions->writePos.load(std::memory_order_relaxed);
+                int64_t readPos = _pPositions->readPos.load(std::memory_order_acquire);
+
+                uint32_t cbFree = _cbSize - static_cast<uint32_t>(writePos - readPos);
+                uint32_t cbChunk = cbFree < cbData ? cbFree : cbData;
+                if (0 == cbChunk)
+                {
+                    return 0;
+                }
+
+                uint32_t offset = static_cast<uint32_t>(writePos) & (_cbSize - 1);
+                uint32_t cbFirst = (_cbSize - offset) < cbChunk ? (_cbSize - offset) : cbChunk;
+
+                memcpy(_pData + offset, pData, cbFirst);
+                memcpy(_pData, pData + cbFirst, cbChunk - cbFirst);
+
+                // the data has to be visible before the position
+                _pPositions->writePos.store(writePos + cbChunk, std::memory_order_release);
+
+                return cbChunk;
+            }
+
+            // consumer end, returns the number of bytes copied out, 0 if the ring is empty
+            uint32_t Read(
+                uint8_t* pData,
+                uint32_t cbData)
+            {
+                // only this end moves readPos
+                int64_t readPos = _pPositions->readPos.load(std::memory_order_relaxed);
+                int64_t writePos = _pPositions->writePos.load(std::memory_order_acquire);
+
+                uint32_t cbAvailable = static_cast<uint32_t>(writePos - readPos);
+                uint32_t cbChunk = cbAvailable < cbData ? cbAvailable : cbData;
+                if (0 == cbChunk)
+                {
+                    return 0;
+                }
+
+                uint32_t offset = static_cast<uint32_t>(readPos) & (_cbSize - 1);
+                uint32_t cbFirst = (_cbSize - offset) < cbChunk ? (_cbSize - offset) : cbChunk;
+
+                memcpy(pData, _pData + offset, cbFirst);
+                memcpy(pData + cbFirst, _pData, cbChunk - cbFirst);
+
+                // done with the data before the writer can reuse it
+                _pPositions->readPos.store(readPos + cbChunk, std::memory_order_release);
+
+                return cbChunk;
+            }
+
+            // bytes written and not read yet
+            uint32_t GetUsed() const
+            {
+                return static_cast<uint32_t>(_pPositions->writePos.load(std::memory_order_acquire)
+                    - _pPositions->readPos.load(std::memory_order_acquire));
+            }
+
+        private:
+            SpscRingPositions* _pPositions;
+            uint8_t* _pData;
+            uint32_t _cbSize;
+        };
+    }
+}
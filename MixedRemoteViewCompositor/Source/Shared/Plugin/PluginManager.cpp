@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "PluginManager.h"
+#include "MediaDescriptionCache.h"
 #include "IUnityGraphicsD3D11.h"
 
 PluginManagerImpl::~PluginManagerImpl()
@@ -245,6 +246,16 @@ void PluginManagerImpl::SetTime(float t)
     _timeElasped = t;
 }
 
+// Playback of a sender this process has played before opens with its last media description
+// and asks it to start streaming in the same request.
+_Use_decl_annotations_
+void PluginManagerImpl::SetMediaDescriptionCacheEnabled(bool enabled)
+{
+    Log(Log_Level_Info, L"PluginManagerImpl::SetMediaDescriptionCacheEnabled()\n");
+
+    MediaDescriptionCache::SetEnabled(enabled);
+}
+
 _Use_decl_annotations_
 void PluginManagerImpl::OnPlugInEvent(PluginEventType event)
 {
@@ -303,13 +314,44 @@ HRESULT PluginManagerImpl::ListenerCreateAndStart(
 
     ComPtr<ListenerImpl> listener;
     IFR(MakeAndInitialize<ListenerImpl>(&listener, port));
-    
+
+    return ListenerStart(listener.Get(), listenerHandle, callback);
+}
+
+_Use_decl_annotations_
+HRESULT PluginManagerImpl::ListenerCreateAndStartSharedMemory(
+    LPCWSTR name,
+    ModuleHandle *listenerHandle,
+    PluginCallback callback)
+{
+    Log(Log_Level_Info, L"PluginManagerImpl::StartSharedMemoryListener()\n");
+
+    NULL_CHK(name);
+    NULL_CHK(listenerHandle);
+    NULL_CHK(callback);
+
+    ComPtr<ListenerImpl> listener;
+    IFR(MakeAndInitialize<ListenerImpl>(&listener, name));
+
+    return ListenerStart(listener.Get(), listenerHandle, callback);
+}
+
+_Use_decl_annotations_
+HRESULT PluginManagerImpl::ListenerStart(
+    ListenerImpl* listener,
+    ModuleHandle *listenerHandle,
+    PluginCallback callback)
+{
+    NULL_CHK(listener);
+
+    ComPtr<ListenerImpl> spListener(listener);
+
     ComPtr<IConnectionCreatedOperation> connectedOp;
-    IFR(listener->ListenAsync(&connectedOp));
+    IFR(spListener->ListenAsync(&connectedOp));
 
     ModuleHandle handle = MODULE_HANDLE_INVALID;
     ComPtr<IModule> module;
-    IFR(listener.As(&module));
+    IFR(spListener.As(&module));
     IFR(_moduleManager->AddModule(module.Get(), &handle));
 
     *listenerHandle = handle;
@@ -406,14 +448,34 @@ HRESULT PluginManagerImpl::ConnectorCreateAndStart(
     Microsoft::WRL::Wrappers::HString uriHostname;
     IFR(uri->get_Host(uriHostname.GetAddressOf()));
 
-    INT32 uriPort = 0;
-    IFR(uri->get_Port(&uriPort));
-
-    ComPtr<ABI::Windows::Networking::IHostName> hostName;
-    IFR(hostNameFactory->CreateHostName(uriHostname.Get(), &hostName));
+    Microsoft::WRL::Wrappers::HString uriScheme;
+    IFR(uri->get_SchemeName(uriScheme.GetAddressOf()));
 
     ComPtr<ConnectorImpl> connector;
-    IFR(MakeAndInitialize<ConnectorImpl>(&connector, hostName.Get(), uriPort));
+    if (0 == _wcsicmp(uriScheme.GetRawBuffer(nullptr), c_szSharedMemoryScheme))
+    {
+        // shm://<name>, the name of the listener's channel. It is taken from the string as written,
+        // the host of the Uri is lowercased and IDN encoded; SharedMemoryChannel takes care of the case.
+        size_t nameStart = wsUri.find(L"://");
+        std::wstring wsName = (std::wstring::npos != nameStart) ? wsUri.substr(nameStart + 3) : std::wstring();
+        wsName = wsName.substr(0, wsName.find_first_of(L"/?#:"));
+        if (wsName.empty())
+        {
+            IFR(E_INVALIDARG);
+        }
+
+        IFR(MakeAndInitialize<ConnectorImpl>(&connector, wsName.c_str()));
+    }
+    else
+    {
+        INT32 uriPort = 0;
+        IFR(uri->get_Port(&uriPort));
+
+        ComPtr<ABI::Windows::Networking::IHostName> hostName;
+        IFR(hostNameFactory->CreateHostName(uriHostname.Get(), &hostName));
+
+        IFR(MakeAndInitialize<ConnectorImpl>(&connector, hostName.Get(), uriPort));
+    }
 
     ComPtr<IConnectionCreatedOperation> connectedOp;
     IFR(connector->ConnectAsync(&connectedOp));
@@ -973,6 +1035,67 @@ HRESULT PluginManagerImpl::CaptureClose(
     return _moduleManager->ReleaseModule(handle);
 }
 
+// Network sink for an application that encodes its own H.264 (and AAC) samples, eg: the SpectatorView recording.
+// The remote end plays it with PlaybackCreate on its side of the connection, the same as a capture engine stream.
+_Use_decl_annotations_
+HRESULT PluginManagerImpl::NetworkSinkCreate(
+    ModuleHandle handle,
+    UINT32 width,
+    UINT32 height,
+    bool enableAudio,
+    IMFMediaSink** ppMediaSink)
+{
+    Log(Log_Level_Info, L"PluginManagerImpl::NetworkSinkCreate()\n");
+
+    NULL_CHK(ppMediaSink);
+    *ppMediaSink = nullptr;
+
+    auto lock = _lock.Lock();
+
+    // get connection
+    ComPtr<IConnection> spConnection;
+    IFR(GetConnection(handle, &spConnection));
+
+    // same stream description as the capture engine
+    ComPtr<IMediaEncodingProfileStatics> spEncodingProfileStatics;
+    IFR(Windows::Foundation::GetActivationFactory(
+        Wrappers::HStringReference(RuntimeClass_Windows_Media_MediaProperties_MediaEncodingProfile).Get(),
+        &spEncodingProfileStatics));
+
+    ComPtr<IMediaEncodingProfile> mediaEncodingProfile;
+    IFR(spEncodingProfileStatics->CreateMp4(
+        ABI::Windows::Media::MediaProperties::VideoEncodingQuality_HD720p,
+        &mediaEncodingProfile));
+
+    if (!enableAudio)
+    {
+        mediaEncodingProfile->put_Audio(nullptr);
+    }
+    mediaEncodingProfile->put_Container(nullptr);
+
+    ComPtr<IVideoEncodingProperties> spVideoEncodingProperties;
+    IFR(mediaEncodingProfile->get_Video(&spVideoEncodingProperties));
+    IFR(spVideoEncodingProperties->put_Width(width));
+    IFR(spVideoEncodingProperties->put_Height(height));
+
+    ComPtr<IAudioEncodingProperties> spAudioEncodingProperties;
+    IFR(mediaEncodingProfile->get_Audio(&spAudioEncodingProperties));
+
+    // the application sets the exact stream types on the sink before writing to it
+    ComPtr<NetworkMediaSinkImpl> networkSink;
+    IFR(Microsoft::WRL::Details::MakeAndInitialize<NetworkMediaSinkImpl>(
+        &networkSink,
+        spAudioEncodingProperties.Get(),
+        spVideoEncodingProperties.Get(),
+        spConnection.Get()));
+
+    ComPtr<IMFMediaSink> spMediaSink;
+    IFR(networkSink.As(&spMediaSink));
+
+    *ppMediaSink = spMediaSink.Detach();
+
+    return S_OK;
+}
 
 _Use_decl_annotations_
 HRESULT PluginManagerImpl::PlaybackCreate(
@@ -1241,6 +1364,44 @@ HRESULT PluginManagerImpl::PlaybackGetFrameData(
     return pPlayerImpl->GetFrameData(args);
 }
 
+_Use_decl_annotations_
+HRESULT PluginManagerImpl::PlaybackSetLowLatency(
+    ModuleHandle handle,
+    bool enabled)
+{
+    Log(Log_Level_Info, L"PluginManagerImpl::PlaybackSetLowLatency()\n");
+
+    auto lock = _lock.Lock();
+
+    // get playback
+    ComPtr<IPlaybackEngine> spPlaybackEngine;
+    IFR(GetPlaybackEngine(handle, &spPlaybackEngine));
+
+    PlaybackEngineImpl* pPlayerImpl = static_cast<PlaybackEngineImpl*>(spPlaybackEngine.Get());
+    NULL_CHK_HR(pPlayerImpl, E_POINTER);
+
+    return pPlayerImpl->SetLowLatency(enabled);
+}
+
+_Use_decl_annotations_
+HRESULT PluginManagerImpl::PlaybackGetStats(
+    ModuleHandle handle,
+    PlaybackStats* pStats)
+{
+    NULL_CHK(pStats);
+
+    auto lock = _lock.Lock();
+
+    // get playback
+    ComPtr<IPlaybackEngine> spPlaybackEngine;
+    IFR(GetPlaybackEngine(handle, &spPlaybackEngine));
+
+    PlaybackEngineImpl* pPlayerImpl = static_cast<PlaybackEngineImpl*>(spPlaybackEngine.Get());
+    NULL_CHK_HR(pPlayerImpl, E_POINTER);
+
+    return pPlayerImpl->GetStats(pStats);
+}
+
 
 _Use_decl_annotations_
 HRESULT PluginManagerImpl::PlaybackStart(
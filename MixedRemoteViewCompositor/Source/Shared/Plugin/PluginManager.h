@@ -43,6 +43,25 @@ namespace MixedRemoteViewCompositor
         extern "C" typedef void(UNITY_INTERFACE_API *SampleUpdated)(
             _In_ MediaSampleArgs *args);
 
+        // Times are in 100ns units, for the last frame returned by PlaybackGetFrameData.
+        extern "C" struct PlaybackStats
+        {
+            UINT64 timestamp;
+            // from the sample being handed to the decoder until it was decoded
+            INT64 decodeTime;
+            // from the sample's capture time until it was presented. Sender and receiver clocks are unrelated, so
+            // capture times are mapped to this clock with the smallest capture to receive delay seen: the latency
+            // is on top of the fastest a frame has made it over the network so far.
+            INT64 presentLatency;
+            // from the sample arriving over the network until it was presented
+            INT64 receiveLatency;
+            // samples that were waiting behind it when it was handed to the decoder
+            UINT32 queueDepth;
+            UINT32 framesPresented;
+            // decoded frames replaced by a newer one before they were presented
+            UINT32 framesDropped;
+        };
+
         typedef std::function<void(_In_ float deltaTime, _In_ float relativeTime)> UpdateAction;
         typedef std::function<void()> RenderAction;
 
@@ -77,6 +96,8 @@ namespace MixedRemoteViewCompositor
                 _In_ LPCWSTR path);
             STDMETHODIMP_(void) SetTime(
                 _In_ float t);
+            STDMETHODIMP_(void) SetMediaDescriptionCacheEnabled(
+                _In_ bool enabled);
             STDMETHODIMP_(void) OnPlugInEvent(
                 _In_ Plugin::PluginEventType eventType);
 
@@ -85,6 +106,11 @@ namespace MixedRemoteViewCompositor
                 _In_ UINT16 port, 
                 _Inout_ ModuleHandle* listenerHandle,
                 _In_ PluginCallback callback);
+            // same machine only, a connector reaches it with shm://<name>
+            STDMETHODIMP ListenerCreateAndStartSharedMemory(
+                _In_ LPCWSTR name,
+                _Inout_ ModuleHandle* listenerHandle,
+                _In_ PluginCallback callback);
             STDMETHODIMP ListenerStopAndClose(
                 _In_ ModuleHandle listenerHandle);
 
@@ -142,6 +168,13 @@ namespace MixedRemoteViewCompositor
                 _In_ ModuleHandle captureHandle, 
                 _In_ IUnknown* pUnkSpatial);
 
+            STDMETHODIMP NetworkSinkCreate(
+                _In_ ModuleHandle connectionHandle,
+                _In_ UINT32 width,
+                _In_ UINT32 height,
+                _In_ bool enableAudio,
+                _COM_Outptr_ IMFMediaSink** ppMediaSink);
+
             STDMETHODIMP PlaybackCreate(
                 _In_ ModuleHandle connectionHandle,
                 _In_ PluginCallback createdCallback);
@@ -175,10 +208,21 @@ namespace MixedRemoteViewCompositor
             STDMETHODIMP PlaybackGetFrameData(
                 _In_ ModuleHandle handle,
                 _Inout_ MediaSampleArgs* pSampleArgs);
+            STDMETHODIMP PlaybackSetLowLatency(
+                _In_ ModuleHandle handle,
+                _In_ bool enabled);
+            STDMETHODIMP PlaybackGetStats(
+                _In_ ModuleHandle handle,
+                _Out_ PlaybackStats* pStats);
 
         private:
             STDMETHODIMP_(void) Uninitialize();
 
+            STDMETHODIMP ListenerStart(
+                _In_ ListenerImpl* listener,
+                _Inout_ ModuleHandle* listenerHandle,
+                _In_ PluginCallback callback);
+
             STDMETHODIMP_(void) CompletePluginCallback(
                 _In_ PluginCallback callback, 
                 _In_ ModuleHandle handle,
@@ -82,6 +82,15 @@ MRVCDLL_(void) MrvcSetTime(_In_ float t)
     }
 }
 
+MRVCDLL_(void) MrvcSetMediaDescriptionCacheEnabled(_In_ bool enabled)
+{
+    auto instance = PluginManagerStaticsImpl::GetInstance();
+    if (nullptr != instance)
+    {
+        instance->SetMediaDescriptionCacheEnabled(enabled);
+    }
+}
+
 MRVCDLL MrvcListenerCreateAndStart(
     _In_ UINT16 port, 
     _Inout_ UINT32* listenerHandle,
@@ -95,6 +104,20 @@ MRVCDLL MrvcListenerCreateAndStart(
 
     return RPC_E_WRONG_THREAD;
 }
+
+MRVCDLL MrvcListenerCreateAndStartSharedMemory(
+    _In_ LPCWSTR name,
+    _Inout_ UINT32* listenerHandle,
+    _In_ PluginCallback callback)
+{
+    auto instance = PluginManagerStaticsImpl::GetInstance();
+    if (nullptr != instance)
+    {
+        return instance->ListenerCreateAndStartSharedMemory(name, listenerHandle, callback);
+    }
+
+    return RPC_E_WRONG_THREAD;
+}
 MRVCDLL MrvcListenerStopAndClose(
     _In_ UINT32 handle)
 {
@@ -310,6 +333,22 @@ MRVCDLL MrvcCaptureClose(
     return RPC_E_WRONG_THREAD;
 }
 
+MRVCDLL MrvcNetworkSinkCreate(
+    _In_ ModuleHandle connectionHandle,
+    _In_ UINT32 width,
+    _In_ UINT32 height,
+    _In_ bool enableAudio,
+    _COM_Outptr_ IMFMediaSink** ppMediaSink)
+{
+    auto instance = PluginManagerStaticsImpl::GetInstance();
+    if (nullptr != instance)
+    {
+        return instance->NetworkSinkCreate(connectionHandle, width, height, enableAudio, ppMediaSink);
+    }
+
+    return RPC_E_WRONG_THREAD;
+}
+
 MRVCDLL MrvcPlaybackCreate(
     _In_ ModuleHandle connectionHandle,
     _In_ PluginCallback callback)
@@ -388,6 +427,32 @@ MRVCDLL MrvcPlaybackGetFrameData(
     return RPC_E_WRONG_THREAD;
 }
 
+MRVCDLL MrvcPlaybackSetLowLatency(
+    _In_ ModuleHandle handle,
+    _In_ bool enabled)
+{
+    auto instance = PluginManagerStaticsImpl::GetInstance();
+    if (nullptr != instance)
+    {
+        return instance->PlaybackSetLowLatency(handle, enabled);
+    }
+
+    return RPC_E_WRONG_THREAD;
+}
+
+MRVCDLL MrvcPlaybackGetStats(
+    _In_ ModuleHandle handle,
+    _Out_ PlaybackStats* stats)
+{
+    auto instance = PluginManagerStaticsImpl::GetInstance();
+    if (nullptr != instance)
+    {
+        return instance->PlaybackGetStats(handle, stats);
+    }
+
+    return RPC_E_WRONG_THREAD;
+}
+
 MRVCDLL MrvcPlaybackStart(
     _In_ ModuleHandle handle) 
 {
@@ -84,6 +84,12 @@ EXTERN_GUID(MFSampleExtension_Spatial_CameraProjectionTransform, 0x47f9fcb5, 0x2
 #endif
 EXTERN_GUID(Spatial_CameraTransform, 0x49d793d7, 0x5378, 0x43dd, 0xb2, 0xb3, 0xfe, 0x17, 0x18, 0xaa, 0xcb, 0x1d);
 
+// playback stats, MFGetSystemTime when a network sample arrived and when it was handed to the decoder,
+// and how many samples were still queued behind it
+EXTERN_GUID(Mrvc_SampleReceiveTime, 0x9b5aba11, 0xee3f, 0x458e, 0xb8, 0x77, 0xd5, 0xae, 0x4f, 0x07, 0x91, 0x1c);
+EXTERN_GUID(Mrvc_SampleDeliveryTime, 0xf92f55b6, 0x7a98, 0x4613, 0x82, 0x45, 0x0f, 0x37, 0xe2, 0xf3, 0x7b, 0x05);
+EXTERN_GUID(Mrvc_SampleQueueDepth, 0x4af2fc3d, 0x1382, 0x40cf, 0xbb, 0x87, 0x33, 0xe8, 0x88, 0x57, 0xdb, 0x1c);
+
 template <typename T>
 inline T GetDataType(_In_ ABI::Windows::Storage::Streams::IBuffer* pBuffer)
 {
@@ -148,9 +154,11 @@ using namespace ABI::MixedRemoteViewCompositor::Media;
 #include "DirectXManager.h"
 #include "PluginManager.h"
 #include "PluginManagerStatics.h"
+#include "DataBufferPool.h"
 #include "DataBuffer.h"
 #include "DataBundle.h"
 #include "DataBundleArgs.h"
+#include "SharedMemoryChannel.h"
 #include "Connection.h"
 #include "Listener.h"
 #include "Connector.h"
@@ -0,0 +1,263 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+// Synthetic loopback of the playback path: a 30 fps capture with a key frame every GOP, a network that stalls
+// and then delivers a burst, and a decoder that falls behind for a while. The stream's sample queue is run with
+// the default policy (NetworkMediaSourceStreamImpl::CleanSampleQueue) and the low latency policy
+// (GetLowLatencySkipCount) with and without the depth cap, and the newest decoded frame is presented every vsync.
+// Latency is measured from each frame's capture time to when it was presented.
+
+#include "LowLatencyQueue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+using namespace MixedRemoteViewCompositor::Media;
+
+namespace
+{
+    const int c_frameIntervalMs = 33;
+    const int c_gopFrames = 30;
+    const int c_vsyncIntervalMs = 16;
+    const int c_networkDelayMs = 20;
+    const int c_stallStartMs = 3000;
+    const int c_stallEndMs = 4000;
+    const int c_decodeMs = 12;
+    const int c_slowDecodeMs = 60;
+    const int c_slowDecodeStartMs = 6000;
+    const int c_slowDecodeEndMs = 10000;
+    const int c_runMs = 14000;
+
+    enum QueuePolicy
+    {
+        Policy_Default,
+        Policy_LowLatencyUncapped,
+        Policy_LowLatencyCapped
+    };
+
+    struct Frame
+    {
+        int index;
+        int captureMs;
+        bool keyFrame;
+    };
+
+    struct Result
+    {
+        const char* name;
+        size_t presented;
+        size_t corrupt;
+        size_t maxQueueDepth;
+        double meanMs;
+        int p95Ms;
+        int maxMs;
+        // worst case while the decoder is behind, the network stall dominates maxMs whatever the policy
+        int maxSlowDecodeMs;
+    };
+
+    int ArrivalMs(int captureMs)
+    {
+        int arrivalMs = captureMs + c_networkDelayMs;
+        return (captureMs >= c_stallStartMs && captureMs < c_stallEndMs) ? std::max(arrivalMs, c_stallEndMs) : arrivalMs;
+    }
+
+    int DecodeMs(int nowMs)
+    {
+        return (nowMs >= c_slowDecodeStartMs && nowMs < c_slowDecodeEndMs) ? c_slowDecodeMs : c_decodeMs;
+    }
+
+    Result Run(const char* name, QueuePolicy policy)
+    {
+        std::deque<Frame> samples;
+        bool skipToCleanPoint = false;
+
+        bool decoderBusy = false;
+        int decodeDoneMs = 0;
+        Frame decoding = {};
+        int lastDecodedIndex = -1;
+        bool referencesBroken = true;
+
+        bool hasDecoded = false;
+        Frame newestDecoded = {};
+        bool newestDecodedCorrupt = false;
+        int lastPresentedIndex = -1;
+
+        std::vector<int> latencies;
+        Result result = { name, 0, 0, 0, 0.0, 0, 0, 0 };
+
+        int nextCapture = 0;
+        for (int nowMs = 0; nowMs < c_runMs; ++nowMs)
+        {
+            bool deliver = false;
+
+            if (decoderBusy && nowMs >= decodeDoneMs)
+            {
+                // a frame decoded against a missing reference shows corruption until the next key frame
+                referencesBroken = !decoding.keyFrame && (referencesBroken || decoding.index != lastDecodedIndex + 1);
+                lastDecodedIndex = decoding.index;
+                newestDecoded = decoding;
+                newestDecodedCorrupt = referencesBroken;
+                hasDecoded = true;
+                decoderBusy = false;
+                deliver = true;
+            }
+
+            while (ArrivalMs(nextCapture * c_frameIntervalMs) == nowMs)
+            {
+                Frame frame = { nextCapture, nextCapture * c_frameIntervalMs, nextCapture % c_gopFrames == 0 };
+                samples.push_back(frame);
+                ++nextCapture;
+                deliver = true;
+            }
+
+            // NetworkMediaSourceStreamImpl::DeliverSamples: the decoder keeps one sample request outstanding
+            if (deliver)
+            {
+                result.maxQueueDepth = std::max(result.maxQueueDepth, samples.size());
+
+                while (!decoderBusy && !samples.empty())
+                {
+                    Frame frame = samples.front();
+                    samples.pop_front();
+                    if (skipToCleanPoint)
+                    {
+                        skipToCleanPoint = !frame.keyFrame;
+                        if (skipToCleanPoint)
+                        {
+                            continue;
+                        }
+                    }
+
+                    decoding = frame;
+                    decoderBusy = true;
+                    decodeDoneMs = nowMs + DecodeMs(nowMs);
+                }
+
+                if (!samples.empty() && policy == Policy_Default)
+                {
+                    // keep the oldest key frame only
+                    auto keyFrame = std::find_if(samples.begin(), samples.end(), [](const Frame& f) { return f.keyFrame; });
+                    std::deque<Frame> kept;
+                    if (keyFrame != samples.end())
+                    {
+                        kept.push_back(*keyFrame);
+                    }
+                    samples.swap(kept);
+                }
+                else if (!samples.empty())
+                {
+                    std::vector<QueuedEntryType> entries;
+                    for (const Frame& frame : samples)
+                    {
+                        entries.push_back(frame.keyFrame ? QueuedEntry_CleanPoint : QueuedEntry_Sample);
+                    }
+
+                    bool waitForCleanPoint = false;
+                    size_t maxDepth = policy == Policy_LowLatencyCapped ? c_cMaxLowLatencyQueueDepth : SIZE_MAX;
+                    size_t toDrop = GetLowLatencySkipCount(entries, maxDepth, &waitForCleanPoint);
+                    samples.erase(samples.begin(), samples.begin() + toDrop);
+                    skipToCleanPoint = skipToCleanPoint || waitForCleanPoint;
+                }
+            }
+
+            if (nowMs % c_vsyncIntervalMs == 0 && hasDecoded && newestDecoded.index != lastPresentedIndex)
+            {
+                lastPresentedIndex = newestDecoded.index;
+                latencies.push_back(nowMs - newestDecoded.captureMs);
+                if (nowMs >= c_slowDecodeStartMs && nowMs < c_slowDecodeEndMs)
+                {
+                    result.maxSlowDecodeMs = std::max(result.maxSlowDecodeMs, latencies.back());
+                }
+                if (newestDecodedCorrupt)
+                {
+                    ++result.corrupt;
+                }
+            }
+        }
+
+        result.presented = latencies.size();
+        if (!latencies.empty())
+        {
+            int64_t total = 0;
+            for (int latency : latencies)
+            {
+                total += latency;
+            }
+            result.meanMs = static_cast<double>(total) / latencies.size();
+
+            std::sort(latencies.begin(), latencies.end());
+            result.p95Ms = latencies[latencies.size() * 95 / 100];
+            result.maxMs = latencies.back();
+        }
+
+        return result;
+    }
+
+    int s_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            ++s_failures;
+        }
+    }
+
+    size_t SkipCount(const std::vector<QueuedEntryType>& entries, size_t maxDepth, bool* pWaitForCleanPoint)
+    {
+        return GetLowLatencySkipCount(entries, maxDepth, pWaitForCleanPoint);
+    }
+
+    void CheckSkipCount()
+    {
+        const QueuedEntryType S = QueuedEntry_Sample;
+        const QueuedEntryType K = QueuedEntry_CleanPoint;
+        const QueuedEntryType O = QueuedEntry_Other;
+        bool wait = true;
+
+        Check(SkipCount({ S, S, K, S }, 8, &wait) == 2 && !wait, "skips to the newest key frame");
+        Check(SkipCount({ K, S, K, S, S }, 8, &wait) == 2 && !wait, "skips to the last of several key frames");
+        Check(SkipCount({ S, S, S }, 8, &wait) == 0 && !wait, "keeps samples without a key frame under the cap");
+        Check(SkipCount({ S, S, O, K, S }, 8, &wait) == 0 && !wait, "does not look past a format change");
+        Check(SkipCount({ S, S, S, S }, 3, &wait) == 4 && wait, "drops everything over the cap without a key frame");
+        Check(SkipCount({ S, K, S, S, S, S }, 3, &wait) == 6 && wait, "drops everything when the key frame is too old");
+        Check(SkipCount({ S, S, K, S, S }, 3, &wait) == 2 && !wait, "skipping to the key frame gets under the cap");
+        Check(SkipCount({}, 3, &wait) == 0 && !wait, "empty queue");
+    }
+}
+
+int main()
+{
+    CheckSkipCount();
+
+    Result results[] =
+    {
+        Run("default", Policy_Default),
+        Run("low latency, uncapped", Policy_LowLatencyUncapped),
+        Run("low latency", Policy_LowLatencyCapped),
+    };
+
+    printf("%-24s %10s %8s %10s %10s %8s %8s %10s\n",
+        "policy", "presented", "corrupt", "max queue", "mean ms", "p95 ms", "max ms", "slow max");
+    for (const Result& result : results)
+    {
+        printf("%-24s %10zu %8zu %10zu %10.1f %8d %8d %10d\n", result.name, result.presented, result.corrupt,
+            result.maxQueueDepth, result.meanMs, result.p95Ms, result.maxMs, result.maxSlowDecodeMs);
+    }
+
+    const Result& uncapped = results[1];
+    const Result& capped = results[2];
+    Check(uncapped.corrupt == 0 && capped.corrupt == 0, "low latency never decodes against a missing reference");
+    Check(capped.maxSlowDecodeMs < uncapped.maxSlowDecodeMs, "the depth cap lowers the worst case latency");
+    Check(capped.p95Ms < uncapped.p95Ms, "the depth cap lowers the p95 latency");
+    // while the decoder is behind, a frame waits for at most a cap's worth of samples and the one being decoded
+    int boundMs = c_networkDelayMs + static_cast<int>(c_cMaxLowLatencyQueueDepth + 1) * c_slowDecodeMs
+        + c_slowDecodeMs + c_vsyncIntervalMs;
+    Check(capped.maxSlowDecodeMs <= boundMs, "low latency stays within its bound while the decoder is behind");
+
+    return s_failures == 0 ? 0 : 1;
+}
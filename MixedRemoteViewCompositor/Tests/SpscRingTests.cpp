@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+// Checks the indexing and wrap logic of the shared memory channel's ring: writes and reads that wrap around
+// the end of the ring, framed messages split across the end, a full ring, and a producer and consumer thread.
+
+#include "SpscRing.h"
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace MixedRemoteViewCompositor::Network;
+
+namespace
+{
+    int s_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            ++s_failures;
+        }
+    }
+
+    struct TestRing
+    {
+        TestRing(uint32_t cbSize, int64_t startPos)
+            : data(cbSize, 0)
+        {
+            positions.writePos.store(startPos);
+            positions.readPos.store(startPos);
+            ring.Attach(&positions, data.data(), cbSize);
+        }
+
+        SpscRingPositions positions;
+        std::vector<uint8_t> data;
+        SpscRing ring;
+    };
+
+    std::vector<uint8_t> Pattern(size_t cb, uint8_t seed)
+    {
+        std::vector<uint8_t> bytes(cb);
+        for (size_t i = 0; i < cb; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(seed + i * 7);
+        }
+        return bytes;
+    }
+
+    void CheckWraparound()
+    {
+        TestRing test(16, 0);
+        std::vector<uint8_t> first = Pattern(10, 1);
+        std::vector<uint8_t> second = Pattern(10, 2);
+        std::vector<uint8_t> out(10);
+
+        Check(test.ring.Write(first.data(), 10) == 10, "write into an empty ring");
+        Check(test.ring.GetUsed() == 10, "used after a write");
+        Check(test.ring.Read(out.data(), 10) == 10 && out == first, "read back");
+
+        // starts at offset 10, 6 bytes go at the end and 4 at the start
+        Check(test.ring.Write(second.data(), 10) == 10, "write that wraps around");
+        Check(test.data[15] == second[5] && test.data[0] == second[6], "wrapped bytes land at the start");
+        Check(test.ring.Read(out.data(), 10) == 10 && out == second, "read that wraps around");
+        Check(test.ring.GetUsed() == 0, "empty after reading everything");
+    }
+
+    void CheckFullAndEmpty()
+    {
+        TestRing test(16, 5);
+        std::vector<uint8_t> in = Pattern(20, 3);
+        std::vector<uint8_t> out(20);
+
+        Check(test.ring.Read(out.data(), 4) == 0, "nothing to read from an empty ring");
+        Check(test.ring.Write(in.data(), 20) == 16, "a write stops when the ring is full");
+        Check(test.ring.GetUsed() == 16, "a full ring is not mistaken for an empty one");
+        Check(test.ring.Write(in.data() + 16, 4) == 0, "nothing fits into a full ring");
+        Check(test.ring.Read(out.data(), 5) == 5, "partial read");
+        Check(test.ring.Write(in.data() + 16, 4) == 4, "room again after a read");
+        Check(test.ring.Read(out.data() + 5, 20) == 15, "a read stops when the ring is empty");
+        Check(out == in, "bytes come out in order");
+    }
+
+    // messages are a 4 byte length followed by the payload, like PayloadHeader framing
+    bool WriteMessage(SpscRing& ring, const std::vector<uint8_t>& payload)
+    {
+        uint32_t cbPayload = static_cast<uint32_t>(payload.size());
+        return ring.Write(reinterpret_cast<const uint8_t*>(&cbPayload), sizeof(cbPayload)) == sizeof(cbPayload)
+            && ring.Write(payload.data(), cbPayload) == cbPayload;
+    }
+
+    bool ReadMessage(SpscRing& ring, std::vector<uint8_t>* pPayload)
+    {
+        uint32_t cbPayload = 0;
+        if (ring.Read(reinterpret_cast<uint8_t*>(&cbPayload), sizeof(cbPayload)) != sizeof(cbPayload))
+        {
+            return false;
+        }
+        pPayload->resize(cbPayload);
+        return ring.Read(pPayload->data(), cbPayload) == cbPayload;
+    }
+
+    void CheckSplitMessages()
+    {
+        // positions right below 4 GB also cover the offset being taken from the low 32 bits
+        TestRing test(64, 0xFFFFFFF0LL);
+
+        size_t split = 0;
+        for (uint8_t n = 0; n < 200; ++n)
+        {
+            std::vector<uint8_t> payload = Pattern(1 + (n * 13) % 50, n);
+            int64_t start = test.positions.writePos.load();
+            Check(WriteMessage(test.ring, payload), "message fits");
+            if ((start & 63) + sizeof(uint32_t) + payload.size() > 64)
+            {
+                ++split;
+            }
+
+            std::vector<uint8_t> out;
+            Check(ReadMessage(test.ring, &out) && out == payload, "message split across the end reads back whole");
+        }
+
+        Check(split > 50, "messages were split across the end of the ring");
+        Check(test.positions.readPos.load() > 0x100000000LL, "positions went past 4 GB");
+    }
+
+    void CheckProducerConsumer()
+    {
+        TestRing test(64, 0);
+        const int c_cMessages = 20000;
+        bool ok = true;
+
+        // set by the consumer when it gives up on a mismatch, so the producer doesn't wait for room forever
+        std::atomic<bool> stop(false);
+
+        std::thread producer([&test, &stop]()
+        {
+            std::mt19937 random(1);
+            for (int n = 0; n < c_cMessages && !stop.load(); ++n)
+            {
+                std::vector<uint8_t> payload = Pattern(1 + random() % 100, static_cast<uint8_t>(n));
+                uint32_t cbPayload = static_cast<uint32_t>(payload.size());
+
+                std::vector<uint8_t> message(reinterpret_cast<uint8_t*>(&cbPayload), reinterpret_cast<uint8_t*>(&cbPayload) + sizeof(cbPayload));
+                message.insert(message.end(), payload.begin(), payload.end());
+
+                for (size_t cbWritten = 0; cbWritten < message.size() && !stop.load();)
+                {
+                    cbWritten += test.ring.Write(message.data() + cbWritten, static_cast<uint32_t>(message.size() - cbWritten));
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        auto readAll = [&test](uint8_t* pData, size_t cbData)
+        {
+            for (size_t cbRead = 0; cbRead < cbData;)
+            {
+                cbRead += test.ring.Read(pData + cbRead, static_cast<uint32_t>(cbData - cbRead));
+                std::this_thread::yield();
+            }
+        };
+
+        std::mt19937 random(1);
+        for (int n = 0; n < c_cMessages && ok; ++n)
+        {
+            std::vector<uint8_t> expected = Pattern(1 + random() % 100, static_cast<uint8_t>(n));
+
+            uint32_t cbPayload = 0;
+            readAll(reinterpret_cast<uint8_t*>(&cbPayload), sizeof(cbPayload));
+            ok = cbPayload == expected.size();
+            if (ok)
+            {
+                std::vector<uint8_t> payload(cbPayload);
+                readAll(payload.data(), cbPayload);
+                ok = payload == expected;
+            }
+        }
+
+        stop.store(true);
+        producer.join();
+
+        Check(ok, "messages from another thread arrive whole and in order");
+        Check(!ok || test.ring.GetUsed() == 0, "nothing left over");
+    }
+}
+
+int main()
+{
+    CheckWraparound();
+    CheckFullAndEmpty();
+    CheckSplitMessages();
+    CheckProducerConsumer();
+
+    return s_failures == 0 ? 0 : 1;
+}
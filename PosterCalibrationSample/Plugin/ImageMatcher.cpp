@@ -4,6 +4,10 @@
 
 const double ransac_thresh = 2.5f; // RANSAC inlier threshold
 const double nn_match_ratio = 0.8f; // Nearest-neighbour matching ratio
+const Size flow_win_size(21, 21); // Lucas-Kanade window
+const int flow_max_level = 3; // Lucas-Kanade pyramid levels above the frame
+const float flow_max_fb_error = 1.0f; // points that don't track back to within this many pixels are dropped
+const int min_roi_size = 64; // smaller detection regions are grown to the whole frame
 
 std::vector<Point2f> ImageMatcher::KeyPointsToPoints(std::vector<KeyPoint> keypoints)
 {
@@ -25,17 +29,172 @@ void ImageMatcher::SetObjectImage(const Mat objectImage, vector<Point2f> bb, str
 	m_detector->detectAndCompute(m_objectImage, noArray(), m_objectKeyPoints, m_objectDesc);
 	stats.keypoints = (int)m_objectKeyPoints.size();
 	m_objectBoundingBox = bb;
+	m_lastBoundingBox.clear();
+	ResetTracking();
 }
 
+void ImageMatcher::SetDetection(double detectionScale, bool useRoi, double roiMargin)
+{
+	m_detectionScale = (detectionScale > 0 && detectionScale < 1) ? detectionScale : 1.0;
+	m_useRoi = useRoi;
+	m_roiMargin = (std::max)(roiMargin, 0.0);
+}
+
+static double ElapsedMs(int64 start)
+{
+	return (getTickCount() - start) * 1000.0 / getTickFrequency();
+}
+
+void ImageMatcher::SetTracking(int redetectInterval, int minTrackedInliers)
+{
+	m_redetectInterval = redetectInterval;
+	m_minTrackedInliers = minTrackedInliers;
+	if (m_redetectInterval <= 0)
+		ResetTracking();
+}
+
+void ImageMatcher::ResetTracking()
+{
+	m_prevPyramid.clear();
+	m_trackedObjectPoints.clear();
+	m_trackedFramePoints.clear();
+	m_framesSinceDetection = 0;
+}
+
+bool ImageMatcher::TrackFrame(const Mat frame, const Mat gray, vector<Point2f>& foundObjectBoundingBox, Stats& stats)
+{
+	vector<Mat> pyramid;
+	buildOpticalFlowPyramid(gray, pyramid, flow_win_size, flow_max_level);
+
+	// forward, then back again to drop points that drifted
+	vector<Point2f> next, back;
+	vector<uchar> status, backStatus;
+	vector<float> err;
+	calcOpticalFlowPyrLK(m_prevPyramid, pyramid, m_trackedFramePoints, next, status, err, flow_win_size, flow_max_level);
+	calcOpticalFlowPyrLK(pyramid, m_prevPyramid, next, back, backStatus, err, flow_win_size, flow_max_level);
+
+	vector<Point2f> objectPoints, framePoints;
+	for (unsigned i = 0; i < next.size(); i++)
+	{
+		Point2f d = back[i] - m_trackedFramePoints[i];
+		if (status[i] && backStatus[i] && d.dot(d) <= flow_max_fb_error * flow_max_fb_error)
+		{
+			objectPoints.push_back(m_trackedObjectPoints[i]);
+			framePoints.push_back(next[i]);
+		}
+	}
+
+	if ((int)framePoints.size() < (std::max)(m_minTrackedInliers, 4))
+		return false;
+
+	Mat inlier_mask;
+	Mat homography = findHomography(objectPoints, framePoints, RANSAC, ransac_thresh, inlier_mask);
+	if (homography.empty())
+		return false;
+
+	m_trackedObjectPoints.clear();
+	m_trackedFramePoints.clear();
+	for (unsigned i = 0; i < framePoints.size(); i++)
+	{
+		if (inlier_mask.at<uchar>(i))
+		{
+			m_trackedObjectPoints.push_back(objectPoints[i]);
+			m_trackedFramePoints.push_back(framePoints[i]);
+		}
+	}
+	if ((int)m_trackedFramePoints.size() < (std::max)(m_minTrackedInliers, 4))
+		return false;
+
+	m_prevPyramid.swap(pyramid);
+	m_framesSinceDetection++;
+
+	stats.inliers = (int)m_trackedFramePoints.size();
+	stats.tracked = true;
+	vector<KeyPoint> inliers;
+	KeyPoint::convert(m_trackedFramePoints, inliers);
+	drawKeypoints(frame, inliers, frame, Scalar(0, 255, 0), DrawMatchesFlags::DRAW_OVER_OUTIMG | DrawMatchesFlags::NOT_DRAW_SINGLE_POINTS);
+
+	perspectiveTransform(m_objectBoundingBox, foundObjectBoundingBox, homography);
+	return true;
+}
 
 vector<Point2f> ImageMatcher::ProcessFrame(const Mat frame, Stats& stats)
+{
+	int64 start = getTickCount();
+
+	vector<Point2f> foundObjectBoundingBox = FindObject(frame, stats);
+	if (!foundObjectBoundingBox.empty() && stats.inliers >= (std::max)(m_minTrackedInliers, 4))
+		m_lastBoundingBox = foundObjectBoundingBox;
+	else
+		m_lastBoundingBox.clear();
+
+	stats.totalMs = ElapsedMs(start);
+	return foundObjectBoundingBox;
+}
+
+
+vector<Point2f> ImageMatcher::FindObject(const Mat frame, Stats& stats)
 {
 	vector<Point2f> foundObjectBoundingBox;
+
+	// the detector and the tracker both work on gray, so convert once
+	Mat gray;
+	if (frame.channels() == 4)
+		cvtColor(frame, gray, COLOR_BGRA2GRAY);
+	else if (frame.channels() == 3)
+		cvtColor(frame, gray, COLOR_BGR2GRAY);
+	else
+		gray = frame;
+
+	if (!m_trackedFramePoints.empty())
+	{
+		int64 trackStart = getTickCount();
+		bool tracked = m_framesSinceDetection < m_redetectInterval && m_prevPyramid[0].size() == gray.size()
+			&& TrackFrame(frame, gray, foundObjectBoundingBox, stats);
+		stats.matchMs = ElapsedMs(trackStart);
+		if (tracked)
+			return foundObjectBoundingBox;
+		ResetTracking();
+	}
+
+	int64 detectStart = getTickCount();
+
+	// most of the frame is not the object, so once found only look around where it was
+	Rect roi(0, 0, gray.cols, gray.rows);
+	if (m_useRoi && !m_lastBoundingBox.empty())
+	{
+		Rect box = boundingRect(m_lastBoundingBox);
+		int margin = cvRound((std::max)(box.width, box.height) * m_roiMargin);
+		box = Rect(box.x - margin, box.y - margin, box.width + 2 * margin, box.height + 2 * margin) & roi;
+		if (box.width >= min_roi_size && box.height >= min_roi_size)
+		{
+			roi = box;
+			stats.roi = true;
+		}
+	}
+
+	Mat detectImage = gray(roi);
+	if (m_detectionScale < 1.0)
+		resize(detectImage, detectImage, Size(), m_detectionScale, m_detectionScale, INTER_AREA);
+
 	vector<KeyPoint> kp;
 	Mat desc;
-	m_detector->detectAndCompute(frame, noArray(), kp, desc);
+	m_detector->detectAndCompute(detectImage, noArray(), kp, desc);
 	stats.keypoints = (int)kp.size();
 
+	if (m_detectionScale < 1.0 || stats.roi)
+	{
+		float toFrame = (float)(1.0 / m_detectionScale);
+		Point2f offset((float)roi.x, (float)roi.y);
+		for (KeyPoint& keyPoint : kp)
+		{
+			keyPoint.pt = keyPoint.pt * toFrame + offset;
+			keyPoint.size *= toFrame;
+		}
+	}
+	stats.detectMs = ElapsedMs(detectStart);
+	int64 matchStart = getTickCount();
+
 	drawKeypoints(frame, kp, frame, Scalar(255, 0, 255), DrawMatchesFlags::DRAW_OVER_OUTIMG);
 	
 
@@ -54,6 +213,7 @@ vector<Point2f> ImageMatcher::ProcessFrame(const Mat frame, Stats& stats)
 			matched2.push_back(kp[matches[i][0].trainIdx]);
 		}
 	}
+	stats.matches = (int)matched1.size();
 
 	Mat inlier_mask, homography;
 	vector<KeyPoint> inliers1, inliers2;
@@ -68,6 +228,7 @@ vector<Point2f> ImageMatcher::ProcessFrame(const Mat frame, Stats& stats)
 	{
 		stats.inliers = 0;
 		stats.ratio = 0;
+		stats.matchMs = ElapsedMs(matchStart);
 		return foundObjectBoundingBox;
 	}
 	for (unsigned i = 0; i < matched1.size(); i++)
@@ -81,8 +242,17 @@ vector<Point2f> ImageMatcher::ProcessFrame(const Mat frame, Stats& stats)
 		}
 	}
 	stats.inliers = (int)inliers1.size();
+	stats.matchMs = ElapsedMs(matchStart);
 	drawKeypoints(frame, inliers1, frame, Scalar(0, 255, 0), DrawMatchesFlags::DRAW_OVER_OUTIMG | DrawMatchesFlags::NOT_DRAW_SINGLE_POINTS);
 
+	if (m_redetectInterval > 0 && stats.inliers >= (std::max)(m_minTrackedInliers, 4))
+	{
+		m_trackedObjectPoints = KeyPointsToPoints(inliers1);
+		m_trackedFramePoints = KeyPointsToPoints(inliers2);
+		buildOpticalFlowPyramid(gray, m_prevPyramid, flow_win_size, flow_max_level);
+		m_framesSinceDetection = 0;
+	}
+
 	perspectiveTransform(m_objectBoundingBox, foundObjectBoundingBox, homography);	
 
 	return foundObjectBoundingBox;
@@ -5,6 +5,7 @@
 
 #include "opencv2/imgproc.hpp"
 #include "opencv2/calib3d.hpp"
+#include "opencv2/video/tracking.hpp"
 
 using namespace std;
 using namespace cv;
@@ -15,11 +16,21 @@ struct Stats
 	int inliers;
 	double ratio;
 	int keypoints;
+	bool tracked;	// inliers were tracked from the last frame instead of detected
+	bool roi;		// features were only detected around where the object was last found
+	double detectMs;	// detectAndCompute, including downscaling
+	double matchMs;		// matching and RANSAC, or optical flow when tracked
+	double totalMs;
 
 	Stats() : matches(0),
 		inliers(0),
 		ratio(0),
-		keypoints(0)
+		keypoints(0),
+		tracked(false),
+		roi(false),
+		detectMs(0),
+		matchMs(0),
+		totalMs(0)
 	{}
 };
 
@@ -34,6 +45,14 @@ public:
 	bool IsValid;
 	void SetObjectImage(const Mat objectImage, std::vector<Point2f> bb, std::string title, Stats& stats);
 	vector<Point2f> ProcessFrame(const Mat frame, Stats& stats);
+	// After a detection the inliers are tracked with optical flow, and the detector only runs again
+	// every redetectInterval frames or once fewer than minTrackedInliers points are left.
+	// A redetectInterval of 0 detects on every frame.
+	void SetTracking(int redetectInterval, int minTrackedInliers);
+	// Features are detected on the frame scaled by detectionScale (at most 1) and mapped back up.
+	// With useRoi, detection is limited to the bounding box the object was last found in, grown by
+	// roiMargin times its size on every side, and falls back to the whole frame once it is lost.
+	void SetDetection(double detectionScale, bool useRoi, double roiMargin);
 	Ptr<Feature2D> GetDetector() {
 		return m_detector;
 	}
@@ -41,10 +60,27 @@ protected:
 
 	vector<Point2f> KeyPointsToPoints(vector<KeyPoint> keypoints);
 	void DrawBoundingBox(Mat image, vector<Point2f> bb);
+	vector<Point2f> FindObject(const Mat frame, Stats& stats);
+	bool TrackFrame(const Mat frame, const Mat gray, vector<Point2f>& foundObjectBoundingBox, Stats& stats);
+	void ResetTracking();
 
 	Ptr<Feature2D> m_detector;
 	Ptr<DescriptorMatcher> m_matcher;
 	Mat m_objectImage, m_objectDesc;
 	std::vector<KeyPoint> m_objectKeyPoints;
 	std::vector<Point2f> m_objectBoundingBox;
+
+	double m_detectionScale = 1.0;
+	bool m_useRoi = false;
+	double m_roiMargin = 0.25;
+	// where the object was last found with at least m_minTrackedInliers inliers, empty if it wasn't
+	vector<Point2f> m_lastBoundingBox;
+
+	int m_redetectInterval = 0;
+	int m_minTrackedInliers = 0;
+	int m_framesSinceDetection = 0;
+	// last frame's pyramid and the inliers found in it, with where they are on the object image
+	vector<Mat> m_prevPyramid;
+	vector<Point2f> m_trackedObjectPoints;
+	vector<Point2f> m_trackedFramePoints;
 };
@@ -1,6 +1,9 @@
 ﻿// Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License. See LICENSE in the project root for license information.
 #include <windows.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "ImageMatcher.h"
 
 using namespace cv;
@@ -17,12 +20,50 @@ struct PosterMatchData
 	bool found;
 	int inliers;
 	InteropVector2 Corners[4];
+	// time spent in this call, for picking a detection scale
+	float DetectMilliseconds;
+	float MatchMilliseconds;
+	float TotalMilliseconds;
+	int Tracked;
+	// PosterDetector_SubmitFrame's id for the frame, and the time from submitting it to the result
+	int FrameId;
+	float LatencyMilliseconds;
+};
+
+struct PendingFrame
+{
+	Mat image;
+	int id;
+	int minimumInliers;
+	int64 submitTicks;
+
+	PendingFrame() : id(0), minimumInliers(0), submitTicks(0) {}
 };
 
 
 static bool objectImageDirty = false;
 static Mat objectImage;
 static ImageMatcher* imageMatcher;
+// frames the poster is tracked for between full detections, 0 detects on every frame
+static int trackingRedetectInterval = 10;
+static double detectionScale = 1.0;
+static bool detectionUseRoi = true;
+static double detectionRoiMargin = 0.25;
+static std::mutex matcherLock;
+
+// PosterDetector_SubmitFrame hands frames to asyncWorker through asyncPending, both under asyncLock.
+// The worker is a pointer so that it is never destroyed while still running at unload.
+static std::mutex asyncLock;
+static std::condition_variable asyncWake;
+static std::thread* asyncWorker;
+// a worker runs until this moves past the value it was started with
+static int asyncGeneration = 0;
+static bool asyncHasPending = false;
+static PendingFrame asyncPending;
+static vector<Mat> asyncFreeImages;
+static int asyncLastFrameId = 0;
+static PosterMatchData asyncResult = {};
+static bool asyncHasNewResult = false;
 
 static void DrawBoundingBox(Mat image, vector<Point2f> bb)
 {
@@ -36,25 +77,49 @@ static void DrawBoundingBox(Mat image, vector<Point2f> bb)
 
 extern "C" __declspec(dllexport) bool PosterDetector_SetPosterObjectData(BYTE *  pixels, int width, int height)
 {
-	objectImage = Mat(height, width, CV_8UC4, pixels);
+	std::lock_guard<std::mutex> lock(matcherLock);
+
+	// copied now, the worker thread may only get to it after pixels are gone
+	objectImage = Mat(height, width, CV_8UC4, pixels).clone();
 
 	objectImageDirty = true;
 	return objectImage.rows > 0;
 }
 
 
-extern "C" __declspec(dllexport) int PosterDetector_GetPosterMatchData(BYTE *  pixels, int width, int height, bool flipImage, int minimumInliers, PosterMatchData *posterMatchData)
+extern "C" __declspec(dllexport) void PosterDetector_SetTracking(int redetectInterval)
 {
+	// read by MatchFrame, which may be running on the worker thread
+	std::lock_guard<std::mutex> lock(matcherLock);
+
+	trackingRedetectInterval = redetectInterval;
+}
+
+
+// detectionScale of 0.5 detects on a quarter of the pixels; roiMargin is a fraction of the last found poster's size
+extern "C" __declspec(dllexport) void PosterDetector_SetDetection(float scale, bool useRoi, float roiMargin)
+{
+	std::lock_guard<std::mutex> lock(matcherLock);
+
+	detectionScale = scale;
+	detectionUseRoi = useRoi;
+	detectionRoiMargin = roiMargin;
+}
+
+
+// Runs the matcher on one frame. The object image and the matcher are shared by the synchronous
+// and the asynchronous API, so only one frame is matched at a time.
+static int MatchFrame(Mat mainImg, int minimumInliers, bool drawResult, PosterMatchData *posterMatchData)
+{
+	std::lock_guard<std::mutex> lock(matcherLock);
+
 	if (objectImage.cols == 0)
 	{
+		posterMatchData->found = false;
+		posterMatchData->inliers = 0;
 		return 0;
 	}
 
-	Mat mainImg = Mat(height, width, CV_8UC4, pixels);
-
-	if (flipImage)
-		flip(mainImg, mainImg, 0);
-
 	Stats stats;
 
 	if (imageMatcher == nullptr || !imageMatcher->IsValid)
@@ -77,12 +142,19 @@ extern "C" __declspec(dllexport) int PosterDetector_GetPosterMatchData(BYTE *  p
 
 		imageMatcher->SetObjectImage(objectImage, bb, "", stats);
 	}
+	// tracked points are dropped for a full detection before there are too few to report the poster found
+	imageMatcher->SetTracking(trackingRedetectInterval, minimumInliers);
+	imageMatcher->SetDetection(detectionScale, detectionUseRoi, detectionRoiMargin);
 
 	vector<Point2f> result = imageMatcher->ProcessFrame(mainImg, stats);
 	posterMatchData->inliers = stats.inliers;
+	posterMatchData->DetectMilliseconds = (float)stats.detectMs;
+	posterMatchData->MatchMilliseconds = (float)stats.matchMs;
+	posterMatchData->TotalMilliseconds = (float)stats.totalMs;
+	posterMatchData->Tracked = stats.tracked ? 1 : 0;
 	if (stats.inliers >= minimumInliers)
 	{
-		if (stats.inliers >= minimumInliers)
+		if (drawResult)
 		{
 			DrawBoundingBox(mainImg, result);
 		}
@@ -104,3 +176,129 @@ extern "C" __declspec(dllexport) int PosterDetector_GetPosterMatchData(BYTE *  p
 }
 
 
+extern "C" __declspec(dllexport) int PosterDetector_GetPosterMatchData(BYTE *  pixels, int width, int height, bool flipImage, int minimumInliers, PosterMatchData *posterMatchData)
+{
+	Mat mainImg = Mat(height, width, CV_8UC4, pixels);
+
+	if (flipImage)
+		flip(mainImg, mainImg, 0);
+
+	int64 start = getTickCount();
+	int inliers = MatchFrame(mainImg, minimumInliers, true, posterMatchData);
+	posterMatchData->FrameId = 0;
+	posterMatchData->LatencyMilliseconds = (float)((getTickCount() - start) * 1000.0 / getTickFrequency());
+	return inliers;
+}
+
+
+static void AsyncWorker(int generation)
+{
+	std::unique_lock<std::mutex> lock(asyncLock);
+	while (true)
+	{
+		asyncWake.wait(lock, [generation] { return asyncGeneration != generation || asyncHasPending; });
+		if (asyncGeneration != generation)
+			break;
+
+		// only the newest frame is ever waiting, older ones were replaced when it was submitted
+		PendingFrame frame = asyncPending;
+		asyncPending = PendingFrame();
+		asyncHasPending = false;
+		lock.unlock();
+
+		PosterMatchData data = {};
+		MatchFrame(frame.image, frame.minimumInliers, false, &data);
+		data.FrameId = frame.id;
+		data.LatencyMilliseconds = (float)((getTickCount() - frame.submitTicks) * 1000.0 / getTickFrequency());
+
+		lock.lock();
+		asyncResult = data;
+		asyncHasNewResult = true;
+		asyncFreeImages.push_back(frame.image);
+	}
+}
+
+
+// Queues a frame for the worker thread and returns its id without waiting for it. The frame is copied,
+// flipped on the way if asked, so pixels can be reused right away; a frame that is still waiting is
+// replaced. latestMatchData gets the newest completed result, with the id of the frame it is for.
+extern "C" __declspec(dllexport) int PosterDetector_SubmitFrame(BYTE *  pixels, int width, int height, bool flipImage, int minimumInliers, PosterMatchData *latestMatchData)
+{
+	Mat image;
+	{
+		std::lock_guard<std::mutex> lock(asyncLock);
+		if (!asyncFreeImages.empty())
+		{
+			image = asyncFreeImages.back();
+			asyncFreeImages.pop_back();
+		}
+	}
+
+	Mat source = Mat(height, width, CV_8UC4, pixels);
+	if (flipImage)
+		flip(source, image, 0);
+	else
+		source.copyTo(image);
+
+	std::lock_guard<std::mutex> lock(asyncLock);
+
+	if (asyncWorker == nullptr)
+	{
+		asyncWorker = new std::thread(AsyncWorker, asyncGeneration);
+	}
+
+	if (asyncHasPending)
+		asyncFreeImages.push_back(asyncPending.image);
+	asyncPending.image = image;
+	asyncPending.id = ++asyncLastFrameId;
+	asyncPending.minimumInliers = minimumInliers;
+	asyncPending.submitTicks = getTickCount();
+	asyncHasPending = true;
+	// a stopped worker may still be waiting to see its generation go by
+	asyncWake.notify_all();
+
+	if (latestMatchData != nullptr)
+	{
+		*latestMatchData = asyncResult;
+		asyncHasNewResult = false;
+	}
+	return asyncPending.id;
+}
+
+
+// Copies the newest completed result, returns false if there was none since the last call or submit.
+extern "C" __declspec(dllexport) bool PosterDetector_PollPosterMatchData(PosterMatchData *latestMatchData)
+{
+	std::lock_guard<std::mutex> lock(asyncLock);
+
+	*latestMatchData = asyncResult;
+	bool isNew = asyncHasNewResult;
+	asyncHasNewResult = false;
+	return isNew;
+}
+
+
+// Stops the worker thread after the frame it is on, frames still waiting are dropped.
+extern "C" __declspec(dllexport) void PosterDetector_StopAsync()
+{
+	std::thread* worker;
+	{
+		std::lock_guard<std::mutex> lock(asyncLock);
+		worker = asyncWorker;
+		asyncWorker = nullptr;
+		asyncGeneration++;
+		if (asyncHasPending)
+			asyncFreeImages.push_back(asyncPending.image);
+		asyncHasPending = false;
+		asyncPending = PendingFrame();
+		asyncWake.notify_all();
+	}
+
+	if (worker != nullptr)
+	{
+		worker->join();
+		delete worker;
+	}
+}
+
+
@@ -29,6 +29,12 @@ namespace PosterAlignment
             public int Inliers;
             [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
             public InteropVector2[] Corners;
+            public float DetectMilliseconds;
+            public float MatchMilliseconds;
+            public float TotalMilliseconds;
+            public int Tracked;
+            public int FrameId;
+            public float LatencyMilliseconds;
         }
 
         [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_GetPosterMatchData", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
@@ -38,6 +44,23 @@ namespace PosterAlignment
         [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_SetPosterObjectData", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
         private static extern bool PosterDetector_SetPosterObjectData(IntPtr pixels, uint width, uint height);
 
+        [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_SetTracking", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void PosterDetector_SetTracking(int redetectInterval);
+
+        [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_SetDetection", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void PosterDetector_SetDetection(float scale, [MarshalAs(UnmanagedType.I1)] bool useRoi, float roiMargin);
+
+        [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_SubmitFrame", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int PosterDetector_SubmitFrame(IntPtr pixels, uint width, uint height, [MarshalAs(UnmanagedType.I1)] bool flipImage, int minimumInliers,
+           [MarshalAs(UnmanagedType.Struct)] ref PosterMatchData latestMatchData);
+
+        [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_PollPosterMatchData", CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool PosterDetector_PollPosterMatchData([MarshalAs(UnmanagedType.Struct)] ref PosterMatchData latestMatchData);
+
+        [System.Runtime.InteropServices.DllImport("Plugin.dll", EntryPoint = "PosterDetector_StopAsync", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void PosterDetector_StopAsync();
+
 
         [DllImport("Plugin")]
         private static extern void SetAssetsPath([MarshalAs(UnmanagedType.LPStr)] string path);
@@ -48,6 +71,7 @@ namespace PosterAlignment
 
         private PosterMatchData posterMatchData = new PosterMatchData();
         private bool bDLLNotWorking = false;
+        private bool asyncStarted = false;
 
         public PosterDetectorAPI()
         {
@@ -55,6 +79,11 @@ namespace PosterAlignment
 
         public void Dispose()
         {
+            if (this.asyncStarted && !this.bDLLNotWorking)
+            {
+                this.asyncStarted = false;
+                PosterDetector_StopAsync();
+            }
         }
 
         ~PosterDetectorAPI()
@@ -81,6 +110,103 @@ namespace PosterAlignment
             }
         }
 
+        /// <summary>
+        /// After the poster was found it is tracked from frame to frame, with a full detection every
+        /// redetectInterval frames or when tracking loses too many points. 0 detects on every frame.
+        /// </summary>
+        public void SetTracking(int redetectInterval)
+        {
+            if (this.bDLLNotWorking)
+            {
+                return;
+            }
+            try
+            {
+                PosterDetector_SetTracking(redetectInterval);
+            }
+            catch (System.DllNotFoundException ex)
+            {
+                Debug.LogError("PosterDetectorAPI: Error loading DLL. " + ex.ToString());
+                this.bDLLNotWorking = true;
+            }
+        }
+
+        /// <summary>
+        /// Detects features on the frame scaled by scale (at most 1), and with useRoi only around where the
+        /// poster was last found, grown by roiMargin times its size. LastMatchData has the time it took.
+        /// </summary>
+        public void SetDetection(float scale, bool useRoi, float roiMargin = 0.25f)
+        {
+            if (this.bDLLNotWorking)
+            {
+                return;
+            }
+            try
+            {
+                PosterDetector_SetDetection(scale, useRoi, roiMargin);
+            }
+            catch (System.DllNotFoundException ex)
+            {
+                Debug.LogError("PosterDetectorAPI: Error loading DLL. " + ex.ToString());
+                this.bDLLNotWorking = true;
+            }
+        }
+
+        /// <summary>
+        /// Result of the last TryDetectPoster, including the native timings.
+        /// </summary>
+        public PosterMatchData LastMatchData
+        {
+            get { return posterMatchData; }
+        }
+
+        /// <summary>
+        /// Hands a frame to the plugin's worker thread without waiting for it to be searched; the pixels are
+        /// copied, so the buffer can be reused right away. Only the newest frame that is waiting gets searched.
+        /// Returns the frame's id, latestMatchData gets the newest completed result and the FrameId it is for.
+        /// </summary>
+        public int SubmitFrame(IntPtr pPixels, int width, int height, bool flipImage, out PosterMatchData latestMatchData)
+        {
+            latestMatchData = new PosterMatchData();
+            if (this.bDLLNotWorking)
+            {
+                return 0;
+            }
+            try
+            {
+                this.asyncStarted = true;
+                return PosterDetector_SubmitFrame(pPixels, (uint)width, (uint)height, flipImage, MinimumInliers, ref latestMatchData);
+            }
+            catch (System.DllNotFoundException ex)
+            {
+                Debug.LogError("PosterDetectorAPI: Error loading DLL. " + ex.ToString());
+                this.bDLLNotWorking = true;
+                return 0;
+            }
+        }
+
+        /// <summary>
+        /// Gets the newest completed result of SubmitFrame, returns false if it was already returned before.
+        /// </summary>
+        public bool PollFrame(out PosterMatchData latestMatchData)
+        {
+            latestMatchData = new PosterMatchData();
+            if (this.bDLLNotWorking)
+            {
+                return false;
+            }
+            try
+            {
+                return PosterDetector_PollPosterMatchData(ref latestMatchData);
+            }
+            catch (System.DllNotFoundException ex)
+            {
+                Debug.LogError("PosterDetectorAPI: Error loading DLL. " + ex.ToString());
+                this.bDLLNotWorking = true;
+                return false;
+            }
+        }
+
         public bool TryDetectPoster(IntPtr pPixels, int width, int height, out Vector2[] positionList, bool normalize = false)
         {
             positionList = null;
@@ -94,7 +220,9 @@ namespace PosterAlignment
                 //run poster detection by invoking native code:
                 PosterDetector_GetPosterMatchData(pPixels, (uint)width, (uint)height, false, MinimumInliers, ref posterMatchData);
                 var elapsed = DateTime.Now.Subtract(start).TotalMilliseconds;
-                Debug.Log("TryDetectPoster (" + width + " - " + height + "): " + posterMatchData.PosterFound + " - " + elapsed.ToString("0.0") + "ms");
+                Debug.Log("TryDetectPoster (" + width + " - " + height + "): " + posterMatchData.PosterFound + " - " + elapsed.ToString("0.0") + "ms" +
+                    " (detect " + posterMatchData.DetectMilliseconds.ToString("0.0") + "ms, match " + posterMatchData.MatchMilliseconds.ToString("0.0") + "ms" +
+                    (posterMatchData.Tracked != 0 ? ", tracked)" : ")"));
                 if (!posterMatchData.PosterFound)
                 {
                     return false;
@@ -0,0 +1,253 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "AudioPipeline.h"
+
+#include <emmintrin.h>
+#include <math.h>
+
+AudioPipeline::AudioPipeline(UINT32 sampleRate, UINT32 channels) :
+    sampleRate(sampleRate),
+    channels(channels)
+{
+    ring.resize(AUDIO_RING_FRAMES * channels);
+    previousFrame.resize(channels);
+
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    Reset(0, freq.QuadPart);
+}
+
+void AudioPipeline::Reset(LONGLONG startTime, LONGLONG qpcFrequency)
+{
+    this->startTime = startTime;
+    this->qpcFrequency = qpcFrequency;
+
+    writtenFrames = 0;
+    committedFrames.store(0, std::memory_order_release);
+    readFrames.store(0, std::memory_order_release);
+    anchorTime = -1;
+
+    smoothedDrift = 0;
+    driftOffset = 0;
+    warmupSum = 0;
+    warmupCount = 0;
+    warmingUp = true;
+    correcting = false;
+    currentDrift.store(0, std::memory_order_relaxed);
+
+    resamplePhase = 0;
+    rateAdjustment = 0;
+    memset(previousFrame.data(), 0, channels * sizeof(short));
+}
+
+void AudioPipeline::ConvertFloatToPCM(const float* src, short* dst, UINT32 sampleCount)
+{
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 minValue = _mm_set1_ps(-1.0f);
+    const __m128 maxValue = _mm_set1_ps(1.0f);
+
+    UINT32 i = 0;
+    for (; i + 8 <= sampleCount; i += 8)
+    {
+        __m128 a = _mm_loadu_ps(src + i);
+        __m128 b = _mm_loadu_ps(src + i + 4);
+
+        // Clamp before scaling, out of range floats would otherwise convert to 0x80000000.
+        a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(a, minValue), maxValue), scale);
+        b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(b, minValue), maxValue), scale);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+
+    // Same rounding as the vector loop.
+    for (; i < sampleCount; i++)
+    {
+        __m128 a = _mm_set_ss(src[i]);
+        a = _mm_mul_ss(_mm_min_ss(_mm_max_ss(a, minValue), maxValue), scale);
+        dst[i] = (short)_mm_cvtss_si32(a);
+    }
+}
+
+void AudioPipeline::WritePCM(const short* samples, UINT32 sampleCount, LONGLONG timestamp)
+{
+    Write(samples, sampleCount / channels, timestamp);
+}
+
+void AudioPipeline::WriteFloat(const float* samples, UINT32 sampleCount, LONGLONG timestamp)
+{
+    if (convertedSamples.size() < sampleCount)
+    {
+        convertedSamples.resize(sampleCount);
+    }
+
+    ConvertFloatToPCM(samples, convertedSamples.data(), sampleCount);
+    Write(convertedSamples.data(), sampleCount / channels, timestamp);
+}
+
+void AudioPipeline::Write(const short* samples, UINT32 frameCount, LONGLONG timestamp)
+{
+    if (frameCount == 0 || timestamp < startTime)
+    {
+        return;
+    }
+
+    LONGLONG arrivalTime = ((timestamp - startTime) * QPC_MULTIPLIER) / qpcFrequency;
+    if (anchorTime < 0)
+    {
+        anchorTime = arrivalTime;
+    }
+
+    // How far the audio written so far lags behind the video clock, less the engine's constant buffering offset.
+    double error = (double)(arrivalTime - (anchorTime + FramesToHNS(writtenFrames)));
+    double offset = warmingUp ? (warmupCount > 0 ? warmupSum / warmupCount : 0) : driftOffset;
+
+    if (error - offset > AUDIO_GAP_HNS)
+    {
+        OutputDebugString(L"Filling gap in engine audio with silence.\n");
+        WriteSilence(HNSToFrames((LONGLONG)(error - offset)));
+    }
+    else if (error - offset < -AUDIO_GAP_HNS)
+    {
+        OutputDebugString(L"Engine audio is ahead of the video clock, dropping audio.\n");
+        return;
+    }
+    else
+    {
+        UpdateDrift(arrivalTime, error);
+    }
+
+    double step = 1.0 / (1.0 + rateAdjustment);
+    if (GetFreeFrames() < (UINT64)(frameCount / step) + 2)
+    {
+        OutputDebugString(L"Audio ring is full, dropping audio.\n");
+        return;
+    }
+
+    // Linear resampling, with the last frame of the previous callback at position -1.
+    // Without a rate adjustment this is a copy delayed by one frame.
+    double position = resamplePhase - 1.0;
+    const double lastPosition = (double)(frameCount - 1);
+    while (position < lastPosition)
+    {
+        int index = (int)floor(position);
+        float fraction = (float)(position - index);
+
+        const short* s0 = index < 0 ? previousFrame.data() : samples + index * channels;
+        const short* s1 = samples + (index + 1) * channels;
+        short* dst = &ring[(size_t)(writtenFrames & (AUDIO_RING_FRAMES - 1)) * channels];
+
+        for (UINT32 c = 0; c < channels; c++)
+        {
+            dst[c] = (short)lrintf(s0[c] + (s1[c] - s0[c]) * fraction);
+        }
+
+        writtenFrames++;
+        position += step;
+    }
+
+    resamplePhase = position - lastPosition;
+    memcpy(previousFrame.data(), samples + (frameCount - 1) * channels, channels * sizeof(short));
+
+    committedFrames.store(writtenFrames, std::memory_order_release);
+}
+
+void AudioPipeline::UpdateDrift(LONGLONG arrivalTime, double error)
+{
+    if (warmingUp)
+    {
+        warmupSum += error;
+        warmupCount++;
+
+        if (arrivalTime - anchorTime >= AUDIO_DRIFT_WARMUP_HNS)
+        {
+            warmingUp = false;
+            driftOffset = warmupSum / warmupCount;
+            smoothedDrift = driftOffset;
+        }
+        return;
+    }
+
+    smoothedDrift += (error - smoothedDrift) * AUDIO_DRIFT_SMOOTHING;
+    double drift = smoothedDrift - driftOffset;
+    currentDrift.store((LONGLONG)drift, std::memory_order_relaxed);
+
+    if (!correcting && fabs(drift) > AUDIO_DRIFT_DEADBAND_HNS)
+    {
+        correcting = true;
+    }
+    else if (correcting && fabs(drift) < AUDIO_DRIFT_DEADBAND_HNS / 2)
+    {
+        correcting = false;
+    }
+
+    if (correcting)
+    {
+        // Audio behind the video clock is stretched, audio ahead of it is compressed.
+        rateAdjustment = drift / AUDIO_DRIFT_CORRECTION_HNS;
+        if (rateAdjustment > AUDIO_MAX_RATE_ADJUSTMENT) { rateAdjustment = AUDIO_MAX_RATE_ADJUSTMENT; }
+        if (rateAdjustment < -AUDIO_MAX_RATE_ADJUSTMENT) { rateAdjustment = -AUDIO_MAX_RATE_ADJUSTMENT; }
+    }
+    else
+    {
+        // Snap back to whole input frames so uncorrected audio is not filtered by the interpolation.
+        rateAdjustment = 0;
+        resamplePhase = 0;
+    }
+}
+
+void AudioPipeline::WriteSilence(UINT64 frameCount)
+{
+    UINT64 freeFrames = GetFreeFrames();
+    if (frameCount > freeFrames)
+    {
+        frameCount = freeFrames;
+    }
+
+    for (UINT64 i = 0; i < frameCount; i++)
+    {
+        memset(&ring[(size_t)((writtenFrames + i) & (AUDIO_RING_FRAMES - 1)) * channels], 0, channels * sizeof(short));
+    }
+
+    writtenFrames += frameCount;
+    memset(previousFrame.data(), 0, channels * sizeof(short));
+    resamplePhase = 0;
+
+    committedFrames.store(writtenFrames, std::memory_order_release);
+}
+
+bool AudioPipeline::CanRead(UINT32 byteCount)
+{
+    UINT64 frameCount = byteCount / (channels * sizeof(short));
+    return committedFrames.load(std::memory_order_acquire) - readFrames.load(std::memory_order_relaxed) >= frameCount;
+}
+
+bool AudioPipeline::Read(BYTE* buffer, UINT32 byteCount, LONGLONG& sampleTime, LONGLONG& duration)
+{
+    UINT64 frameCount = byteCount / (channels * sizeof(short));
+    UINT64 read = readFrames.load(std::memory_order_relaxed);
+    if (committedFrames.load(std::memory_order_acquire) - read < frameCount)
+    {
+        return false;
+    }
+
+    // Copy out of the ring, which may wrap once.
+    UINT64 start = read & (AUDIO_RING_FRAMES - 1);
+    UINT64 firstFrames = AUDIO_RING_FRAMES - start;
+    if (firstFrames > frameCount)
+    {
+        firstFrames = frameCount;
+    }
+
+    size_t frameSize = channels * sizeof(short);
+    memcpy(buffer, &ring[(size_t)start * channels], (size_t)firstFrames * frameSize);
+    memcpy(buffer + firstFrames * frameSize, ring.data(), (size_t)(frameCount - firstFrames) * frameSize);
+
+    // Durations are differences of absolute times, so rounding does not accumulate.
+    sampleTime = anchorTime + FramesToHNS(read);
+    duration = FramesToHNS(read + frameCount) - FramesToHNS(read);
+
+    readFrames.store(read + frameCount, std::memory_order_release);
+    return true;
+}
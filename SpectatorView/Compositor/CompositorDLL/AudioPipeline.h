@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <vector>
+
+#include "CompositorShared.h"
+
+// Number of audio frames (one sample per channel) the ring can hold.  Must be a power of 2.
+// 65536 frames is a little over a second at 48kHz, far more than the engine delivers between encoder updates.
+#define AUDIO_RING_FRAMES 65536
+// Arrival jitter from the engine audio thread is averaged over roughly 1 / AUDIO_DRIFT_SMOOTHING callbacks.
+#define AUDIO_DRIFT_SMOOTHING 0.02
+// Time after the first audio callback used to measure the constant offset between engine audio and the video clock.
+#define AUDIO_DRIFT_WARMUP_HNS (2000 * MS2HNS)
+// Drift is corrected once it grows past this, and correction stops when it falls below half of it.
+#define AUDIO_DRIFT_DEADBAND_HNS (5 * MS2HNS)
+// Drift is corrected over this much audio, limited to AUDIO_MAX_RATE_ADJUSTMENT.
+#define AUDIO_DRIFT_CORRECTION_HNS (5000 * MS2HNS)
+// Largest change in playback rate used for correction.  0.1% is well below an audible change in pitch.
+#define AUDIO_MAX_RATE_ADJUSTMENT 0.001
+// Larger differences are treated as the engine pausing audio (or bursting after a stall) and are
+// filled with silence (or dropped) instead of resampled.
+#define AUDIO_GAP_HNS (200 * MS2HNS)
+
+// Engine audio on its way to the encoder.
+// The engine audio thread writes 16 bit PCM or float samples, which are converted and put in a lock-free ring.
+// The encoder reads fixed size chunks whose timestamps come from the number of frames written,
+// so the audio timeline is sample accurate instead of being derived from callback times.
+// Callback times are only used to measure how far the audio clock has drifted from the video clock (QPC),
+// which is corrected with small resampling adjustments.
+class AudioPipeline
+{
+public:
+    AudioPipeline(UINT32 sampleRate, UINT32 channels);
+
+    // Drop all audio and start a new timeline at startTime (QPC).
+    // Must not be called while either thread is using the pipeline.
+    void Reset(LONGLONG startTime, LONGLONG qpcFrequency);
+
+    // Producer: interleaved samples captured at timestamp (QPC).
+    void WritePCM(const short* samples, UINT32 sampleCount, LONGLONG timestamp);
+    void WriteFloat(const float* samples, UINT32 sampleCount, LONGLONG timestamp);
+
+    // Consumer: true if Read can fill a buffer of byteCount bytes.
+    bool CanRead(UINT32 byteCount);
+
+    // Consumer: fill buffer with byteCount bytes of 16 bit PCM.
+    // sampleTime and duration are in 100ns units from the start of the recording.
+    bool Read(BYTE* buffer, UINT32 byteCount, LONGLONG& sampleTime, LONGLONG& duration);
+
+    // Smoothed difference between engine audio and the video clock, positive when audio is behind.
+    LONGLONG GetDriftHNS()
+    {
+        return currentDrift.load(std::memory_order_relaxed);
+    }
+
+    // Convert float samples in -1..1 to 16 bit PCM, clamping out of range values.
+    static void ConvertFloatToPCM(const float* src, short* dst, UINT32 sampleCount);
+
+private:
+    void Write(const short* samples, UINT32 frameCount, LONGLONG timestamp);
+    void UpdateDrift(LONGLONG arrivalTime, double error);
+    void WriteSilence(UINT64 frameCount);
+
+    LONGLONG FramesToHNS(UINT64 frames)
+    {
+        return (LONGLONG)((frames * QPC_MULTIPLIER) / sampleRate);
+    }
+
+    UINT64 HNSToFrames(LONGLONG hns)
+    {
+        return (UINT64)((hns * sampleRate) / QPC_MULTIPLIER);
+    }
+
+    UINT64 GetFreeFrames()
+    {
+        return AUDIO_RING_FRAMES - (writtenFrames - readFrames.load(std::memory_order_acquire));
+    }
+
+    UINT32 sampleRate;
+    UINT32 channels;
+
+    LONGLONG startTime = 0;
+    LONGLONG qpcFrequency = 1;
+
+    // Ring of interleaved samples.
+    // writtenFrames is only changed by the producer and published through committedFrames.
+    std::vector<short> ring;
+    UINT64 writtenFrames = 0;
+    std::atomic<UINT64> committedFrames { 0 };
+    std::atomic<UINT64> readFrames { 0 };
+
+    // Media time of the first frame in the ring timeline, set by the producer before the first frame is committed.
+    LONGLONG anchorTime = -1;
+
+    // Drift measurement, producer only.
+    // The offset is the average difference during warm up, which depends on the engine's buffering rather than on drift.
+    double smoothedDrift = 0;
+    double driftOffset = 0;
+    double warmupSum = 0;
+    UINT32 warmupCount = 0;
+    bool warmingUp = true;
+    bool correcting = false;
+    std::atomic<LONGLONG> currentDrift { 0 };
+
+    // Resampler state, producer only.
+    // Output position relative to the last frame of the previous callback, in input frames.
+    double resamplePhase = 0;
+    double rateAdjustment = 0;
+    std::vector<short> previousFrame;
+
+    // Float conversion scratch, producer only.
+    std::vector<short> convertedSamples;
+};
@@ -51,6 +51,12 @@ bool CompositorInterface::Initialize(ID3D11Device* device, ID3D11ShaderResourceV
     _device = device;
 
     hologramQueue = new HologramQueue();
+#if STORE_HOLOGRAM_FRAMES
+    if (hologramFrameStore == nullptr)
+    {
+        hologramFrameStore = new HologramFrameStore(HOLOGRAM_WIDTH, HOLOGRAM_HEIGHT, (size_t)HOLOGRAM_STORE_BUDGET_MB * 1024 * 1024);
+    }
+#endif
 
     return SUCCEEDED(frameProvider->Initialize(colorSRV, outputTexture));
 }
@@ -83,7 +89,7 @@ void CompositorInterface::UpdateFrameProvider()
 
         DirectXHelper::GetBytesFromTexture(_device, canonColorTexture, FRAME_BPP, canonColorBytes);
 
-        DirectXHelper::AlphaBlend(canonColorBytes, cachedHiResHoloBytes, HOLOGRAM_BUFSIZE_HIRES, alpha);
+        DirectXHelper::AlphaBlend(canonColorBytes, cachedHiResHoloBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, alpha, cachedHiResHoloTiles);
         ID3D11Texture2D* tex = DirectXHelper::CreateTexture(_device, canonColorBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, FRAME_BPP);
         DirectX::SaveWICTextureToFile(context, tex, GUID_ContainerFormatPng, photoPath.c_str());
 
@@ -145,7 +151,7 @@ LONGLONG CompositorInterface::GetColorDuration()
 }
 
 void CompositorInterface::TakePicture(ID3D11Device* device, int width, int height, int bpp, 
-    BYTE* bytes, BYTE* colorBytes, BYTE* holoBytes)
+    BYTE* bytes, BYTE* colorBytes, BYTE* holoBytes, const BYTE* holoTiles)
 {
     if (device == nullptr)
     {
@@ -172,7 +178,14 @@ void CompositorInterface::TakePicture(ID3D11Device* device, int width, int heigh
     DirectX::SaveWICTextureToFile(context, holoTex, GUID_ContainerFormatPng, holoPath.c_str());
 
     BYTE* alphaBytes = new BYTE[FRAME_BUFSIZE];
-    DirectXHelper::AlphaAsRGBA(holoBytes, alphaBytes, FRAME_WIDTH, FRAME_HEIGHT);
+    if (holoTiles != nullptr)
+    {
+        DirectXHelper::AlphaAsRGBA(holoBytes, alphaBytes, FRAME_WIDTH, FRAME_HEIGHT, holoTiles);
+    }
+    else
+    {
+        DirectXHelper::AlphaAsRGBA(holoBytes, alphaBytes, FRAME_WIDTH, FRAME_HEIGHT);
+    }
 
     ID3D11Texture2D* alphaTex = DirectXHelper::CreateTexture(device, alphaBytes, width, height, bpp);
     DirectX::SaveWICTextureToFile(context, alphaTex, GUID_ContainerFormatPng, alphaPath.c_str());
@@ -180,7 +193,7 @@ void CompositorInterface::TakePicture(ID3D11Device* device, int width, int heigh
     delete[] alphaBytes;
 }
 
-void CompositorInterface::TakeCanonPicture(ID3D11Device* device, BYTE* bytes)
+void CompositorInterface::TakeCanonPicture(ID3D11Device* device, BYTE* bytes, const BYTE* tiles)
 {
 #if USE_CANON_SDK
     if (device == nullptr || takingCanonPicture)
@@ -198,6 +211,14 @@ void CompositorInterface::TakeCanonPicture(ID3D11Device* device, BYTE* bytes)
     canonPhotoPath = DirectoryHelper::FindUniqueFileName(outputPathCanon, L"Color", L".jpg", canonPhotoIndex);
 
     memcpy(cachedHiResHoloBytes, bytes, HOLOGRAM_BUFSIZE_HIRES);
+    if (tiles != nullptr)
+    {
+        memcpy(cachedHiResHoloTiles, tiles, DirectXHelper::GetTileCount(HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES));
+    }
+    else
+    {
+        DirectXHelper::ClassifyTiles(cachedHiResHoloBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, cachedHiResHoloTiles);
+    }
 
     concurrency::create_task([=]
     {
@@ -221,7 +242,7 @@ void CompositorInterface::TakeCanonPicture(ID3D11Device* device, BYTE* bytes)
     DirectX::SaveWICTextureToFile(context, holoTex, GUID_ContainerFormatPng, holoPath.c_str());
 
     BYTE* alphaBytes = new BYTE[HOLOGRAM_BUFSIZE_HIRES];
-    DirectXHelper::AlphaAsRGBA(bytes, alphaBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES);
+    DirectXHelper::AlphaAsRGBA(bytes, alphaBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, cachedHiResHoloTiles);
     ID3D11Texture2D* alphaTex = DirectXHelper::CreateTexture(device, alphaBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, FRAME_BPP);
     DirectX::SaveWICTextureToFile(context, alphaTex, GUID_ContainerFormatPng, alphaPath.c_str());
     delete[] alphaBytes;
@@ -244,8 +265,13 @@ void CompositorInterface::StartRecording()
     }
 
     videoIndex++;
+#if VIDEO_SEGMENT_SECONDS > 0
+    // Segmented recordings are named after their playlist.
+    std::wstring videoPath = DirectoryHelper::FindUniqueFileName(outputPath, L"Video", L".m3u", videoIndex);
+#else
     std::wstring videoPath = DirectoryHelper::FindUniqueFileName(outputPath, L"Video", L".mp4", videoIndex);
-    videoEncoder->StartRecording(videoPath.c_str(), ENCODE_AUDIO);
+#endif
+    videoEncoder->StartRecording(videoPath.c_str(), ENCODE_AUDIO, (LONGLONG)VIDEO_SEGMENT_SECONDS * QPC_MULTIPLIER);
 }
 
 void CompositorInterface::StopRecording()
@@ -258,6 +284,17 @@ void CompositorInterface::StopRecording()
     videoEncoder->StopRecording();
 }
 
+bool CompositorInterface::SetStreamingSink(IMFMediaSink* sink)
+{
+    if (videoEncoder == nullptr)
+    {
+        return false;
+    }
+
+    videoEncoder->SetStreamingSink(sink);
+    return true;
+}
+
 bool CompositorInterface::IsVideoFrameReady()
 {
     if (frameProvider == nullptr)
@@ -295,6 +332,27 @@ void CompositorInterface::RecordFrameAsync(BYTE* videoFrame, LONGLONG frameTime)
     videoEncoder->QueueVideoFrame(videoFrame, frameTime, frameProvider->GetDurationHNS());
 }
 
+PooledMediaBuffer* CompositorInterface::AcquireVideoFrameBuffer()
+{
+    if (videoEncoder == nullptr)
+    {
+        return nullptr;
+    }
+
+    return videoEncoder->AcquireVideoBuffer();
+}
+
+void CompositorInterface::RecordFrameAsync(PooledMediaBuffer* videoFrame, LONGLONG frameTime)
+{
+    if (frameProvider == nullptr || videoEncoder == nullptr)
+    {
+        SafeRelease(videoFrame);
+        return;
+    }
+
+    videoEncoder->QueueVideoFrame(videoFrame, frameTime, frameProvider->GetDurationHNS());
+}
+
 void CompositorInterface::RecordAudioFrameAsync(BYTE* audioFrame, LONGLONG frameTime)
 {
     if (videoEncoder == nullptr)
@@ -305,6 +363,16 @@ void CompositorInterface::RecordAudioFrameAsync(BYTE* audioFrame, LONGLONG frame
     videoEncoder->QueueAudioFrame(audioFrame, frameTime);
 }
 
+void CompositorInterface::RecordAudioFrameAsync(const float* audioSamples, UINT32 sampleCount, LONGLONG frameTime)
+{
+    if (videoEncoder == nullptr)
+    {
+        return;
+    }
+
+    videoEncoder->QueueAudioFrame(audioSamples, sampleCount, frameTime);
+}
+
 bool CompositorInterface::OutputYUV()
 {
     if (frameProvider == nullptr)
@@ -335,3 +403,43 @@ FrameMessage* CompositorInterface::FindClosestHologramFrame(LONGLONG timeStamp,
     return hologramQueue->FindClosestFrame(timeStamp, frameOffset);
 }
 
+void CompositorInterface::StoreHologramFrame(const BYTE* holoBytes, LONGLONG timeStamp)
+{
+    if (hologramFrameStore == nullptr)
+    {
+        return;
+    }
+
+    hologramFrameStore->Store(holoBytes, timeStamp);
+}
+
+LONGLONG CompositorInterface::FindClosestStoredHologramFrame(LONGLONG timeStamp, LONGLONG frameOffset)
+{
+    if (hologramFrameStore == nullptr)
+    {
+        return INVALID_TIMESTAMP;
+    }
+
+    return hologramFrameStore->FindClosestFrame(timeStamp, frameOffset);
+}
+
+bool CompositorInterface::GetStoredHologramFrame(LONGLONG timeStamp, BYTE* holoBytes)
+{
+    if (hologramFrameStore == nullptr)
+    {
+        return false;
+    }
+
+    return hologramFrameStore->GetFrame(timeStamp, holoBytes);
+}
+
+void CompositorInterface::SetHologramFrameBudget(size_t bytes)
+{
+    if (hologramFrameStore == nullptr)
+    {
+        return;
+    }
+
+    hologramFrameStore->SetMemoryBudget(bytes);
+}
+
@@ -9,6 +9,7 @@
 #include "ScreenGrab.h"
 #include "wincodec.h"
 #include "HologramQueue.h"
+#include "HologramFrameStore.h"
 
 #if USE_CANON_SDK
 #include "CanonSDKManager.h"
@@ -32,6 +33,7 @@ private:
     bool takingCanonPicture = false;
     std::wstring canonPhotoPath = L"";
     BYTE* cachedHiResHoloBytes = new BYTE[HOLOGRAM_BUFSIZE_HIRES];
+    BYTE* cachedHiResHoloTiles = new BYTE[DirectXHelper::GetTileCount(HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES)];
     BYTE* canonColorBytes = new BYTE[HOLOGRAM_BUFSIZE_HIRES];
 
     CRITICAL_SECTION canonLock;
@@ -43,6 +45,7 @@ private:
     ID3D11Device* _device;
 
     HologramQueue* hologramQueue;
+    HologramFrameStore* hologramFrameStore = nullptr;
     LONGLONG stubVideoTime = 0;
 
 #if USE_CANON_SDK
@@ -62,16 +65,25 @@ public:
 
     DLLEXPORT LONGLONG GetColorDuration();
 
+    // holoTiles and hiResHoloTiles are optional tile maps from DirectXHelper::ClassifyTiles for the hologram bytes.
     DLLEXPORT void TakePicture(ID3D11Device* device, int width, int height, int bpp, 
-        BYTE* bytes, BYTE* colorBytes, BYTE* holoBytes);
-    DLLEXPORT void TakeCanonPicture(ID3D11Device* device, BYTE* hiResHoloBytes);
+        BYTE* bytes, BYTE* colorBytes, BYTE* holoBytes, const BYTE* holoTiles = nullptr);
+    DLLEXPORT void TakeCanonPicture(ID3D11Device* device, BYTE* hiResHoloBytes, const BYTE* hiResHoloTiles = nullptr);
 
     DLLEXPORT bool InitializeVideoEncoder(ID3D11Device* device);
     DLLEXPORT void StartRecording();
     DLLEXPORT void StopRecording();
+    // Stream the recording to sink (eg: the MixedRemoteViewCompositor network sink) as it is encoded.
+    // Requires InitializeVideoEncoder, pass nullptr to stop streaming.
+    DLLEXPORT bool SetStreamingSink(IMFMediaSink* sink);
     DLLEXPORT bool IsVideoFrameReady();
     DLLEXPORT void RecordFrameAsync(BYTE* videoFrame, LONGLONG frameTime);
+    // Zero copy recording: fill the returned buffer with a video frame and pass it to RecordFrameAsync, which takes ownership.
+    // Returns nullptr when not recording.
+    DLLEXPORT PooledMediaBuffer* AcquireVideoFrameBuffer();
+    DLLEXPORT void RecordFrameAsync(PooledMediaBuffer* videoFrame, LONGLONG frameTime);
     DLLEXPORT void RecordAudioFrameAsync(BYTE* audioFrame, LONGLONG frameTime);
+    DLLEXPORT void RecordAudioFrameAsync(const float* audioSamples, UINT32 sampleCount, LONGLONG frameTime);
 
     DLLEXPORT void SetAlpha(float newAlpha)
     {
@@ -87,5 +99,13 @@ public:
 
     DLLEXPORT FrameMessage* GetNextHologramFrame(LONGLONG timeStamp);
     DLLEXPORT FrameMessage* FindClosestHologramFrame(LONGLONG timeStamp, LONGLONG frameOffset);
+
+    // Rendered hologram frames, when STORE_HOLOGRAM_FRAMES is set.
+    // holoBytes are HOLOGRAM_WIDTH x HOLOGRAM_HEIGHT RGBA, timeStamp is the pose the frame was rendered for.
+    DLLEXPORT void StoreHologramFrame(const BYTE* holoBytes, LONGLONG timeStamp);
+    // Returns the time of the stored frame to use for a color frame, or INVALID_TIMESTAMP.
+    DLLEXPORT LONGLONG FindClosestStoredHologramFrame(LONGLONG timeStamp, LONGLONG frameOffset);
+    DLLEXPORT bool GetStoredHologramFrame(LONGLONG timeStamp, BYTE* holoBytes);
+    DLLEXPORT void SetHologramFrameBudget(size_t bytes);
 };
 
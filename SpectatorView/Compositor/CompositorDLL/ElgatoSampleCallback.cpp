@@ -9,11 +9,38 @@ ElgatoSampleCallback::ElgatoSampleCallback(ID3D11Device* device) :
     _device(device)
 {
     InitializeCriticalSection(&frameAccessCriticalSection);
+    InitializeCriticalSection(&cacheCriticalSection);
+
+    for (int i = 0; i < ELGATO_FRAME_CACHE_SIZE; i++)
+    {
+        cachedBuffers[i] = new BYTE[FRAME_BUFSIZE];
+        cachedTimeStamps[i] = 0;
+    }
+
+    for (int i = 0; i < ELGATO_STAGING_BUFFERS; i++)
+    {
+        stagingBuffers[i] = new BYTE[FRAME_BUFSIZE];
+    }
+
+    QueryPerformanceFrequency(&qpcFrequency);
 }
 
 ElgatoSampleCallback::~ElgatoSampleCallback()
 {
     isEnabled = false;
+
+    for (int i = 0; i < ELGATO_FRAME_CACHE_SIZE; i++)
+    {
+        delete[] cachedBuffers[i];
+    }
+
+    for (int i = 0; i < ELGATO_STAGING_BUFFERS; i++)
+    {
+        delete[] stagingBuffers[i];
+    }
+
+    DeleteCriticalSection(&cacheCriticalSection);
+    DeleteCriticalSection(&frameAccessCriticalSection);
 }
 
 STDMETHODIMP ElgatoSampleCallback::BufferCB(double time, BYTE *pBuffer, long length)
@@ -23,9 +50,6 @@ STDMETHODIMP ElgatoSampleCallback::BufferCB(double time, BYTE *pBuffer, long len
     // Get frame time.
     LARGE_INTEGER t;
     QueryPerformanceCounter(&t);
-    thirdTimeStamp = secondTimeStamp;
-    secondTimeStamp = latestTimeStamp;
-    latestTimeStamp = t.QuadPart;
 
     int copyLength = length;
     if (copyLength > FRAME_BUFSIZE)
@@ -34,30 +58,126 @@ STDMETHODIMP ElgatoSampleCallback::BufferCB(double time, BYTE *pBuffer, long len
         copyLength = FRAME_BUFSIZE;
     }
 
-    memcpy(thirdCachedBuffer, secondCachedBuffer, FRAME_BUFSIZE);
-    memcpy(secondCachedBuffer, latestBuffer, FRAME_BUFSIZE);
-    memcpy(latestBuffer, pBuffer, copyLength);
+    // writeIndex is neither published nor being read, so it can be filled without holding the lock.
+    memcpy(cachedBuffers[writeIndex], pBuffer, copyLength);
+    cachedTimeStamps[writeIndex] = t.QuadPart;
+
+    EnterCriticalSection(&cacheCriticalSection);
+    publishedIndices[2] = publishedIndices[1];
+    publishedIndices[1] = publishedIndices[0];
+    publishedIndices[0] = writeIndex;
+    publishedFrameCount++;
+    writeIndex = FindFreeSlot();
+    LeaveCriticalSection(&cacheCriticalSection);
 
     EnterCriticalSection(&frameAccessCriticalSection);
     isVideoFrameReady = true;
     LeaveCriticalSection(&frameAccessCriticalSection);
+
+    RecordCallbackTime(t.QuadPart);
     return S_OK;
 }
 
+int ElgatoSampleCallback::FindFreeSlot()
+{
+    for (int i = 0; i < ELGATO_FRAME_CACHE_SIZE; i++)
+    {
+        if (i != readIndex &&
+            i != publishedIndices[0] &&
+            i != publishedIndices[1] &&
+            i != publishedIndices[2])
+        {
+            return i;
+        }
+    }
+
+    // Unreachable with ELGATO_FRAME_CACHE_SIZE >= 5.
+    return publishedIndices[2];
+}
+
+void ElgatoSampleCallback::RecordCallbackTime(LONGLONG startTicks)
+{
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+    LONGLONG elapsed = end.QuadPart - startTicks;
+
+    // A callback is late if it takes more than half of the time since the previous frame arrived.
+    if (prevCallbackStart != 0 && elapsed * 2 > startTicks - prevCallbackStart)
+    {
+        lateCallbackCount++;
+    }
+    prevCallbackStart = startTicks;
+
+    callbackCount++;
+    totalCallbackTicks += elapsed;
+    if (elapsed > maxCallbackTicks)
+    {
+        maxCallbackTicks = elapsed;
+    }
+
+    if (callbackCount % ELGATO_TIMING_REPORT_INTERVAL == 0)
+    {
+        std::wstring report = L"Elgato BufferCB: average " + std::to_wstring(GetAverageCallbackMS()) +
+            L" ms, max " + std::to_wstring(GetMaxCallbackMS()) +
+            L" ms, " + std::to_wstring(lateCallbackCount) + L" late callbacks.\n";
+        OutputDebugString(report.c_str());
+    }
+}
+
+double ElgatoSampleCallback::GetAverageCallbackMS()
+{
+    if (callbackCount == 0)
+    {
+        return 0;
+    }
+
+    return (1000.0 * totalCallbackTicks / callbackCount) / qpcFrequency.QuadPart;
+}
+
+double ElgatoSampleCallback::GetMaxCallbackMS()
+{
+    return (1000.0 * maxCallbackTicks) / qpcFrequency.QuadPart;
+}
+
 // Call this from the Render thread.
 void ElgatoSampleCallback::UpdateSRV(ID3D11ShaderResourceView* srv, bool useCPU)
 {
+    EnterCriticalSection(&cacheCriticalSection);
+    // Do not cache when using the CPU
+    int index = useCPU ? publishedIndices[0] : publishedIndices[2];
+    if (index < 0 || publishedFrameCount == presentedFrameCount)
+    {
+        LeaveCriticalSection(&cacheCriticalSection);
+        return;
+    }
+
+    readIndex = index;
+    presentedFrameCount = publishedFrameCount;
+    LeaveCriticalSection(&cacheCriticalSection);
+
+    presentedTimeStamp = cachedTimeStamps[index];
+
     if (useCPU)
     {
-        BYTE* stagingBytes = new BYTE[FRAME_BUFSIZE];
-        // Do not cache when using the CPU
-        DirectXHelper::ConvertYUVtoBGRA(latestBuffer, stagingBytes, FRAME_WIDTH, FRAME_HEIGHT, true);
+        BYTE* stagingBytes = stagingBuffers[stagingIndex];
+        stagingIndex = (stagingIndex + 1) % ELGATO_STAGING_BUFFERS;
+
+        DirectXHelper::ConvertYUVtoBGRA(cachedBuffers[index], stagingBytes, FRAME_WIDTH, FRAME_HEIGHT, true);
+
+        // The raw frame is no longer needed once it has been converted.
+        EnterCriticalSection(&cacheCriticalSection);
+        readIndex = -1;
+        LeaveCriticalSection(&cacheCriticalSection);
+
         DirectXHelper::UpdateSRV(_device, srv, stagingBytes, FRAME_WIDTH * FRAME_BPP);
-        delete[] stagingBytes;
     }
     else
     {
-        DirectXHelper::UpdateSRV(_device, srv, thirdCachedBuffer, FRAME_WIDTH * FRAME_BPP);
+        DirectXHelper::UpdateSRV(_device, srv, cachedBuffers[index], FRAME_WIDTH * FRAME_BPP);
+
+        EnterCriticalSection(&cacheCriticalSection);
+        readIndex = -1;
+        LeaveCriticalSection(&cacheCriticalSection);
     }
 }
 
@@ -72,4 +192,4 @@ bool ElgatoSampleCallback::IsVideoFrameReady()
     LeaveCriticalSection(&frameAccessCriticalSection);
 
     return ret;
-}
\ No newline at end of file
+}
@@ -7,6 +7,13 @@
 
 #include "DirectXHelper.h"
 
+// Number of raw frames cached from the capture card: 3 newest frames, 1 being read by the render thread and 1 being written.
+#define ELGATO_FRAME_CACHE_SIZE 5
+// Number of CPU conversion staging buffers, alternated every frame.
+#define ELGATO_STAGING_BUFFERS 2
+// Number of callbacks between timing reports.
+#define ELGATO_TIMING_REPORT_INTERVAL 300
+
 class ElgatoSampleCallback : public ISampleGrabberCB
 {
 public:
@@ -56,9 +63,13 @@ public:
     
     LONGLONG GetTimestamp()
     {
-        return thirdTimeStamp;
+        return presentedTimeStamp;
     }
 
+    // Time spent inside BufferCB, to verify the capture thread stays well inside the frame interval.
+    double GetAverageCallbackMS();
+    double GetMaxCallbackMS();
+
     bool IsVideoFrameReady();
     bool IsEnabled()
     {
@@ -66,17 +77,40 @@ public:
     }
 
 private:
+    // Call with cacheCriticalSection held.
+    int FindFreeSlot();
+    void RecordCallbackTime(LONGLONG startTicks);
+
     ULONG m_cRef = 0;
 
     ID3D11Device* _device;
-    BYTE* thirdCachedBuffer = new BYTE[FRAME_BUFSIZE];
-    BYTE* secondCachedBuffer = new BYTE[FRAME_BUFSIZE];
-    BYTE* latestBuffer = new BYTE[FRAME_BUFSIZE];
 
-    LONGLONG latestTimeStamp = 0;
-    LONGLONG secondTimeStamp = 0;
-    LONGLONG thirdTimeStamp = 0;
+    // Raw frames from the capture card.
+    // BufferCB fills writeIndex, publishedIndices holds the newest frames (latest first) and
+    // readIndex is the slot the render thread is using, so frames are never copied between slots.
+    BYTE* cachedBuffers[ELGATO_FRAME_CACHE_SIZE];
+    LONGLONG cachedTimeStamps[ELGATO_FRAME_CACHE_SIZE];
+    int publishedIndices[3] = { -1, -1, -1 };
+    int writeIndex = 0;
+    int readIndex = -1;
+
+    LONGLONG publishedFrameCount = 0;
+    LONGLONG presentedFrameCount = 0;
+    LONGLONG presentedTimeStamp = 0;
+
+    // CPU conversion output.
+    BYTE* stagingBuffers[ELGATO_STAGING_BUFFERS];
+    int stagingIndex = 0;
+
+    // Callback timing in QPC ticks.
+    LARGE_INTEGER qpcFrequency;
+    LONGLONG callbackCount = 0;
+    LONGLONG totalCallbackTicks = 0;
+    LONGLONG maxCallbackTicks = 0;
+    LONGLONG lateCallbackCount = 0;
+    LONGLONG prevCallbackStart = 0;
 
+    CRITICAL_SECTION cacheCriticalSection;
     CRITICAL_SECTION frameAccessCriticalSection;
     bool isVideoFrameReady = false;
     bool isEnabled = false;
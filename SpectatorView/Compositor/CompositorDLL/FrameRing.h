@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+#include <atomic>
+
+// Lock-free ring of preallocated slots for handing frames from exactly one producer thread to exactly one consumer thread.
+// Slots are reused, so anything expensive (frame buffers) is only allocated the first time a slot is filled.
+template <typename T, unsigned int Size>
+class FrameRing
+{
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "FrameRing size must be a power of 2");
+
+public:
+    // Producer: get the next free slot, or nullptr if the consumer has not caught up.
+    T* BeginWrite()
+    {
+        unsigned int head = writeIndex.load(std::memory_order_relaxed);
+        if (head - readIndex.load(std::memory_order_acquire) == Size)
+        {
+            return nullptr;
+        }
+
+        return &slots[head % Size];
+    }
+
+    // Producer: publish the slot returned by BeginWrite.
+    void EndWrite()
+    {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: get the oldest published slot, or nullptr if the ring is empty.
+    T* BeginRead()
+    {
+        unsigned int tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == writeIndex.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &slots[tail % Size];
+    }
+
+    // Consumer: return the slot returned by BeginRead to the producer.
+    void EndRead()
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Number of published slots that have not been read yet.
+    unsigned int Count() const
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    // Drop everything that has been published.  Only call this from the consumer thread.
+    void Clear()
+    {
+        readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    T slots[Size];
+
+    std::atomic<unsigned int> writeIndex { 0 };
+    std::atomic<unsigned int> readIndex { 0 };
+};
@@ -0,0 +1,221 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "HologramFrameStore.h"
+
+HologramFrameStore::HologramFrameStore(int width, int height, size_t memoryBudget) :
+    width(width),
+    height(height),
+    memoryBudget(memoryBudget)
+{
+    tilesX = DirectXHelper::GetTileCountX(width);
+    tilesY = DirectXHelper::GetTileCountY(height);
+
+    InitializeCriticalSection(&storeLock);
+}
+
+HologramFrameStore::~HologramFrameStore()
+{
+    DeleteCriticalSection(&storeLock);
+}
+
+void HologramFrameStore::SetMemoryBudget(size_t memoryBudget)
+{
+    EnterCriticalSection(&storeLock);
+    this->memoryBudget = memoryBudget;
+    TrimToBudget();
+    LeaveCriticalSection(&storeLock);
+}
+
+size_t HologramFrameStore::GetMemoryUsage()
+{
+    EnterCriticalSection(&storeLock);
+    size_t usage = memoryUsage;
+    LeaveCriticalSection(&storeLock);
+
+    return usage;
+}
+
+void HologramFrameStore::Store(const BYTE* bytes, LONGLONG timeStamp)
+{
+    if (timeStamp == INVALID_TIMESTAMP)
+    {
+        return;
+    }
+
+    EnterCriticalSection(&storeLock);
+
+    // Unity can render more than once for the same pose, only the latest render is kept.
+    if (!frames.empty() && frames.back().timeStamp == timeStamp)
+    {
+        memoryUsage -= frames.back().GetSize();
+        Compact(bytes, frames.back());
+        memoryUsage += frames.back().GetSize();
+    }
+    else
+    {
+        frames.push_back(std::move(spareFrame));
+        spareFrame = StoredFrame();
+
+        StoredFrame& frame = frames.back();
+        frame.timeStamp = timeStamp;
+        Compact(bytes, frame);
+        memoryUsage += frame.GetSize();
+    }
+
+    TrimToBudget();
+
+    LeaveCriticalSection(&storeLock);
+}
+
+void HologramFrameStore::TrimToBudget()
+{
+    // Always keep the newest frame, even if it is over budget on its own.
+    while (frames.size() > 1 && memoryUsage > memoryBudget)
+    {
+        memoryUsage -= frames.front().GetSize();
+
+        if (spareFrame.GetSize() == 0)
+        {
+            spareFrame = std::move(frames.front());
+        }
+
+        frames.pop_front();
+    }
+}
+
+LONGLONG HologramFrameStore::FindClosestFrame(LONGLONG timeStamp, LONGLONG frameOffset)
+{
+    EnterCriticalSection(&storeLock);
+
+    LONGLONG closestTime = INVALID_TIMESTAMP;
+    LONGLONG smallestDelta = std::numeric_limits<LONGLONG>::max();
+
+    for (const StoredFrame& frame : frames)
+    {
+        LONGLONG delta = timeStamp - frame.timeStamp - frameOffset;
+
+        if (delta >= 0 && delta < smallestDelta)
+        {
+            smallestDelta = delta;
+            closestTime = frame.timeStamp;
+        }
+    }
+
+    if (closestTime == INVALID_TIMESTAMP && !frames.empty())
+    {
+        // Didn't find a match, give the last known frame
+        closestTime = frames.back().timeStamp;
+    }
+
+    LeaveCriticalSection(&storeLock);
+
+    return closestTime;
+}
+
+bool HologramFrameStore::GetFrame(LONGLONG timeStamp, BYTE* bytes)
+{
+    bool found = false;
+
+    EnterCriticalSection(&storeLock);
+
+    for (const StoredFrame& frame : frames)
+    {
+        if (frame.timeStamp == timeStamp)
+        {
+            Expand(frame, bytes);
+            found = true;
+            break;
+        }
+    }
+
+    LeaveCriticalSection(&storeLock);
+
+    return found;
+}
+
+void HologramFrameStore::Compact(const BYTE* bytes, StoredFrame& frame)
+{
+    frame.tiles.resize(tilesX * tilesY);
+    DirectXHelper::ClassifyTiles(bytes, width, height, frame.tiles.data());
+
+    size_t pixelCount = 0;
+    for (int ty = 0; ty < tilesY; ty++)
+    {
+        int tileHeight = (std::min)(HOLOGRAM_TILE_SIZE, height - ty * HOLOGRAM_TILE_SIZE);
+        for (int tx = 0; tx < tilesX; tx++)
+        {
+            if (frame.tiles[ty * tilesX + tx] != TileEmpty)
+            {
+                int tileWidth = (std::min)(HOLOGRAM_TILE_SIZE, width - tx * HOLOGRAM_TILE_SIZE);
+                pixelCount += tileWidth * tileHeight;
+            }
+        }
+    }
+
+    // Resizing within the capacity of a reused frame does not allocate.
+    frame.pixels.resize(pixelCount * FRAME_BPP);
+
+    BYTE* dst = frame.pixels.data();
+    for (int ty = 0; ty < tilesY; ty++)
+    {
+        int startRow = ty * HOLOGRAM_TILE_SIZE;
+        int endRow = (std::min)(startRow + HOLOGRAM_TILE_SIZE, height);
+
+        for (int tx = 0; tx < tilesX; tx++)
+        {
+            if (frame.tiles[ty * tilesX + tx] == TileEmpty)
+            {
+                continue;
+            }
+
+            int startColumn = tx * HOLOGRAM_TILE_SIZE;
+            size_t rowBytes = (std::min)(HOLOGRAM_TILE_SIZE, width - startColumn) * FRAME_BPP;
+
+            for (int row = startRow; row < endRow; row++)
+            {
+                memcpy(dst, bytes + ((size_t)row * width + startColumn) * FRAME_BPP, rowBytes);
+                dst += rowBytes;
+            }
+        }
+    }
+}
+
+void HologramFrameStore::Expand(const StoredFrame& frame, BYTE* bytes)
+{
+    const BYTE* src = frame.pixels.data();
+    for (int ty = 0; ty < tilesY; ty++)
+    {
+        int startRow = ty * HOLOGRAM_TILE_SIZE;
+        int endRow = (std::min)(startRow + HOLOGRAM_TILE_SIZE, height);
+
+        // Whole empty tile rows are cleared at once.
+        if (DirectXHelper::IsTileRowEmpty(frame.tiles.data(), tilesX, ty))
+        {
+            memset(bytes + (size_t)startRow * width * FRAME_BPP, 0, (size_t)(endRow - startRow) * width * FRAME_BPP);
+            continue;
+        }
+
+        for (int tx = 0; tx < tilesX; tx++)
+        {
+            int startColumn = tx * HOLOGRAM_TILE_SIZE;
+            size_t rowBytes = (std::min)(HOLOGRAM_TILE_SIZE, width - startColumn) * FRAME_BPP;
+            bool empty = frame.tiles[ty * tilesX + tx] == TileEmpty;
+
+            for (int row = startRow; row < endRow; row++)
+            {
+                BYTE* dst = bytes + ((size_t)row * width + startColumn) * FRAME_BPP;
+                if (empty)
+                {
+                    memset(dst, 0, rowBytes);
+                }
+                else
+                {
+                    memcpy(dst, src, rowBytes);
+                    src += rowBytes;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <Windows.h>
+#include <deque>
+#include <limits>
+#include <vector>
+
+#include "CompositorShared.h"
+#include "DirectXHelper.h"
+
+#define INVALID_TIMESTAMP -1
+
+// The last rendered hologram frames, so the compositor can show the frame that was rendered closest to each
+// color frame instead of whatever Unity rendered last.
+// Frames are kept tile-sparse: the tile map from DirectXHelper::ClassifyTiles, followed by the pixels of the
+// tiles that are not empty.  Holograms rarely cover much of the frame, so this is a fraction of a full RGBA frame.
+// The oldest frames are dropped to keep the store under its memory budget.
+// Store is called from the render thread and the lookups from the main thread, so all methods take a lock.
+class HologramFrameStore
+{
+public:
+    HologramFrameStore(int width, int height, size_t memoryBudget);
+    ~HologramFrameStore();
+
+    void SetMemoryBudget(size_t memoryBudget);
+    size_t GetMemoryUsage();
+
+    // Compact and keep an RGBA frame that was rendered for the hologram pose at timeStamp.
+    void Store(const BYTE* bytes, LONGLONG timeStamp);
+
+    // Same selection as HologramQueue::FindClosestFrame: the newest frame at or before timeStamp - frameOffset,
+    // or the newest frame if there is none.  Returns INVALID_TIMESTAMP if the store is empty.
+    LONGLONG FindClosestFrame(LONGLONG timeStamp, LONGLONG frameOffset);
+
+    // Expand the frame stored for timeStamp into a full RGBA frame.
+    // Returns false if the frame has been dropped since it was found.
+    bool GetFrame(LONGLONG timeStamp, BYTE* bytes);
+
+private:
+    struct StoredFrame
+    {
+        LONGLONG timeStamp = INVALID_TIMESTAMP;
+        std::vector<BYTE> tiles;
+        std::vector<BYTE> pixels;
+
+        size_t GetSize() const
+        {
+            return tiles.capacity() + pixels.capacity();
+        }
+    };
+
+    void Compact(const BYTE* bytes, StoredFrame& frame);
+    void Expand(const StoredFrame& frame, BYTE* bytes);
+    void TrimToBudget();
+
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+
+    size_t memoryBudget;
+    size_t memoryUsage = 0;
+
+    // Oldest first.
+    std::deque<StoredFrame> frames;
+    // A dropped frame whose buffers are reused by the next Store, so steady state recording does not allocate.
+    StoredFrame spareFrame;
+
+    CRITICAL_SECTION storeLock;
+};
@@ -9,11 +9,23 @@
 OpenCVFrameProvider::OpenCVFrameProvider(bool cacheFrames) :
     _cacheFrames(cacheFrames)
 {
+    for (int i = 0; i < OPENCV_FRAME_CACHE_SIZE; i++)
+    {
+        convertedBuffers[i] = new BYTE[FRAME_BUFSIZE];
+        convertedTimeStamps[i] = 0;
+    }
 }
 
 
 OpenCVFrameProvider::~OpenCVFrameProvider()
 {
+    Dispose();
+
+    for (int i = 0; i < OPENCV_FRAME_CACHE_SIZE; i++)
+    {
+        delete[] convertedBuffers[i];
+    }
+
     DeleteCriticalSection(&lock);
 }
 
@@ -38,7 +50,7 @@ HRESULT OpenCVFrameProvider::Initialize(ID3D11ShaderResourceView* colorSRV, ID3D
 
     // Attempt to update camera resolution to desired resolution.
     // Note: This may fail, and your capture will resume at the camera's native resolution.
-    // In this case, the Update loop will print an error with the expected frame resolution.
+    // In this case, the convert thread will print an error with the expected frame resolution.
     videoCapture->set(cv::CAP_PROP_FRAME_WIDTH, FRAME_WIDTH);
     videoCapture->set(cv::CAP_PROP_FRAME_HEIGHT, FRAME_HEIGHT);
 
@@ -46,85 +58,162 @@ HRESULT OpenCVFrameProvider::Initialize(ID3D11ShaderResourceView* colorSRV, ID3D
     if (IsEnabled())
     {
         hr = S_OK;
+
+        convertedFrameCount = 0;
+        presentedFrameCount = 0;
+        checkedFrameSize = false;
+        captureRing.Clear();
+
+        frameGrabbedEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+        running = true;
+        captureThread = std::thread(&OpenCVFrameProvider::CaptureThread, this);
+        convertThread = std::thread(&OpenCVFrameProvider::ConvertThread, this);
     }
 
     return hr;
 }
 
-void OpenCVFrameProvider::Update()
+// Grab frames as fast as the device delivers them.
+// Conversion happens on ConvertThread so a slow conversion never delays the next grab.
+void OpenCVFrameProvider::CaptureThread()
 {
-    if (!IsEnabled() ||
-        _colorSRV == nullptr ||
-        _device == nullptr)
+    while (running)
     {
-        return;
-    }
+        if (!videoCapture->grab())
+        {
+            Sleep(1);
+            continue;
+        }
+
+        // Get frame time as soon as the grab completes.
+        LARGE_INTEGER time;
+        QueryPerformanceCounter(&time);
 
-    // Get frame time.
-    LARGE_INTEGER time;
-    QueryPerformanceCounter(&time);
+        CaptureSlot* slot = captureRing.BeginWrite();
+        if (slot == nullptr)
+        {
+            // Conversion has fallen behind, drop this frame.
+            continue;
+        }
 
-    if (videoCapture->grab())
+        // Retrieving into a slot that has already been used reuses its buffer.
+        videoCapture->retrieve(slot->frame);
+        slot->timeStamp = time.QuadPart;
+        captureRing.EndWrite();
+
+        SetEvent(frameGrabbedEvent);
+    }
+}
+
+void OpenCVFrameProvider::ConvertThread()
+{
+    while (running)
     {
-        thirdTimeStamp = secondTimeStamp;
-        secondTimeStamp = latestTimeStamp;
-        latestTimeStamp = time.QuadPart;
+        WaitForSingleObject(frameGrabbedEvent, 100);
 
-        concurrency::create_task([=]
+        CaptureSlot* slot;
+        while (running && (slot = captureRing.BeginRead()) != nullptr)
         {
-            cv::Mat frame;
-            videoCapture->retrieve(frame);
+            cv::Mat& frame = slot->frame;
+            if (!checkedFrameSize)
+            {
+                checkedFrameSize = true;
 
-            double width = videoCapture->get(cv::CAP_PROP_FRAME_WIDTH);
-            double height = videoCapture->get(cv::CAP_PROP_FRAME_HEIGHT);
+                if (frame.cols != FRAME_WIDTH)
+                {
+                    OutputDebugString(L"ERROR: captured width does not equal FRAME_WIDTH.  Expecting: ");
+                    OutputDebugString(std::to_wstring(frame.cols).c_str());
+                    OutputDebugString(L"\n");
+                }
 
-            if (width != FRAME_WIDTH)
-            {
-                OutputDebugString(L"ERROR: captured width does not equal FRAME_WIDTH.  Expecting: ");
-                OutputDebugString(std::to_wstring(width).c_str());
-                OutputDebugString(L"\n");
+                if (frame.rows != FRAME_HEIGHT)
+                {
+                    OutputDebugString(L"ERROR: captured height does not equal FRAME_HEIGHT.  Expecting: ");
+                    OutputDebugString(std::to_wstring(frame.rows).c_str());
+                    OutputDebugString(L"\n");
+                }
             }
 
-            if (height != FRAME_HEIGHT)
+            if (frame.cols != FRAME_WIDTH || frame.rows != FRAME_HEIGHT || frame.type() != CV_8UC3)
             {
-                OutputDebugString(L"ERROR: captured height does not equal FRAME_HEIGHT.  Expecting: ");
-                OutputDebugString(std::to_wstring(height).c_str());
-                OutputDebugString(L"\n");
+                captureRing.EndRead();
+                continue;
             }
 
-            // OpenCV returns frames in RGB, convert to BGRA
-            DirectXHelper::ConvertRGBtoBGRA(frame.data, tmpData, width, height, true);
-            EnterCriticalSection(&lock);
-            dirtyFrame = false;
+            // The render thread never reads this slot, see Update.
+            int index = (int)(convertedFrameCount % OPENCV_FRAME_CACHE_SIZE);
+            BYTE* output = convertedBuffers[index];
 
-            memcpy(thirdCachedBuffer, secondCachedBuffer, FRAME_BUFSIZE);
-            memcpy(secondCachedBuffer, latestBuffer, FRAME_BUFSIZE);
-            memcpy(latestBuffer, tmpData, FRAME_BUFSIZE);
-
-            LeaveCriticalSection(&lock);
-        });
-
-        if (_device != nullptr && _colorSRV != nullptr)
-        {
-            EnterCriticalSection(&lock);
-            if (!dirtyFrame)
+            // OpenCV returns frames in RGB, convert to BGRA
+            concurrency::parallel_for(0, OPENCV_CONVERSION_BANDS, [&](int band)
             {
-                if (!_cacheFrames && latestBuffer != nullptr)
+                int startRow = band * FRAME_HEIGHT / OPENCV_CONVERSION_BANDS;
+                int endRow = (band + 1) * FRAME_HEIGHT / OPENCV_CONVERSION_BANDS;
+
+                BYTE* bandOutput = output + startRow * FRAME_WIDTH * FRAME_BPP;
+                if (frame.isContinuous())
                 {
-                    DirectXHelper::UpdateSRV(_device, _colorSRV, latestBuffer, FRAME_WIDTH * FRAME_BPP);
+                    DirectXHelper::ConvertRGBtoBGRA(frame.ptr(startRow), bandOutput, FRAME_WIDTH, endRow - startRow, true);
                 }
-                else if (_cacheFrames && thirdCachedBuffer != nullptr)
+                else
                 {
-                    DirectXHelper::UpdateSRV(_device, _colorSRV, thirdCachedBuffer, FRAME_WIDTH * FRAME_BPP);
+                    for (int row = startRow; row < endRow; row++, bandOutput += FRAME_WIDTH * FRAME_BPP)
+                    {
+                        DirectXHelper::ConvertRGBtoBGRA(frame.ptr(row), bandOutput, FRAME_WIDTH, 1, true);
+                    }
                 }
-                dirtyFrame = true;
-            }
+            });
+
+            convertedTimeStamps[index] = slot->timeStamp;
+            captureRing.EndRead();
+
+            EnterCriticalSection(&lock);
+            convertedFrameCount++;
             LeaveCriticalSection(&lock);
+        }
+    }
+}
+
+void OpenCVFrameProvider::Update()
+{
+    if (!IsEnabled() ||
+        _colorSRV == nullptr ||
+        _device == nullptr)
+    {
+        return;
+    }
+
+    // The convert thread only writes slot (convertedFrameCount % OPENCV_FRAME_CACHE_SIZE),
+    // and cannot publish while we hold the lock, so the latest and third latest slots are safe to read here.
+    EnterCriticalSection(&lock);
+    bool newFrame = false;
+    LONGLONG frameCount = convertedFrameCount;
+    if (frameCount != presentedFrameCount)
+    {
+        LONGLONG presentFrame = frameCount - 1;
+        if (_cacheFrames)
+        {
+            presentFrame -= 2;
+        }
 
-            EnterCriticalSection(&frameAccessCriticalSection);
-            isVideoFrameReady = true;
-            LeaveCriticalSection(&frameAccessCriticalSection);
+        if (presentFrame >= 0)
+        {
+            int index = (int)(presentFrame % OPENCV_FRAME_CACHE_SIZE);
+            DirectXHelper::UpdateSRV(_device, _colorSRV, convertedBuffers[index], FRAME_WIDTH * FRAME_BPP);
+            presentedTimeStamp = convertedTimeStamps[index];
+            newFrame = true;
         }
+
+        presentedFrameCount = frameCount;
+    }
+    LeaveCriticalSection(&lock);
+
+    if (newFrame)
+    {
+        EnterCriticalSection(&frameAccessCriticalSection);
+        isVideoFrameReady = true;
+        LeaveCriticalSection(&frameAccessCriticalSection);
     }
 }
 
@@ -143,7 +232,7 @@ bool OpenCVFrameProvider::IsVideoFrameReady()
 
 LONGLONG OpenCVFrameProvider::GetTimestamp()
 {
-    return thirdTimeStamp;
+    return presentedTimeStamp;
 }
 
 LONGLONG OpenCVFrameProvider::GetDurationHNS()
@@ -163,6 +252,28 @@ bool OpenCVFrameProvider::IsEnabled()
 
 void OpenCVFrameProvider::Dispose()
 {
+    running = false;
+    if (frameGrabbedEvent != NULL)
+    {
+        SetEvent(frameGrabbedEvent);
+    }
+
+    if (captureThread.joinable())
+    {
+        captureThread.join();
+    }
+
+    if (convertThread.joinable())
+    {
+        convertThread.join();
+    }
+
+    if (frameGrabbedEvent != NULL)
+    {
+        CloseHandle(frameGrabbedEvent);
+        frameGrabbedEvent = NULL;
+    }
+
     if (videoCapture != nullptr)
     {
         videoCapture->release();
@@ -10,11 +10,22 @@
 #include "DirectXHelper.h"
 
 #include "IFrameProvider.h"
+#include "FrameRing.h"
+
+#include <ppl.h>
+#include <thread>
 
 //TODO: Change this value to match the camera id you are using.
 // If your PC has an integrated webcam, that will probably be id 0.
 #define CAMERA_ID 0
 
+// Number of grabbed frames that can wait for conversion before new frames are dropped.
+#define OPENCV_CAPTURE_RING_SIZE 4
+// Number of converted frames kept for hologram stability.  Must be at least 4, see Update.
+#define OPENCV_FRAME_CACHE_SIZE 4
+// Number of row bands converted in parallel.
+#define OPENCV_CONVERSION_BANDS 4
+
 class OpenCVFrameProvider : public IFrameProvider
 {
 public:
@@ -45,26 +56,44 @@ public:
     virtual bool IsVideoFrameReady();
 
 private:
+    // A grabbed frame waiting for conversion, timestamped when the grab completed.
+    struct CaptureSlot
+    {
+        cv::Mat frame;
+        LONGLONG timeStamp = 0;
+    };
+
+    void CaptureThread();
+    void ConvertThread();
+
     CRITICAL_SECTION lock;
     CRITICAL_SECTION frameAccessCriticalSection;
 
     bool _cacheFrames = true;
 
-    LONGLONG latestTimeStamp = 0;
-    LONGLONG secondTimeStamp = 0;
-    LONGLONG thirdTimeStamp = 0;
+    // Grab -> convert hand off.
+    FrameRing<CaptureSlot, OPENCV_CAPTURE_RING_SIZE> captureRing;
+    HANDLE frameGrabbedEvent = NULL;
+
+    std::thread captureThread;
+    std::thread convertThread;
+    std::atomic<bool> running { false };
+
+    // Converted frames, indexed by convertedFrameCount % OPENCV_FRAME_CACHE_SIZE.
+    BYTE* convertedBuffers[OPENCV_FRAME_CACHE_SIZE];
+    LONGLONG convertedTimeStamps[OPENCV_FRAME_CACHE_SIZE];
+    // Guarded by lock.
+    LONGLONG convertedFrameCount = 0;
+    LONGLONG presentedFrameCount = 0;
 
-    BYTE* tmpData = new BYTE[FRAME_BUFSIZE];
-    BYTE* thirdCachedBuffer = new BYTE[FRAME_BUFSIZE];
-    BYTE* secondCachedBuffer = new BYTE[FRAME_BUFSIZE];
-    BYTE* latestBuffer = new BYTE[FRAME_BUFSIZE];
+    LONGLONG presentedTimeStamp = 0;
 
     cv::VideoCapture* videoCapture = nullptr;
     ID3D11ShaderResourceView* _colorSRV;
     ID3D11Device* _device;
 
     bool isVideoFrameReady = false;
-    bool dirtyFrame = true;
+    bool checkedFrameSize = false;
 };
 
 #endif
\ No newline at end of file
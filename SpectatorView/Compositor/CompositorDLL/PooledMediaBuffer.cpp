@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "PooledMediaBuffer.h"
+
+std::shared_ptr<MediaBufferPool> MediaBufferPool::Create(DWORD bufferSize)
+{
+    return std::shared_ptr<MediaBufferPool>(new MediaBufferPool(bufferSize));
+}
+
+MediaBufferPool::MediaBufferPool(DWORD bufferSize) :
+    bufferSize(bufferSize)
+{
+}
+
+MediaBufferPool::~MediaBufferPool()
+{
+    // Buffers hold a reference to the pool, so every block has been returned by now.
+    for (BYTE* block : freeBlocks)
+    {
+        delete[] block;
+    }
+    freeBlocks.clear();
+}
+
+HRESULT MediaBufferPool::Acquire(PooledMediaBuffer** buffer)
+{
+    if (buffer == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    BYTE* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(poolLock);
+        if (!freeBlocks.empty())
+        {
+            block = freeBlocks.back();
+            freeBlocks.pop_back();
+        }
+    }
+
+    if (block == nullptr)
+    {
+        block = new (std::nothrow) BYTE[bufferSize];
+        if (block == nullptr)
+        {
+            *buffer = nullptr;
+            return E_OUTOFMEMORY;
+        }
+    }
+
+    *buffer = new PooledMediaBuffer(shared_from_this(), block, bufferSize);
+    return S_OK;
+}
+
+void MediaBufferPool::Return(BYTE* block)
+{
+    std::lock_guard<std::mutex> lock(poolLock);
+    freeBlocks.push_back(block);
+}
+
+PooledMediaBuffer::PooledMediaBuffer(std::shared_ptr<MediaBufferPool> pool, BYTE* data, DWORD maxLength) :
+    pool(pool),
+    data(data),
+    maxLength(maxLength)
+{
+}
+
+PooledMediaBuffer::~PooledMediaBuffer()
+{
+    pool->Return(data);
+}
+
+STDMETHODIMP PooledMediaBuffer::Lock(BYTE** ppbBuffer, DWORD* pcbMaxLength, DWORD* pcbCurrentLength)
+{
+    if (ppbBuffer == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    *ppbBuffer = data;
+    if (pcbMaxLength != nullptr)
+    {
+        *pcbMaxLength = maxLength;
+    }
+    if (pcbCurrentLength != nullptr)
+    {
+        *pcbCurrentLength = currentLength;
+    }
+
+    return S_OK;
+}
+
+STDMETHODIMP PooledMediaBuffer::Unlock()
+{
+    return S_OK;
+}
+
+STDMETHODIMP PooledMediaBuffer::GetCurrentLength(DWORD* pcbCurrentLength)
+{
+    if (pcbCurrentLength == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    *pcbCurrentLength = currentLength;
+    return S_OK;
+}
+
+STDMETHODIMP PooledMediaBuffer::SetCurrentLength(DWORD cbCurrentLength)
+{
+    if (cbCurrentLength > maxLength)
+    {
+        return E_INVALIDARG;
+    }
+
+    currentLength = cbCurrentLength;
+    return S_OK;
+}
+
+STDMETHODIMP PooledMediaBuffer::GetMaxLength(DWORD* pcbMaxLength)
+{
+    if (pcbMaxLength == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    *pcbMaxLength = maxLength;
+    return S_OK;
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <Windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class PooledMediaBuffer;
+
+// Fixed size memory blocks that are handed to Media Foundation as IMFMediaBuffer without copying.
+// A block goes back to the pool when the last reference to its buffer is released,
+// so recording does not allocate once the pool has grown to the number of frames in flight.
+class MediaBufferPool : public std::enable_shared_from_this<MediaBufferPool>
+{
+public:
+    static std::shared_ptr<MediaBufferPool> Create(DWORD bufferSize);
+    ~MediaBufferPool();
+
+    // Get a buffer with a reference count of 1.  The caller must Release it, or hand the reference to an owner that will.
+    HRESULT Acquire(PooledMediaBuffer** buffer);
+
+    DWORD GetBufferSize()
+    {
+        return bufferSize;
+    }
+
+private:
+    friend class PooledMediaBuffer;
+
+    MediaBufferPool(DWORD bufferSize);
+    void Return(BYTE* block);
+
+    DWORD bufferSize;
+    std::vector<BYTE*> freeBlocks;
+    std::mutex poolLock;
+};
+
+class PooledMediaBuffer : public IMFMediaBuffer
+{
+public:
+    STDMETHODIMP_(ULONG) AddRef()
+    {
+        return InterlockedIncrement(&m_cRef);
+    }
+
+    STDMETHODIMP_(ULONG) Release()
+    {
+        ULONG ulRefCount = InterlockedDecrement(&m_cRef);
+        if (0 == ulRefCount)
+        {
+            delete this;
+        }
+        return ulRefCount;
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void **ppvObject)
+    {
+        if (NULL == ppvObject) return E_POINTER;
+        if (riid == __uuidof(IUnknown))
+        {
+            *ppvObject = static_cast<IUnknown*>(this);
+            AddRef();
+            return S_OK;
+        }
+        if (riid == __uuidof(IMFMediaBuffer))
+        {
+            *ppvObject = static_cast<IMFMediaBuffer*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppvObject = NULL;
+        return E_NOINTERFACE;
+    }
+
+    // IMFMediaBuffer
+    STDMETHODIMP Lock(BYTE** ppbBuffer, DWORD* pcbMaxLength, DWORD* pcbCurrentLength);
+    STDMETHODIMP Unlock();
+    STDMETHODIMP GetCurrentLength(DWORD* pcbCurrentLength);
+    STDMETHODIMP SetCurrentLength(DWORD cbCurrentLength);
+    STDMETHODIMP GetMaxLength(DWORD* pcbMaxLength);
+
+    // Direct access for the producer filling the buffer before it is handed to Media Foundation.
+    BYTE* GetData()
+    {
+        return data;
+    }
+
+private:
+    friend class MediaBufferPool;
+
+    PooledMediaBuffer(std::shared_ptr<MediaBufferPool> pool, BYTE* data, DWORD maxLength);
+    ~PooledMediaBuffer();
+
+    ULONG m_cRef = 1;
+
+    std::shared_ptr<MediaBufferPool> pool;
+    BYTE* data;
+    DWORD maxLength;
+    DWORD currentLength = 0;
+};
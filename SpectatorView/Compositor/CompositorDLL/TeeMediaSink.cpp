@@ -0,0 +1,564 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+#include "TeeMediaSink.h"
+
+// Reads and discards events from an event generator until it shuts down.
+class MediaEventDrain : public IMFAsyncCallback
+{
+public:
+    MediaEventDrain(IMFMediaEventGenerator* eventGenerator) :
+        eventGenerator(eventGenerator)
+    {
+        eventGenerator->AddRef();
+    }
+
+    STDMETHODIMP_(ULONG) AddRef()
+    {
+        return InterlockedIncrement(&m_cRef);
+    }
+
+    STDMETHODIMP_(ULONG) Release()
+    {
+        ULONG ulRefCount = InterlockedDecrement(&m_cRef);
+        if (0 == ulRefCount)
+        {
+            delete this;
+        }
+        return ulRefCount;
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void **ppvObject)
+    {
+        if (NULL == ppvObject) return E_POINTER;
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFAsyncCallback))
+        {
+            *ppvObject = static_cast<IMFAsyncCallback*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppvObject = NULL;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP GetParameters(DWORD* pdwFlags, DWORD* pdwQueue)
+    {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP Invoke(IMFAsyncResult* pAsyncResult)
+    {
+        IMFMediaEvent* mediaEvent = NULL;
+        HRESULT hr = eventGenerator->EndGetEvent(pAsyncResult, &mediaEvent);
+        SafeRelease(mediaEvent);
+
+        // The event generator holds a reference to this callback while a request is pending,
+        // so the drain goes away once the generator has shut down.
+        if (SUCCEEDED(hr))
+        {
+            hr = eventGenerator->BeginGetEvent(this, NULL);
+        }
+
+        return S_OK;
+    }
+
+private:
+    ~MediaEventDrain()
+    {
+        SafeRelease(eventGenerator);
+    }
+
+    ULONG m_cRef = 1;
+    IMFMediaEventGenerator* eventGenerator;
+};
+
+HRESULT TeeMediaSink::DrainEvents(IMFMediaEventGenerator* eventGenerator)
+{
+    if (eventGenerator == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    MediaEventDrain* drain = new (std::nothrow) MediaEventDrain(eventGenerator);
+    if (drain == nullptr)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = eventGenerator->BeginGetEvent(drain, NULL);
+    drain->Release();
+
+    return hr;
+}
+
+HRESULT TeeMediaSink::Create(IMFMediaSink* primary, IMFMediaSink* secondary, LONGLONG secondaryTimeOffset, IMFMediaSink** sink)
+{
+    if (primary == nullptr || sink == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    *sink = nullptr;
+
+    TeeMediaSink* teeSink = new (std::nothrow) TeeMediaSink(primary);
+    if (teeSink == nullptr)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = teeSink->Initialize(secondary, secondaryTimeOffset);
+    if (FAILED(hr))
+    {
+        teeSink->Release();
+        return hr;
+    }
+
+    *sink = teeSink;
+    return S_OK;
+}
+
+void TeeMediaSink::SetSecondaryTimeOffset(LONGLONG secondaryTimeOffset)
+{
+    for (TeeStreamSink* stream : streams)
+    {
+        EnterCriticalSection(&stream->streamLock);
+        stream->secondaryTimeOffset = secondaryTimeOffset;
+        LeaveCriticalSection(&stream->streamLock);
+    }
+}
+
+TeeMediaSink::TeeMediaSink(IMFMediaSink* primary) :
+    primary(primary)
+{
+    primary->AddRef();
+}
+
+TeeMediaSink::~TeeMediaSink()
+{
+    if (!isShutdown)
+    {
+        Shutdown();
+    }
+
+    SafeRelease(primary);
+}
+
+HRESULT TeeMediaSink::Initialize(IMFMediaSink* secondary, LONGLONG secondaryTimeOffset)
+{
+    DWORD streamCount = 0;
+    HRESULT hr = primary->GetStreamSinkCount(&streamCount);
+
+    for (DWORD i = 0; SUCCEEDED(hr) && i < streamCount; i++)
+    {
+        IMFStreamSink* primaryStream = NULL;
+        IMFStreamSink* secondaryStream = NULL;
+        IMFMediaTypeHandler* primaryHandler = NULL;
+        IMFMediaType* mediaType = NULL;
+        DWORD streamId = 0;
+
+        hr = primary->GetStreamSinkByIndex(i, &primaryStream);
+        if (SUCCEEDED(hr)) { hr = primaryStream->GetIdentifier(&streamId); }
+        if (SUCCEEDED(hr)) { hr = primaryStream->GetMediaTypeHandler(&primaryHandler); }
+        if (SUCCEEDED(hr)) { hr = primaryHandler->GetCurrentMediaType(&mediaType); }
+
+        // Streams are matched by identifier, and the secondary stream is given the encoder's exact output type.
+        // A secondary sink that cannot take a stream only costs that stream, the recording carries on.
+        if (SUCCEEDED(hr) && secondary != nullptr)
+        {
+            HRESULT hrSecondary = secondary->GetStreamSinkById(streamId, &secondaryStream);
+            if (SUCCEEDED(hrSecondary))
+            {
+                IMFMediaTypeHandler* secondaryHandler = NULL;
+                hrSecondary = secondaryStream->GetMediaTypeHandler(&secondaryHandler);
+                if (SUCCEEDED(hrSecondary)) { hrSecondary = secondaryHandler->SetCurrentMediaType(mediaType); }
+                SafeRelease(secondaryHandler);
+            }
+            else
+            {
+                hrSecondary = secondary->AddStreamSink(streamId, mediaType, &secondaryStream);
+                if (SUCCEEDED(hrSecondary)) { hrSecondary = DrainEvents(secondaryStream); }
+            }
+
+            if (FAILED(hrSecondary))
+            {
+                OutputDebugString(L"Streaming sink does not accept the recording format.\n");
+                SafeRelease(secondaryStream);
+            }
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            TeeStreamSink* stream = new (std::nothrow) TeeStreamSink(this, primaryStream, secondaryStream, secondaryTimeOffset);
+            if (stream != nullptr)
+            {
+                streams.push_back(stream);
+            }
+            else
+            {
+                hr = E_OUTOFMEMORY;
+            }
+        }
+
+        SafeRelease(mediaType);
+        SafeRelease(primaryHandler);
+        SafeRelease(secondaryStream);
+        SafeRelease(primaryStream);
+    }
+
+    return hr;
+}
+
+STDMETHODIMP TeeMediaSink::QueryInterface(REFIID riid, void **ppvObject)
+{
+    if (NULL == ppvObject) return E_POINTER;
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFMediaSink) || riid == __uuidof(IMFFinalizableMediaSink))
+    {
+        *ppvObject = static_cast<IMFFinalizableMediaSink*>(this);
+        AddRef();
+        return S_OK;
+    }
+    *ppvObject = NULL;
+    return E_NOINTERFACE;
+}
+
+STDMETHODIMP TeeMediaSink::GetCharacteristics(DWORD* pdwCharacteristics)
+{
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    return primary->GetCharacteristics(pdwCharacteristics);
+}
+
+STDMETHODIMP TeeMediaSink::AddStreamSink(DWORD dwStreamSinkIdentifier, IMFMediaType* pMediaType, IMFStreamSink** ppStreamSink)
+{
+    return MF_E_STREAMSINKS_FIXED;
+}
+
+STDMETHODIMP TeeMediaSink::RemoveStreamSink(DWORD dwStreamSinkIdentifier)
+{
+    return MF_E_STREAMSINKS_FIXED;
+}
+
+STDMETHODIMP TeeMediaSink::GetStreamSinkCount(DWORD* pcStreamSinkCount)
+{
+    if (pcStreamSinkCount == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    *pcStreamSinkCount = (DWORD)streams.size();
+    return S_OK;
+}
+
+STDMETHODIMP TeeMediaSink::GetStreamSinkByIndex(DWORD dwIndex, IMFStreamSink** ppStreamSink)
+{
+    if (ppStreamSink == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    if (dwIndex >= streams.size())
+    {
+        return MF_E_INVALIDINDEX;
+    }
+
+    *ppStreamSink = streams[dwIndex];
+    (*ppStreamSink)->AddRef();
+    return S_OK;
+}
+
+STDMETHODIMP TeeMediaSink::GetStreamSinkById(DWORD dwStreamSinkIdentifier, IMFStreamSink** ppStreamSink)
+{
+    if (ppStreamSink == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    for (TeeStreamSink* stream : streams)
+    {
+        DWORD streamId = 0;
+        if (SUCCEEDED(stream->GetIdentifier(&streamId)) && streamId == dwStreamSinkIdentifier)
+        {
+            *ppStreamSink = stream;
+            stream->AddRef();
+            return S_OK;
+        }
+    }
+
+    return MF_E_INVALIDSTREAMNUMBER;
+}
+
+STDMETHODIMP TeeMediaSink::SetPresentationClock(IMFPresentationClock* pPresentationClock)
+{
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    return primary->SetPresentationClock(pPresentationClock);
+}
+
+STDMETHODIMP TeeMediaSink::GetPresentationClock(IMFPresentationClock** ppPresentationClock)
+{
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    return primary->GetPresentationClock(ppPresentationClock);
+}
+
+STDMETHODIMP TeeMediaSink::Shutdown()
+{
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    isShutdown = true;
+
+    for (TeeStreamSink* stream : streams)
+    {
+        stream->Shutdown();
+        stream->Release();
+    }
+    streams.clear();
+
+    return primary->Shutdown();
+}
+
+STDMETHODIMP TeeMediaSink::BeginFinalize(IMFAsyncCallback* pCallback, IUnknown* punkState)
+{
+    if (isShutdown)
+    {
+        return MF_E_SHUTDOWN;
+    }
+
+    IMFFinalizableMediaSink* finalizableSink = NULL;
+    HRESULT hr = primary->QueryInterface(IID_PPV_ARGS(&finalizableSink));
+    if (SUCCEEDED(hr))
+    {
+        hr = finalizableSink->BeginFinalize(pCallback, punkState);
+    }
+
+    SafeRelease(finalizableSink);
+    return hr;
+}
+
+STDMETHODIMP TeeMediaSink::EndFinalize(IMFAsyncResult* pResult)
+{
+    IMFFinalizableMediaSink* finalizableSink = NULL;
+    HRESULT hr = primary->QueryInterface(IID_PPV_ARGS(&finalizableSink));
+    if (SUCCEEDED(hr))
+    {
+        hr = finalizableSink->EndFinalize(pResult);
+    }
+
+    SafeRelease(finalizableSink);
+    return hr;
+}
+
+TeeStreamSink::TeeStreamSink(TeeMediaSink* sink, IMFStreamSink* primary, IMFStreamSink* secondary, LONGLONG secondaryTimeOffset) :
+    sink(sink),
+    primary(primary),
+    secondary(secondary),
+    secondaryTimeOffset(secondaryTimeOffset)
+{
+    InitializeCriticalSection(&streamLock);
+
+    primary->AddRef();
+    if (secondary != nullptr)
+    {
+        secondary->AddRef();
+    }
+}
+
+TeeStreamSink::~TeeStreamSink()
+{
+    Shutdown();
+    DeleteCriticalSection(&streamLock);
+}
+
+void TeeStreamSink::Shutdown()
+{
+    EnterCriticalSection(&streamLock);
+    sink = nullptr;
+    SafeRelease(primary);
+    SafeRelease(secondary);
+    LeaveCriticalSection(&streamLock);
+}
+
+STDMETHODIMP TeeStreamSink::QueryInterface(REFIID riid, void **ppvObject)
+{
+    if (NULL == ppvObject) return E_POINTER;
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFMediaEventGenerator) || riid == __uuidof(IMFStreamSink))
+    {
+        *ppvObject = static_cast<IMFStreamSink*>(this);
+        AddRef();
+        return S_OK;
+    }
+    *ppvObject = NULL;
+    return E_NOINTERFACE;
+}
+
+// Events, identity and media types all come from the primary stream, which is the one the sink writer drives.
+#define TEE_STREAM_FORWARD(call)                    \
+    HRESULT hr = MF_E_STREAMSINK_REMOVED;           \
+    EnterCriticalSection(&streamLock);              \
+    IMFStreamSink* stream = primary;                \
+    if (stream != nullptr) { stream->AddRef(); }    \
+    LeaveCriticalSection(&streamLock);              \
+    if (stream != nullptr)                          \
+    {                                               \
+        hr = stream->call;                          \
+        stream->Release();                          \
+    }                                               \
+    return hr;
+
+STDMETHODIMP TeeStreamSink::BeginGetEvent(IMFAsyncCallback* pCallback, IUnknown* punkState)
+{
+    TEE_STREAM_FORWARD(BeginGetEvent(pCallback, punkState));
+}
+
+STDMETHODIMP TeeStreamSink::EndGetEvent(IMFAsyncResult* pResult, IMFMediaEvent** ppEvent)
+{
+    TEE_STREAM_FORWARD(EndGetEvent(pResult, ppEvent));
+}
+
+STDMETHODIMP TeeStreamSink::GetEvent(DWORD dwFlags, IMFMediaEvent** ppEvent)
+{
+    TEE_STREAM_FORWARD(GetEvent(dwFlags, ppEvent));
+}
+
+STDMETHODIMP TeeStreamSink::QueueEvent(MediaEventType met, REFGUID guidExtendedType, HRESULT hrStatus, const PROPVARIANT* pvValue)
+{
+    TEE_STREAM_FORWARD(QueueEvent(met, guidExtendedType, hrStatus, pvValue));
+}
+
+STDMETHODIMP TeeStreamSink::GetIdentifier(DWORD* pdwIdentifier)
+{
+    TEE_STREAM_FORWARD(GetIdentifier(pdwIdentifier));
+}
+
+STDMETHODIMP TeeStreamSink::GetMediaTypeHandler(IMFMediaTypeHandler** ppHandler)
+{
+    TEE_STREAM_FORWARD(GetMediaTypeHandler(ppHandler));
+}
+
+STDMETHODIMP TeeStreamSink::PlaceMarker(MFSTREAMSINK_MARKER_TYPE eMarkerType, const PROPVARIANT* pvarMarkerValue, const PROPVARIANT* pvarContextValue)
+{
+    TEE_STREAM_FORWARD(PlaceMarker(eMarkerType, pvarMarkerValue, pvarContextValue));
+}
+
+STDMETHODIMP TeeStreamSink::Flush()
+{
+    TEE_STREAM_FORWARD(Flush());
+}
+
+STDMETHODIMP TeeStreamSink::GetMediaSink(IMFMediaSink** ppMediaSink)
+{
+    if (ppMediaSink == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    HRESULT hr = MF_E_STREAMSINK_REMOVED;
+    EnterCriticalSection(&streamLock);
+    if (sink != nullptr)
+    {
+        *ppMediaSink = sink;
+        sink->AddRef();
+        hr = S_OK;
+    }
+    LeaveCriticalSection(&streamLock);
+
+    return hr;
+}
+
+STDMETHODIMP TeeStreamSink::ProcessSample(IMFSample* pSample)
+{
+    if (pSample == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    EnterCriticalSection(&streamLock);
+    IMFStreamSink* primaryStream = primary;
+    IMFStreamSink* secondaryStream = secondary;
+    LONGLONG timeOffset = secondaryTimeOffset;
+    if (primaryStream != nullptr) { primaryStream->AddRef(); }
+    if (secondaryStream != nullptr) { secondaryStream->AddRef(); }
+    LeaveCriticalSection(&streamLock);
+
+    if (primaryStream == nullptr)
+    {
+        SafeRelease(secondaryStream);
+        return MF_E_STREAMSINK_REMOVED;
+    }
+
+    HRESULT hr = primaryStream->ProcessSample(pSample);
+
+    // The secondary stream gets its own sample, since the file sink may still read the original's timestamp,
+    // but it shares the encoded buffers so nothing is copied.
+    if (SUCCEEDED(hr) && secondaryStream != nullptr)
+    {
+        IMFSample* secondarySample = NULL;
+        LONGLONG sampleTime = 0;
+        LONGLONG duration = 0;
+        DWORD bufferCount = 0;
+
+        HRESULT hrSecondary = MFCreateSample(&secondarySample);
+        if (SUCCEEDED(hrSecondary)) { hrSecondary = pSample->CopyAllItems(secondarySample); }
+        if (SUCCEEDED(hrSecondary)) { hrSecondary = pSample->GetBufferCount(&bufferCount); }
+
+        for (DWORD i = 0; SUCCEEDED(hrSecondary) && i < bufferCount; i++)
+        {
+            IMFMediaBuffer* buffer = NULL;
+            hrSecondary = pSample->GetBufferByIndex(i, &buffer);
+            if (SUCCEEDED(hrSecondary)) { hrSecondary = secondarySample->AddBuffer(buffer); }
+            SafeRelease(buffer);
+        }
+
+        if (SUCCEEDED(hrSecondary) && SUCCEEDED(pSample->GetSampleTime(&sampleTime)))
+        {
+            hrSecondary = secondarySample->SetSampleTime(sampleTime + timeOffset);
+        }
+        if (SUCCEEDED(hrSecondary) && SUCCEEDED(pSample->GetSampleDuration(&duration)))
+        {
+            hrSecondary = secondarySample->SetSampleDuration(duration);
+        }
+
+        if (SUCCEEDED(hrSecondary)) { hrSecondary = secondaryStream->ProcessSample(secondarySample); }
+
+        SafeRelease(secondarySample);
+
+        // Streaming is best effort, a failing receiver must not stop the recording.
+        if (FAILED(hrSecondary))
+        {
+            OutputDebugString(L"Error sending encoded sample to streaming sink.\n");
+        }
+    }
+
+    SafeRelease(secondaryStream);
+    SafeRelease(primaryStream);
+
+    return hr;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <Windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mferror.h>
+
+#include <vector>
+
+class TeeStreamSink;
+
+// Media sink for the recording sink writer that hands every encoded sample to a primary sink (the MP4 file)
+// and to a secondary sink (eg: a network sink), so the composite is encoded once and fanned out.
+// The primary sink drives the sink writer: stream types, events, clock and finalization all come from it.
+// The secondary sink is shared between recordings, so it is never shut down here; its owner runs its clock,
+// and samples sent to it are offset by secondaryTimeOffset so its timeline continues across files.
+class TeeMediaSink : public IMFFinalizableMediaSink
+{
+public:
+    static HRESULT Create(IMFMediaSink* primary, IMFMediaSink* secondary, LONGLONG secondaryTimeOffset, IMFMediaSink** sink);
+
+    // For sinks created ahead of time, before the start of their file on the secondary timeline is known.
+    void SetSecondaryTimeOffset(LONGLONG secondaryTimeOffset);
+
+    STDMETHODIMP_(ULONG) AddRef()
+    {
+        return InterlockedIncrement(&m_cRef);
+    }
+
+    STDMETHODIMP_(ULONG) Release()
+    {
+        ULONG ulRefCount = InterlockedDecrement(&m_cRef);
+        if (0 == ulRefCount)
+        {
+            delete this;
+        }
+        return ulRefCount;
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void **ppvObject);
+
+    // IMFMediaSink
+    STDMETHODIMP GetCharacteristics(DWORD* pdwCharacteristics);
+    STDMETHODIMP AddStreamSink(DWORD dwStreamSinkIdentifier, IMFMediaType* pMediaType, IMFStreamSink** ppStreamSink);
+    STDMETHODIMP RemoveStreamSink(DWORD dwStreamSinkIdentifier);
+    STDMETHODIMP GetStreamSinkCount(DWORD* pcStreamSinkCount);
+    STDMETHODIMP GetStreamSinkByIndex(DWORD dwIndex, IMFStreamSink** ppStreamSink);
+    STDMETHODIMP GetStreamSinkById(DWORD dwStreamSinkIdentifier, IMFStreamSink** ppStreamSink);
+    STDMETHODIMP SetPresentationClock(IMFPresentationClock* pPresentationClock);
+    STDMETHODIMP GetPresentationClock(IMFPresentationClock** ppPresentationClock);
+    STDMETHODIMP Shutdown();
+
+    // IMFFinalizableMediaSink
+    STDMETHODIMP BeginFinalize(IMFAsyncCallback* pCallback, IUnknown* punkState);
+    STDMETHODIMP EndFinalize(IMFAsyncResult* pResult);
+
+    // Keep reading events from a stream nobody else listens to, so they do not pile up in its event queue.
+    // Stops when the stream shuts down.
+    static HRESULT DrainEvents(IMFMediaEventGenerator* eventGenerator);
+
+private:
+    TeeMediaSink(IMFMediaSink* primary);
+    ~TeeMediaSink();
+
+    HRESULT Initialize(IMFMediaSink* secondary, LONGLONG secondaryTimeOffset);
+
+    ULONG m_cRef = 1;
+
+    IMFMediaSink* primary;
+    std::vector<TeeStreamSink*> streams;
+    bool isShutdown = false;
+};
+
+class TeeStreamSink : public IMFStreamSink
+{
+public:
+    STDMETHODIMP_(ULONG) AddRef()
+    {
+        return InterlockedIncrement(&m_cRef);
+    }
+
+    STDMETHODIMP_(ULONG) Release()
+    {
+        ULONG ulRefCount = InterlockedDecrement(&m_cRef);
+        if (0 == ulRefCount)
+        {
+            delete this;
+        }
+        return ulRefCount;
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void **ppvObject);
+
+    // IMFMediaEventGenerator
+    STDMETHODIMP BeginGetEvent(IMFAsyncCallback* pCallback, IUnknown* punkState);
+    STDMETHODIMP EndGetEvent(IMFAsyncResult* pResult, IMFMediaEvent** ppEvent);
+    STDMETHODIMP GetEvent(DWORD dwFlags, IMFMediaEvent** ppEvent);
+    STDMETHODIMP QueueEvent(MediaEventType met, REFGUID guidExtendedType, HRESULT hrStatus, const PROPVARIANT* pvValue);
+
+    // IMFStreamSink
+    STDMETHODIMP GetMediaSink(IMFMediaSink** ppMediaSink);
+    STDMETHODIMP GetIdentifier(DWORD* pdwIdentifier);
+    STDMETHODIMP GetMediaTypeHandler(IMFMediaTypeHandler** ppHandler);
+    STDMETHODIMP ProcessSample(IMFSample* pSample);
+    STDMETHODIMP PlaceMarker(MFSTREAMSINK_MARKER_TYPE eMarkerType, const PROPVARIANT* pvarMarkerValue, const PROPVARIANT* pvarContextValue);
+    STDMETHODIMP Flush();
+
+private:
+    friend class TeeMediaSink;
+
+    TeeStreamSink(TeeMediaSink* sink, IMFStreamSink* primary, IMFStreamSink* secondary, LONGLONG secondaryTimeOffset);
+    ~TeeStreamSink();
+
+    void Shutdown();
+
+    ULONG m_cRef = 1;
+
+    // Not a reference, the media sink owns this stream.
+    TeeMediaSink* sink;
+    IMFStreamSink* primary;
+    IMFStreamSink* secondary;
+    LONGLONG secondaryTimeOffset;
+    CRITICAL_SECTION streamLock;
+};
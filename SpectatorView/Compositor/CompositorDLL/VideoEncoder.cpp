@@ -3,9 +3,12 @@
 
 #include "stdafx.h"
 #include "VideoEncoder.h"
+#include "TeeMediaSink.h"
 
 #include "codecapi.h"
 
+#include <fstream>
+
 
 VideoEncoder::VideoEncoder(UINT frameWidth, UINT frameHeight, UINT frameStride, UINT fps,
     UINT32 audioBufferSize, UINT32 audioSampleRate, UINT32 audioChannels, UINT32 audioBPS) :
@@ -23,13 +26,20 @@ VideoEncoder::VideoEncoder(UINT frameWidth, UINT frameHeight, UINT frameStride,
 {
 #if HARDWARE_ENCODE_VIDEO
   inputFormat = MFVideoFormat_NV12;
+  videoBufferPool = MediaBufferPool::Create((DWORD)(1.5f * frameWidth * frameHeight));
 #else
   inputFormat = MFVideoFormat_RGB32;
+  videoBufferPool = MediaBufferPool::Create(frameStride * frameHeight);
 #endif
+
+  audioBufferPool = MediaBufferPool::Create(audioBufferSize);
+  audioPipeline = new AudioPipeline(audioSampleRate, audioChannels);
 }
 
 VideoEncoder::~VideoEncoder()
 {
+    SetStreamingSink(NULL);
+    delete audioPipeline;
     MFShutdown();
 }
 
@@ -58,7 +68,7 @@ bool VideoEncoder::IsRecording()
     return isRecording;
 }
 
-void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
+void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio, LONGLONG segmentDuration)
 {
     std::unique_lock<std::shared_mutex> lock(videoStateLock);
 
@@ -69,17 +79,46 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
 
     // Reset previous times to get valid data for this recording.
     prevVideoTime = INVALID_TIMESTAMP;
-    prevAudioTime = INVALID_TIMESTAMP;
 
     LARGE_INTEGER time;
     QueryPerformanceCounter(&time);
     startTime = time.QuadPart;
 
-    HRESULT hr = E_PENDING;
+    // Audio timestamps count samples from here.
+    audioPipeline->Reset(startTime, freq.QuadPart);
+
+    this->videoPath = videoPath;
+    this->encodeAudio = encodeAudio && ENCODE_AUDIO;
+    this->segmentDuration = segmentDuration;
+    segmentIndex = 0;
+    playlistPath = L"";
+
+    if (segmentDuration > 0)
+    {
+        playlistPath = videoPath;
+
+        std::wofstream playlist(playlistPath, std::ios::trunc);
+        playlist << L"#EXTM3U" << std::endl;
+    }
+
+    // Streaming times count from here, the same as the recording.
+    if (streamingClock != NULL)
+    {
+        streamingClock->Start(0);
+    }
+
+    {
+        std::lock_guard<std::mutex> segmentGuard(segmentLock);
+        OpenSegment(PrepareSegment(), 0);
+    }
 
-    sinkWriter = NULL;
-    videoStreamIndex = NULL;
-    audioStreamIndex = NULL;
+    isRecording = true;
+    acceptQueuedFrames = true;
+}
+
+HRESULT VideoEncoder::CreateSinkWriter(RecordingSegment* newSegment)
+{
+    HRESULT hr = E_PENDING;
 
     IMFMediaType*    pVideoTypeOut = NULL;
     IMFMediaType*    pVideoTypeIn = NULL;
@@ -99,10 +138,8 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
     if (SUCCEEDED(hr)) { hr = attr->SetUINT32(MF_READWRITE_DISABLE_CONVERTERS, false); }
 #endif
 
-    hr = MFCreateSinkWriterFromURL(videoPath, NULL, attr, &sinkWriter);
-
     // Set the output media types.
-    if (SUCCEEDED(hr)) { hr = MFCreateMediaType(&pVideoTypeOut); }
+    hr = MFCreateMediaType(&pVideoTypeOut);
     if (SUCCEEDED(hr)) { hr = pVideoTypeOut->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video); }
     if (SUCCEEDED(hr)) { hr = pVideoTypeOut->SetGUID(MF_MT_SUBTYPE, videoEncodingFormat); }
     if (SUCCEEDED(hr)) { hr = pVideoTypeOut->SetUINT32(MF_MT_AVG_BITRATE, bitRate); }
@@ -120,9 +157,7 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
     if (SUCCEEDED(hr)) { hr = pVideoTypeOut->SetUINT32(MF_MT_MPEG2_LEVEL, eAVEncH264VLevel4_2); }
     if (SUCCEEDED(hr)) { hr = pVideoTypeOut->SetUINT32(MF_MT_MPEG2_PROFILE, eAVEncH264VProfile_High); }
 
-    if (SUCCEEDED(hr)) { hr = sinkWriter->AddStream(pVideoTypeOut, &videoStreamIndex); }
-
-    if (encodeAudio)
+    if (newSegment->encodeAudio)
     {
 #if ENCODE_AUDIO
         if (SUCCEEDED(hr)) { hr = MFCreateMediaType(&pAudioTypeOut); }
@@ -135,10 +170,26 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
         if (SUCCEEDED(hr)) { hr = pAudioTypeOut->SetUINT32(MF_MT_AUDIO_PREFER_WAVEFORMATEX, 1); }
         if (SUCCEEDED(hr)) { hr = pAudioTypeOut->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, 1); }
         if (SUCCEEDED(hr)) { hr = pAudioTypeOut->SetUINT32(MF_MT_FIXED_SIZE_SAMPLES, 1); }
-        if (SUCCEEDED(hr)) { hr = sinkWriter->AddStream(pAudioTypeOut, &audioStreamIndex); }
 #endif
     }
 
+    if (newSegment->streamingSink == NULL)
+    {
+        if (SUCCEEDED(hr)) { hr = MFCreateSinkWriterFromURL(newSegment->path.c_str(), NULL, attr, &newSegment->sinkWriter); }
+        if (SUCCEEDED(hr)) { hr = newSegment->sinkWriter->AddStream(pVideoTypeOut, &newSegment->videoStreamIndex); }
+#if ENCODE_AUDIO
+        if (SUCCEEDED(hr) && newSegment->encodeAudio) { hr = newSegment->sinkWriter->AddStream(pAudioTypeOut, &newSegment->audioStreamIndex); }
+#endif
+    }
+    else
+    {
+        IMFMediaType* audioTypeOut = NULL;
+#if ENCODE_AUDIO
+        audioTypeOut = pAudioTypeOut;
+#endif
+        if (SUCCEEDED(hr)) { hr = CreateStreamingSinkWriter(newSegment, pVideoTypeOut, audioTypeOut, attr); }
+    }
+
     // Set the input media types.
     if (SUCCEEDED(hr)) { hr = MFCreateMediaType(&pVideoTypeIn); }
     if (SUCCEEDED(hr)) { hr = pVideoTypeIn->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video); }
@@ -147,9 +198,9 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
     if (SUCCEEDED(hr)) { hr = MFSetAttributeSize(pVideoTypeIn, MF_MT_FRAME_SIZE, frameWidth, frameHeight); }
     if (SUCCEEDED(hr)) { hr = MFSetAttributeRatio(pVideoTypeIn, MF_MT_FRAME_RATE, fps, 1); }
     if (SUCCEEDED(hr)) { hr = MFSetAttributeRatio(pVideoTypeIn, MF_MT_PIXEL_ASPECT_RATIO, 1, 1); }
-    if (SUCCEEDED(hr)) { hr = sinkWriter->SetInputMediaType(videoStreamIndex, pVideoTypeIn, NULL); }
+    if (SUCCEEDED(hr)) { hr = newSegment->sinkWriter->SetInputMediaType(newSegment->videoStreamIndex, pVideoTypeIn, NULL); }
 
-    if (encodeAudio)
+    if (newSegment->encodeAudio)
     {
 #if ENCODE_AUDIO
         if (SUCCEEDED(hr)) { hr = MFCreateMediaType(&pAudioTypeIn); }
@@ -158,21 +209,15 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
         if (SUCCEEDED(hr)) { hr = pAudioTypeIn->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16); }
         if (SUCCEEDED(hr)) { hr = pAudioTypeIn->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, audioSampleRate); }
         if (SUCCEEDED(hr)) { hr = pAudioTypeIn->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS, audioChannels); }
-        if (SUCCEEDED(hr)) { hr = sinkWriter->SetInputMediaType(audioStreamIndex, pAudioTypeIn, NULL); }
+        if (SUCCEEDED(hr)) { hr = newSegment->sinkWriter->SetInputMediaType(newSegment->audioStreamIndex, pAudioTypeIn, NULL); }
 #endif
     }
 
     // Tell the sink writer to start accepting data.
-    if (SUCCEEDED(hr)) { hr = sinkWriter->BeginWriting(); }
-
-    if (FAILED(hr))
-    {
-        OutputDebugString(L"Error starting recording.\n");
-    }
+    if (SUCCEEDED(hr)) { hr = newSegment->sinkWriter->BeginWriting(); }
 
-    isRecording = true;
-    acceptQueuedFrames = true;
 
+    SafeRelease(attr);
     SafeRelease(pVideoTypeOut);
     SafeRelease(pVideoTypeIn);
 
@@ -180,77 +225,207 @@ void VideoEncoder::StartRecording(LPCWSTR videoPath, bool encodeAudio)
     SafeRelease(pAudioTypeOut);
     SafeRelease(pAudioTypeIn);
 #endif
+    return hr;
 }
 
-void VideoEncoder::WriteAudio(byte* buffer, LONGLONG timestamp)
+HRESULT VideoEncoder::CreateStreamingSinkWriter(RecordingSegment* newSegment, IMFMediaType* videoTypeOut, IMFMediaType* audioTypeOut, IMFAttributes* attr)
 {
-    std::shared_lock<std::shared_mutex> lock(videoStateLock);
+    IMFByteStream* byteStream = NULL;
+    IMFMediaSink* fileSink = NULL;
+    IMFMediaSink* teeSink = NULL;
+
+    // The file sink is created directly instead of from the URL so the tee can sit between it and the sink writer.
+    // Each sample is encoded once and the tee hands it to both the file and the streaming sink.
+    HRESULT hr = MFCreateFile(MF_ACCESSMODE_WRITE, MF_OPENMODE_DELETE_IF_EXIST, MF_FILEFLAGS_NONE, newSegment->path.c_str(), &byteStream);
+    if (SUCCEEDED(hr)) { hr = MFCreateMPEG4MediaSink(byteStream, videoTypeOut, audioTypeOut, &fileSink); }
+
+    // File times restart at every segment, streaming times continue from the start of the recording.
+    // The segment's start time is not known yet, OpenSegment sets the offset once it is.
+    if (SUCCEEDED(hr)) { hr = TeeMediaSink::Create(fileSink, newSegment->streamingSink, 0, &teeSink); }
+    if (SUCCEEDED(hr)) { hr = MFCreateSinkWriterFromMediaSink(teeSink, attr, &newSegment->sinkWriter); }
+    if (SUCCEEDED(hr))
+    {
+        newSegment->teeSink = static_cast<TeeMediaSink*>(teeSink);
+        newSegment->teeSink->AddRef();
+    }
 
-#if ENCODE_AUDIO
-    if (!isRecording || startTime == INVALID_TIMESTAMP || timestamp < startTime)
+    // The MPEG-4 sink has the video stream first, then audio.
+    newSegment->videoStreamIndex = 0;
+    newSegment->audioStreamIndex = 1;
+
+    SafeRelease(teeSink);
+    SafeRelease(fileSink);
+    SafeRelease(byteStream);
+
+    return hr;
+}
+
+std::shared_ptr<VideoEncoder::RecordingSegment> VideoEncoder::PrepareSegment()
+{
+    std::shared_ptr<RecordingSegment> newSegment = std::make_shared<RecordingSegment>();
+
+    if (segmentDuration > 0)
     {
-        return;
+        // 1_Video.m3u is recorded to 1_Video_000.mp4, 1_Video_001.mp4, ...
+        wchar_t suffix[16];
+        swprintf_s(suffix, L"_%03d.mp4", segmentIndex++);
+        newSegment->path = videoPath.substr(0, videoPath.find_last_of(L'.')) + suffix;
+    }
+    else
+    {
+        newSegment->path = videoPath;
     }
 
-    LONGLONG sampleTimeNow = timestamp;
-    if (sampleTimeNow < 0) { sampleTimeNow *= -1; }
-    LONGLONG sampleTimeStart = startTime;
-    if (sampleTimeStart < 0) { sampleTimeStart *= -1; }
+    newSegment->encodeAudio = encodeAudio;
+    newSegment->streamingSink = streamingSink;
+    if (newSegment->streamingSink != NULL)
+    {
+        newSegment->streamingSink->AddRef();
+    }
 
-    LONGLONG sampleTime = sampleTimeNow - sampleTimeStart;
-    if (sampleTime < 0) { sampleTime *= -1; }
+    // Creating the sink writer opens the file and loads the encoder, which is too slow for the render thread.
+    // It waits for earlier files to be finalized or discarded, so a discarded file's name can be used again.
+    newSegment->writeTask = segmentCloseTask.then([this, newSegment]()
+    {
+        if (FAILED(CreateSinkWriter(newSegment.get())))
+        {
+            OutputDebugString(L"Error starting recording.\n");
+            SafeRelease(newSegment->sinkWriter);
+            SafeRelease(newSegment->teeSink);
+        }
+
+        SafeRelease(newSegment->streamingSink);
+    }, concurrency::task_continuation_context::use_arbitrary());
 
-    LONGLONG duration = AUDIO_POLLING_RATE_HNS;
-    if (prevAudioTime != INVALID_TIMESTAMP)
+    return newSegment;
+}
+
+void VideoEncoder::OpenSegment(std::shared_ptr<RecordingSegment> newSegment, LONGLONG segmentStartTime)
+{
+    segment = newSegment;
+    segment->startTime = segmentStartTime;
+    segment->endTime = segmentStartTime;
+
+    // The sink writer may still be being created, so the streaming offset is set after it, before the first write.
+    segment->writeTask = segment->writeTask.then([newSegment, segmentStartTime]()
     {
-        duration = sampleTime - prevAudioTime;
-        if (duration < 0) { duration *= -1; }
+        if (newSegment->teeSink != NULL)
+        {
+            newSegment->teeSink->SetSecondaryTimeOffset(segmentStartTime);
+        }
+    });
 
-        duration *= QPC_MULTIPLIER;
-        duration /= freq.QuadPart;
+    // The file after this one has a whole segment to get its sink writer ready.
+    if (segmentDuration > 0)
+    {
+        nextSegment = PrepareSegment();
+    }
+}
+
+void VideoEncoder::CloseSegment(std::shared_ptr<RecordingSegment> closedSegment)
+{
+    // Finalize on a worker thread after the last write to this segment, and after earlier segments so the playlist stays in order.
+    std::wstring playlist = playlistPath;
+    segmentCloseTask = (segmentCloseTask && closedSegment->writeTask).then([closedSegment, playlist]()
+    {
+        if (closedSegment->sinkWriter != NULL)
+        {
+            if (FAILED(closedSegment->sinkWriter->Finalize()))
+            {
+                OutputDebugString(L"Error finalizing video.\n");
+            }
+
+            SafeRelease(closedSegment->sinkWriter);
+        }
+
+        SafeRelease(closedSegment->teeSink);
+
+        if (!playlist.empty())
+        {
+            std::wstring fileName = closedSegment->path.substr(closedSegment->path.find_last_of(L'\\') + 1);
+
+            std::wofstream playlistFile(playlist, std::ios::app);
+            playlistFile << L"#EXTINF:" << (double)(closedSegment->endTime - closedSegment->startTime) / QPC_MULTIPLIER << L"," << std::endl;
+            playlistFile << fileName << std::endl;
+        }
+    }, concurrency::task_continuation_context::use_arbitrary());
+}
+
+void VideoEncoder::DiscardSegment(std::shared_ptr<RecordingSegment> unusedSegment)
+{
+    segmentCloseTask = (segmentCloseTask && unusedSegment->writeTask).then([unusedSegment]()
+    {
+        // Releasing the sink writer without finalizing it shuts down its media sink, which closes the file.
+        SafeRelease(unusedSegment->sinkWriter);
+        SafeRelease(unusedSegment->teeSink);
+        DeleteFileW(unusedSegment->path.c_str());
+    }, concurrency::task_continuation_context::use_arbitrary());
+}
+
+void VideoEncoder::WriteAudio(PooledMediaBuffer* buffer, LONGLONG sampleTime, LONGLONG duration)
+{
+    std::shared_lock<std::shared_mutex> lock(videoStateLock);
+
+#if ENCODE_AUDIO
+    std::lock_guard<std::mutex> segmentGuard(segmentLock);
+
+    if (!isRecording || startTime == INVALID_TIMESTAMP || segment == nullptr)
+    {
+        SafeRelease(buffer);
+        return;
     }
 
-    // Copy frame to a temporary buffer and process on a background thread.
-    byte* tmpAudioBuffer = new byte[audioBufferSize];
-    memcpy(tmpAudioBuffer, buffer, audioBufferSize);
+    // Audio from before the last segment boundary still belongs in the previous file.
+    // Once audio has caught up with the boundary, the previous file can be finalized.
+    std::shared_ptr<RecordingSegment> target = segment;
+    if (closingSegment != nullptr)
+    {
+        if (sampleTime < segment->startTime)
+        {
+            target = closingSegment;
+        }
+        else
+        {
+            CloseSegment(closingSegment);
+            closingSegment = nullptr;
+        }
+    }
 
-    concurrency::create_task([=]()
+    // The file this audio belongs to was closed without waiting for it.
+    if (sampleTime < target->startTime)
     {
-        std::shared_lock<std::shared_mutex> lock(videoStateLock);
+        SafeRelease(buffer);
+        return;
+    }
 
+    if (sampleTime + duration > target->endTime)
+    {
+        target->endTime = sampleTime + duration;
+    }
+
+    // Process on a background thread after the previous write to this segment, the task owns the buffer reference.
+    target->writeTask = target->writeTask.then([=]()
+    {
         HRESULT hr = E_PENDING;
-        if (sinkWriter == NULL || !isRecording)
+        if (target->sinkWriter == NULL)
         {
-            OutputDebugString(L"Must start recording before writing audio frames.\n");
-            delete[] tmpAudioBuffer;
+            buffer->Release();
             return;
         }
 
         IMFSample* pAudioSample = NULL;
-        IMFMediaBuffer* pAudioBuffer = NULL;
+        IMFMediaBuffer* pAudioBuffer = buffer;
 
         const DWORD cbAudioBuffer = audioBufferSize;
 
-        BYTE* pData = NULL;
-
-        hr = MFCreateMemoryBuffer(cbAudioBuffer, &pAudioBuffer);
-        if (SUCCEEDED(hr)) { hr = pAudioBuffer->Lock(&pData, NULL, NULL); }
-        memcpy(pData, tmpAudioBuffer, cbAudioBuffer);
-        if (pAudioBuffer)
-        {
-            pAudioBuffer->Unlock();
-        }
-
-        if (SUCCEEDED(hr)) { hr = MFCreateSample(&pAudioSample); }
-        LONGLONG t = sampleTime;
-        t *= QPC_MULTIPLIER;
-        t /= freq.QuadPart;
-        if (SUCCEEDED(hr)) { hr = pAudioSample->SetSampleTime(t); }
+        // The audio pipeline timestamps are already in 100ns units.
+        hr = MFCreateSample(&pAudioSample);
+        if (SUCCEEDED(hr)) { hr = pAudioSample->SetSampleTime(sampleTime - target->startTime); }
         if (SUCCEEDED(hr)) { hr = pAudioSample->SetSampleDuration(duration); }
         if (SUCCEEDED(hr)) { hr = pAudioBuffer->SetCurrentLength(cbAudioBuffer); }
         if (SUCCEEDED(hr)) { hr = pAudioSample->AddBuffer(pAudioBuffer); }
 
-        if (SUCCEEDED(hr)) { hr = sinkWriter->WriteSample(audioStreamIndex, pAudioSample); }
+        if (SUCCEEDED(hr)) { hr = target->sinkWriter->WriteSample(target->audioStreamIndex, pAudioSample); }
 
         SafeRelease(pAudioSample);
         SafeRelease(pAudioBuffer);
@@ -259,21 +434,20 @@ void VideoEncoder::WriteAudio(byte* buffer, LONGLONG timestamp)
         {
             OutputDebugString(L"Error writing audio frame.\n");
         }
-
-        delete[] tmpAudioBuffer;
     });
-
-    prevAudioTime = sampleTime;
-    if (prevAudioTime < 0) { prevAudioTime *= -1; }
+#else
+    SafeRelease(buffer);
 #endif
 }
 
-void VideoEncoder::WriteVideo(byte* buffer, LONGLONG timestamp, LONGLONG duration)
+void VideoEncoder::WriteVideo(PooledMediaBuffer* buffer, LONGLONG timestamp, LONGLONG duration)
 {
     std::shared_lock<std::shared_mutex> lock(videoStateLock);
+    std::lock_guard<std::mutex> segmentGuard(segmentLock);
 
-    if (!isRecording || startTime == INVALID_TIMESTAMP || timestamp < startTime)
+    if (!isRecording || startTime == INVALID_TIMESTAMP || timestamp < startTime || segment == nullptr)
     {
+        SafeRelease(buffer);
         return;
     }
 
@@ -294,101 +468,95 @@ void VideoEncoder::WriteVideo(byte* buffer, LONGLONG timestamp, LONGLONG duratio
         duration /= freq.QuadPart;
     }
 
-    // Copy frame to a temporary buffer and process on a background thread.
-#if HARDWARE_ENCODE_VIDEO
-    BYTE* tmpVideoBuffer = new BYTE[(int)(1.5f * frameHeight * frameWidth)];
-    memcpy(tmpVideoBuffer, buffer, (int)(1.5f * frameHeight * frameWidth));
-#else
-    BYTE* tmpVideoBuffer = new BYTE[frameHeight * frameStride];
-    memcpy(tmpVideoBuffer, buffer, frameHeight * frameStride);
-#endif
+    prevVideoTime = sampleTime;
+    if (prevVideoTime < 0) { prevVideoTime *= -1; }
 
-    concurrency::create_task([=]()
+    LONGLONG frameTime = sampleTime;
+    frameTime *= QPC_MULTIPLIER;
+    frameTime /= freq.QuadPart;
+
+    // Audio normally reaches the segment boundary within a few chunks.  If it stops, finalize the previous file anyway.
+    if (closingSegment != nullptr && frameTime - segment->startTime >= CLOSING_SEGMENT_TIMEOUT)
+    {
+        CloseSegment(closingSegment);
+        closingSegment = nullptr;
+    }
+
+    // Start the next file on a video frame, so every file begins with a key frame.
+    // Its sink writer was created in the background, so this only swaps pointers and schedules work on worker threads.
+    if (segmentDuration > 0 && frameTime - segment->startTime >= segmentDuration)
     {
-        std::shared_lock<std::shared_mutex> lock(videoStateLock);
+        if (closingSegment != nullptr)
+        {
+            CloseSegment(closingSegment);
+        }
+
+        closingSegment = segment;
+
+        // Without audio there is nothing left to write to the previous file.
+        if (!encodeAudio)
+        {
+            CloseSegment(closingSegment);
+            closingSegment = nullptr;
+        }
+
+        std::shared_ptr<RecordingSegment> newSegment = nextSegment != nullptr ? nextSegment : PrepareSegment();
+        nextSegment = nullptr;
+        OpenSegment(newSegment, frameTime);
+    }
+
+    std::shared_ptr<RecordingSegment> target = segment;
+    target->endTime = frameTime + duration;
 
+    // Process on a background thread after the previous write to this segment, the task owns the buffer reference.
+    // The frame was written straight into the pooled buffer, so it is handed to the sink writer without a copy.
+    target->writeTask = target->writeTask.then([=]()
+    {
         HRESULT hr = E_PENDING;
-        if (sinkWriter == NULL || !isRecording)
+        if (target->sinkWriter == NULL)
         {
-            OutputDebugString(L"Must start recording before writing video frames.\n");
-            delete[] tmpVideoBuffer;
+            buffer->Release();
             return;
         }
 
-        LONG cbWidth = frameStride;
-        DWORD cbBuffer = cbWidth * frameHeight;
-        DWORD imageHeight = frameHeight;
+        DWORD cbBuffer = frameStride * frameHeight;
 
 #if HARDWARE_ENCODE_VIDEO
-        cbWidth = frameWidth;
         cbBuffer = (int)(1.5f * frameWidth * frameHeight);
-        imageHeight = (int)(1.5f * frameHeight);
 #endif
 
         IMFSample* pVideoSample = NULL;
-        IMFMediaBuffer* pVideoBuffer = NULL;
-        BYTE* pData = NULL;
-
-        // Create a new memory buffer.
-        hr = MFCreateMemoryBuffer(cbBuffer, &pVideoBuffer);
-
-        // Lock the buffer and copy the video frame to the buffer.
-        if (SUCCEEDED(hr)) { hr = pVideoBuffer->Lock(&pData, NULL, NULL); }
-
-        if (SUCCEEDED(hr))
-        {
-            //TODO: Can pVideoBuffer be created from an ID3D11Texture2D*?
-            hr = MFCopyImage(
-                pData,                      // Destination buffer.
-                cbWidth,                    // Destination stride.
-                tmpVideoBuffer,
-                cbWidth,                    // Source stride.
-                cbWidth,                    // Image width in bytes.
-                imageHeight                 // Image height in pixels.
-            );
-        }
-
-        if (pVideoBuffer)
-        {
-            pVideoBuffer->Unlock();
-        }
+        IMFMediaBuffer* pVideoBuffer = buffer;
 
         // Set the data length of the buffer.
-        if (SUCCEEDED(hr)) { hr = pVideoBuffer->SetCurrentLength(cbBuffer); }
+        hr = pVideoBuffer->SetCurrentLength(cbBuffer);
 
         // Create a media sample and add the buffer to the sample.
         if (SUCCEEDED(hr)) { hr = MFCreateSample(&pVideoSample); }
         if (SUCCEEDED(hr)) { hr = pVideoSample->AddBuffer(pVideoBuffer); }
 
-        // Set the frame timestamp.
-        LONGLONG t = sampleTime;
-        t *= QPC_MULTIPLIER;
-        t /= freq.QuadPart;
-        if (SUCCEEDED(hr)) { hr = pVideoSample->SetSampleTime(t); }
+        // Set the frame timestamp, relative to the start of this file.
+        if (SUCCEEDED(hr)) { hr = pVideoSample->SetSampleTime(frameTime - target->startTime); }
         if (SUCCEEDED(hr)) { hr = pVideoSample->SetSampleDuration(duration); }
 
         // Send the sample to the Sink Writer.
-        if (SUCCEEDED(hr)) { hr = sinkWriter->WriteSample(videoStreamIndex, pVideoSample); }
+        if (SUCCEEDED(hr)) { hr = target->sinkWriter->WriteSample(target->videoStreamIndex, pVideoSample); }
 
         SafeRelease(pVideoSample);
         SafeRelease(pVideoBuffer);
-        delete[] tmpVideoBuffer;
 
         if (FAILED(hr))
         {
             OutputDebugString(L"Error writing video frame.\n");
         }
     });
-
-    prevVideoTime = sampleTime;
-    if (prevVideoTime < 0) { prevVideoTime *= -1; }
 }
 
 void VideoEncoder::StopRecording()
 {
     std::unique_lock<std::shared_mutex> lock(videoStateLock);
 
-    if (sinkWriter == NULL || !isRecording)
+    if (segment == nullptr || !isRecording)
     {
         OutputDebugString(L"Must start recording before it can be stopped.\n");
         return;
@@ -401,7 +569,6 @@ void VideoEncoder::StopRecording()
     std::mutex completion_mutex;
 
     bool doneCleaningVideoTasks = false;
-    bool doneCleaningAudioTasks = false;
 
     std::unique_lock<std::mutex> completion_lock(completion_mutex);
     std::condition_variable completion_lock_check;
@@ -410,6 +577,7 @@ void VideoEncoder::StopRecording()
     {
         while (!videoQueue.empty())
         {
+            videoQueue.front().buffer->Release();
             videoQueue.pop();
         }
 
@@ -420,36 +588,130 @@ void VideoEncoder::StopRecording()
         completion_lock_check.notify_one();
     });
 
-    concurrency::create_task([&]
+    completion_lock_check.wait(completion_lock, [&] {return doneCleaningVideoTasks; });
+
+    std::lock_guard<std::mutex> segmentGuard(segmentLock);
+
+    if (closingSegment != nullptr)
     {
-        while (!audioQueue.empty())
-        {
-            audioQueue.pop();
-        }
+        CloseSegment(closingSegment);
+        closingSegment = nullptr;
+    }
 
-        {
-            std::lock_guard<std::mutex> lk(completion_mutex);
-            doneCleaningAudioTasks = true;
-        }
-        completion_lock_check.notify_one();
-    });
+    CloseSegment(segment);
+    segment = nullptr;
+
+    if (nextSegment != nullptr)
+    {
+        DiscardSegment(nextSegment);
+        nextSegment = nullptr;
+    }
+
+    // Earlier segments have usually been finalized already, so this waits for at most one segment.
+    segmentCloseTask.wait();
 
-    completion_lock_check.wait(completion_lock, [&] {return doneCleaningVideoTasks && doneCleaningAudioTasks; });
+    if (streamingClock != NULL)
+    {
+        streamingClock->Stop();
+    }
+}
 
-    if (videoStreamIndex != NULL)
+void VideoEncoder::SetStreamingSink(IMFMediaSink* sink)
+{
+    std::unique_lock<std::shared_mutex> lock(videoStateLock);
+
+    if (streamingSink != NULL)
     {
-        sinkWriter->Flush(videoStreamIndex);
+        streamingClock->Stop();
+        streamingSink->SetPresentationClock(NULL);
     }
-    if (audioStreamIndex != NULL)
+
+    SafeRelease(streamingClock);
+    SafeRelease(streamingSink);
+
+    if (sink != nullptr)
     {
-        sinkWriter->Flush(audioStreamIndex);
+        AttachStreamingSink(sink);
     }
 
-    sinkWriter->Finalize();
-    SafeRelease(sinkWriter);
+    // The next file's sink writer was created for the previous sink, create it again with the new one.
+    std::lock_guard<std::mutex> segmentGuard(segmentLock);
+    if (nextSegment != nullptr)
+    {
+        DiscardSegment(nextSegment);
+        segmentIndex--;
+        nextSegment = PrepareSegment();
+    }
+}
+
+void VideoEncoder::AttachStreamingSink(IMFMediaSink* sink)
+{
+    // The streaming sink is only fed by the recording, so it runs on its own clock that starts and stops with it.
+    IMFPresentationTimeSource* timeSource = NULL;
+    HRESULT hr = MFCreatePresentationClock(&streamingClock);
+    if (SUCCEEDED(hr)) { hr = MFCreateSystemTimeSource(&timeSource); }
+    if (SUCCEEDED(hr)) { hr = streamingClock->SetTimeSource(timeSource); }
+    if (SUCCEEDED(hr)) { hr = sink->SetPresentationClock(streamingClock); }
+
+    // Nobody else listens to the sink's streams, so their sample requests are discarded.
+    DWORD streamCount = 0;
+    if (SUCCEEDED(hr)) { hr = sink->GetStreamSinkCount(&streamCount); }
+    for (DWORD i = 0; SUCCEEDED(hr) && i < streamCount; i++)
+    {
+        IMFStreamSink* stream = NULL;
+        hr = sink->GetStreamSinkByIndex(i, &stream);
+        if (SUCCEEDED(hr)) { hr = TeeMediaSink::DrainEvents(stream); }
+        SafeRelease(stream);
+    }
+
+    SafeRelease(timeSource);
+
+    if (FAILED(hr))
+    {
+        OutputDebugString(L"Error setting streaming sink.\n");
+        sink->SetPresentationClock(NULL);
+        SafeRelease(streamingClock);
+        return;
+    }
+
+    streamingSink = sink;
+    streamingSink->AddRef();
+
+    if (isRecording)
+    {
+        streamingClock->Start(0);
+    }
 }
 
 void VideoEncoder::QueueVideoFrame(byte* buffer, LONGLONG timestamp, LONGLONG duration)
+{
+    PooledMediaBuffer* videoBuffer = AcquireVideoBuffer();
+    if (videoBuffer == nullptr)
+    {
+        return;
+    }
+
+    memcpy(videoBuffer->GetData(), buffer, videoBufferPool->GetBufferSize());
+    QueueVideoFrame(videoBuffer, timestamp, duration);
+}
+
+PooledMediaBuffer* VideoEncoder::AcquireVideoBuffer()
+{
+    if (!acceptQueuedFrames)
+    {
+        return nullptr;
+    }
+
+    PooledMediaBuffer* videoBuffer = nullptr;
+    if (FAILED(videoBufferPool->Acquire(&videoBuffer)))
+    {
+        return nullptr;
+    }
+
+    return videoBuffer;
+}
+
+void VideoEncoder::QueueVideoFrame(PooledMediaBuffer* buffer, LONGLONG timestamp, LONGLONG duration)
 {
     std::shared_lock<std::shared_mutex> lock(videoStateLock);
 
@@ -457,6 +719,10 @@ void VideoEncoder::QueueVideoFrame(byte* buffer, LONGLONG timestamp, LONGLONG du
     {
         videoQueue.push(VideoInput(buffer, timestamp, duration));
     }
+    else
+    {
+        buffer->Release();
+    }
 }
 
 void VideoEncoder::QueueAudioFrame(byte* buffer, LONGLONG timestamp)
@@ -465,7 +731,17 @@ void VideoEncoder::QueueAudioFrame(byte* buffer, LONGLONG timestamp)
 
     if (acceptQueuedFrames)
     {
-        audioQueue.push(AudioInput(buffer, timestamp));
+        audioPipeline->WritePCM((const short*)buffer, audioBufferSize / sizeof(short), timestamp);
+    }
+}
+
+void VideoEncoder::QueueAudioFrame(const float* samples, UINT32 sampleCount, LONGLONG timestamp)
+{
+    std::shared_lock<std::shared_mutex> lock(videoStateLock);
+
+    if (acceptQueuedFrames)
+    {
+        audioPipeline->WriteFloat(samples, sampleCount, timestamp);
     }
 }
 
@@ -483,19 +759,21 @@ void VideoEncoder::Update()
         {
             VideoInput input = videoQueue.front();
             WriteVideo(input.buffer, input.timestamp, input.duration);
-            delete[] input.buffer;
             videoQueue.pop();
         }
     }
 
-    while (!audioQueue.empty())
+    // Engine audio is encoded in fixed size chunks, read from the audio pipeline into pooled buffers.
+    while (isRecording && audioPipeline->CanRead(audioBufferSize))
     {
-        if (isRecording)
+        PooledMediaBuffer* audioBuffer = nullptr;
+        if (FAILED(audioBufferPool->Acquire(&audioBuffer)))
         {
-            AudioInput input = audioQueue.front();
-            WriteAudio(input.buffer, input.timestamp);
-            delete[] input.buffer;
-            audioQueue.pop();
+            break;
         }
+
+        LONGLONG sampleTime, duration;
+        audioPipeline->Read(audioBuffer->GetData(), audioBufferSize, sampleTime, duration);
+        WriteAudio(audioBuffer, sampleTime, duration);
     }
 }
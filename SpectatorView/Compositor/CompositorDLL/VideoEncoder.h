@@ -12,10 +12,16 @@
 #include <Mfreadwrite.h>
 #include <mferror.h>
 #include <shared_mutex>
+#include <mutex>
+#include <ppltasks.h>
 
 #include "DirectXHelper.h"
+#include "PooledMediaBuffer.h"
+#include "AudioPipeline.h"
 
 #include <queue>
+#include <memory>
+#include <string>
 
 #pragma comment(lib, "mf")
 #pragma comment(lib, "mfreadwrite")
@@ -24,6 +30,11 @@
 
 #define INVALID_TIMESTAMP -1
 
+// Longest a finished file is kept open for audio from before the segment boundary, in 100ns units of video time.
+#define CLOSING_SEGMENT_TIMEOUT (2 * QPC_MULTIPLIER)
+
+class TeeMediaSink;
+
 class VideoEncoder
 {
 public:
@@ -33,65 +44,108 @@ public:
 
     bool Initialize(ID3D11Device* device);
 
-    void StartRecording(LPCWSTR videoPath, bool encodeAudio = false);
+    // If segmentDuration (in 100ns units) is not 0, videoPath names an .m3u playlist and the recording is split
+    // into files of that length next to it.  The next file's sink writer is created on a background thread while the
+    // current one records, and each file is finalized on a background thread when the next one starts.
+    void StartRecording(LPCWSTR videoPath, bool encodeAudio = false, LONGLONG segmentDuration = 0);
     bool IsRecording();
     void StopRecording();
 
+    // Also send the encoded recording to sink (eg: a network sink), without encoding it again.
+    // The sink gets video as stream 0 and audio as stream 1, and its clock runs while recording.
+    // Takes effect when the next recording or segment starts.  Pass NULL to stop streaming.
+    void SetStreamingSink(IMFMediaSink* sink);
+
     // Used for recording video from a background thread.
     void QueueVideoFrame(byte* buffer, LONGLONG timestamp, LONGLONG duration);
     void QueueAudioFrame(byte* buffer, LONGLONG timestamp);
+    // Interleaved float samples in -1..1, converted to 16 bit PCM by the audio pipeline.
+    void QueueAudioFrame(const float* samples, UINT32 sampleCount, LONGLONG timestamp);
+
+    // Zero copy recording: fill a buffer from AcquireVideoBuffer and queue it.
+    // QueueVideoFrame takes ownership of the buffer reference, which is released when the sink writer is done with it.
+    PooledMediaBuffer* AcquireVideoBuffer();
+    void QueueVideoFrame(PooledMediaBuffer* buffer, LONGLONG timestamp, LONGLONG duration);
 
     // Do not call this from a background thread.
     void Update();
 
 private:
-    void WriteVideo(byte* buffer, LONGLONG timestamp, LONGLONG duration);
-    void WriteAudio(byte* buffer, LONGLONG timestamp);
-
-    LARGE_INTEGER freq;
+    // These take ownership of the buffer reference.
+    void WriteVideo(PooledMediaBuffer* buffer, LONGLONG timestamp, LONGLONG duration);
+    void WriteAudio(PooledMediaBuffer* buffer, LONGLONG sampleTime, LONGLONG duration);
 
-    class VideoInput
+    // One output file.  The sink writer is created by the first task on writeTask, and writes are chained after it
+    // so samples reach the sink writer in order.  The file is finalized after its last write.
+    class RecordingSegment
     {
     public:
-#if HARDWARE_ENCODE_VIDEO
-        byte* buffer = new byte[(int)(1.5f * FRAME_WIDTH * FRAME_HEIGHT)];
-#else
-        byte* buffer = new byte[FRAME_BUFSIZE];
-#endif
+        IMFSinkWriter* sinkWriter = NULL;
+        // Set when the file is also streamed, to line its samples up with the streaming timeline.
+        TeeMediaSink* teeSink = NULL;
+        DWORD videoStreamIndex = 0;
+        DWORD audioStreamIndex = 0;
+        // Time of the first video frame in this file, from the start of the recording in 100ns units.
+        LONGLONG startTime = 0;
+        LONGLONG endTime = 0;
+        std::wstring path;
+        // Recording settings when the segment was prepared, read by the background task that creates the sink writer.
+        bool encodeAudio = false;
+        IMFMediaSink* streamingSink = NULL;
+        concurrency::task<void> writeTask = concurrency::task_from_result();
+    };
 
-        LONGLONG timestamp;
-        LONGLONG duration;
+    HRESULT CreateSinkWriter(RecordingSegment* newSegment);
+    HRESULT CreateStreamingSinkWriter(RecordingSegment* newSegment, IMFMediaType* videoTypeOut, IMFMediaType* audioTypeOut, IMFAttributes* attr);
+    // Picks the next file name and starts creating its sink writer on a background thread.
+    std::shared_ptr<RecordingSegment> PrepareSegment();
+    // Makes a prepared segment the one receiving new frames, starting at segmentStartTime.
+    void OpenSegment(std::shared_ptr<RecordingSegment> newSegment, LONGLONG segmentStartTime);
+    void CloseSegment(std::shared_ptr<RecordingSegment> closedSegment);
+    // Releases a prepared segment that never received a frame, and deletes its file.
+    void DiscardSegment(std::shared_ptr<RecordingSegment> unusedSegment);
+    void AttachStreamingSink(IMFMediaSink* sink);
 
-        VideoInput(byte* buffer, LONGLONG timestamp, LONGLONG duration)
-        {
-#if HARDWARE_ENCODE_VIDEO
-            memcpy(this->buffer, buffer, (int)(1.5f * FRAME_WIDTH * FRAME_HEIGHT));
-#else
-            memcpy(this->buffer, buffer, FRAME_BUFSIZE);
-#endif
-            this->timestamp = timestamp;
-            this->duration = duration;
-        }
-    };
+    LARGE_INTEGER freq;
 
-    class AudioInput
+    // Queued inputs own a reference to their buffer.
+    class VideoInput
     {
     public:
-        byte* buffer = new byte[AUDIO_BUFSIZE];
+        PooledMediaBuffer* buffer;
         LONGLONG timestamp;
+        LONGLONG duration;
 
-        AudioInput(byte* buffer, LONGLONG timestamp)
+        VideoInput(PooledMediaBuffer* buffer, LONGLONG timestamp, LONGLONG duration)
         {
-            memcpy(this->buffer, buffer, AUDIO_BUFSIZE);
+            this->buffer = buffer;
             this->timestamp = timestamp;
+            this->duration = duration;
         }
     };
 
-    IMFSinkWriter* sinkWriter;
-    DWORD videoStreamIndex;
-    DWORD audioStreamIndex;
-
-    byte* nullAudioBuffer = new byte[AUDIO_BUFSIZE];
+    // Frame memory handed to the sink writer.
+    std::shared_ptr<MediaBufferPool> videoBufferPool;
+    std::shared_ptr<MediaBufferPool> audioBufferPool;
+
+    // File receiving new frames, and the previous file while audio that ends before the segment boundary is written to it.
+    std::shared_ptr<RecordingSegment> segment;
+    std::shared_ptr<RecordingSegment> closingSegment;
+    // The file after segment, whose sink writer is created before the boundary so the render thread does not wait for it.
+    std::shared_ptr<RecordingSegment> nextSegment;
+    // Finalizes closed segments in order.
+    concurrency::task<void> segmentCloseTask = concurrency::task_from_result();
+    // Guards the segment pointers and segmentCloseTask, which are swapped while videoStateLock is only held shared.
+    std::mutex segmentLock;
+
+    std::wstring videoPath;
+    std::wstring playlistPath;
+    LONGLONG segmentDuration = 0;
+    int segmentIndex = 0;
+    bool encodeAudio = false;
+
+    IMFMediaSink* streamingSink = NULL;
+    IMFPresentationClock* streamingClock = NULL;
 
     bool isRecording = false;
     bool acceptQueuedFrames = false;
@@ -111,12 +165,11 @@ private:
     UINT32 audioSampleRate;
     UINT32 audioChannels;
     UINT32 audioBPS;
-    LONGLONG prevAudioTime = INVALID_TIMESTAMP;
+    AudioPipeline* audioPipeline;
 
     LONGLONG startTime = INVALID_TIMESTAMP;
 
     std::queue<VideoInput> videoQueue;
-    std::queue<AudioInput> audioQueue;
 
     std::shared_mutex videoStateLock;
 
@@ -14,6 +14,12 @@
 // Otherwise, setting this to FALSE will default to always using the latest hologram frame from Unity.
 #define QUEUE_FRAMES       TRUE
 
+// Set this to TRUE to keep the last hologram frames Unity rendered, and composite the one rendered closest to each color frame.
+// This gives stable holograms without Unity rendering again for every color frame, and works best with QUEUE_FRAMES set to FALSE.
+// Frames are read back from the GPU every render and kept compacted within HOLOGRAM_STORE_BUDGET_MB (see SetHologramFrameBudget).
+#define STORE_HOLOGRAM_FRAMES   FALSE
+#define HOLOGRAM_STORE_BUDGET_MB 256
+
 
 //TODO: Set this to true to use the Canon SDK to take a higher resolution tethered photos.
 #define USE_CANON_SDK  FALSE
@@ -36,15 +42,21 @@ static_assert((USE_ELGATO + USE_DECKLINK + USE_DECKLINK_SHUTTLE + USE_OPENCV ==
 //NOTE: If you do not have Audio data, set this to false or the video may encode incorrectly.
 #define ENCODE_AUDIO TRUE
 
+// Recording
+//TODO: Set this to a number of seconds to split recordings into files of that length, listed in an .m3u playlist.
+// Finished files stay valid if the application exits without stopping the recording,
+// and stopping only has to finalize the last file.  0 records a single file.
+#define VIDEO_SEGMENT_SECONDS 0
+
 // These should match Game Engine's audio settings.  Size is in bytes.
 // These values should also be valid data values for H.264 encoding:
 // https://msdn.microsoft.com/en-us/library/windows/desktop/dd742785(v=vs.85).aspx
 // NOTE: Audio bits per sample must be 16.
 // This should match size (in bytes) of audio data from Engine.
-// Note: Audio from Engine must be scaled to short.MinValue..short.MaxValue and converted to a byte array.
-// In Unity, audio is retrieved as a float array -1..1, but the channel size is:
-// sizeof(short) * (arrayLength / numChannels) instead of sizeof(float)
-// since we need to convert the floats to shorts for audio encoding.
+// Note: Audio from Engine is either scaled to short.MinValue..short.MaxValue and converted to a byte array (SetAudioData),
+// or passed as the float array -1..1 that Unity provides (SetAudioDataFloat) and converted natively.
+// Either way the channel size is sizeof(short) * (arrayLength / numChannels) instead of sizeof(float)
+// since the floats are converted to shorts for audio encoding.
 #define AUDIO_CHANNEL_SIZE  2048
 // This must be 1, 2, or 6 (if Win10)
 #define AUDIO_CHANNELS      2
@@ -56,10 +68,7 @@ static_assert((USE_ELGATO + USE_DECKLINK + USE_DECKLINK_SHUTTLE + USE_OPENCV ==
 
 #define AUDIO_BUFSIZE (AUDIO_CHANNEL_SIZE * AUDIO_CHANNELS)
 
-// Polling rate for engine audio.
-// This is used to replace periods of no audio with empty audio (eg: engine has stopped, listeners have been disabled)
 #define MS2HNS 10000
-#define AUDIO_POLLING_RATE_HNS ((LONGLONG)((((float)AUDIO_SAMPLE_RATE * (16.0f /*bits per sample*/ / 8.0f /*bits per byte*/)) / (float)AUDIO_BUFSIZE) * MS2HNS))
 
 // Frame Dimensions and buffer lengths
 //TODO: change this to match video dimensions from your tethered camera.
@@ -86,6 +95,10 @@ static_assert((USE_ELGATO + USE_DECKLINK + USE_DECKLINK_SHUTTLE + USE_OPENCV ==
 
 #define HOLOGRAM_BUFSIZE_HIRES      (HOLOGRAM_WIDTH_HIRES * HOLOGRAM_HEIGHT_HIRES * FRAME_BPP)
 
+// Hologram frames are classified in square tiles of this many pixels so CPU compositing can skip
+// fully transparent regions and copy fully opaque ones.
+#define HOLOGRAM_TILE_SIZE          32
+
 // Return timestamps in HNS.  Do not change this value.
 #define QPC_MULTIPLIER 10000000
 
@@ -8,6 +8,18 @@
 #include <d3d11_1.h>
 #include "CompositorShared.h"
 #include <amp.h>
+#include <intrin.h>
+#include <algorithm>
+
+// Classification of a HOLOGRAM_TILE_SIZE square of hologram pixels.
+enum TileOccupancy : BYTE
+{
+    // Every byte of every pixel is 0.
+    TileEmpty = 0,
+    // Every pixel has an alpha of 255.
+    TileOpaque = 1,
+    TileMixed = 2
+};
 
 class DirectXHelper
 {
@@ -237,17 +249,137 @@ public:
         delete[] swap;
     }
 
+    // Flip using a tile map from ClassifyTiles(..., flipRows = true): pairs of rows that are both entirely empty are not swapped.
+    static void FlipHorizontally(BYTE*& bytes, int width, int height, const BYTE* tiles)
+    {
+        int stride = width * FRAME_BPP;
+        int tilesX = GetTileCountX(width);
+
+        BYTE* swap = new BYTE[stride];
+        for (int i = 0, j = height - 1; i < height / 2.0f; i++, j--)
+        {
+            // Row i moves to row j and row j moves to row i, the tile map describes the flipped rows.
+            if (IsTileRowEmpty(tiles, tilesX, j / HOLOGRAM_TILE_SIZE) &&
+                IsTileRowEmpty(tiles, tilesX, i / HOLOGRAM_TILE_SIZE))
+            {
+                continue;
+            }
+
+            int topRow = stride * i;
+            int bottomRow = stride * j;
+
+            CopyMemory(swap, bytes + topRow, stride);
+            CopyMemory(bytes + topRow, bytes + bottomRow, stride);
+            CopyMemory(bytes + bottomRow, swap, stride);
+        }
+
+        delete[] swap;
+    }
+
+    // Tile occupancy.
+    static int GetTileCountX(int width)
+    {
+        return (width + HOLOGRAM_TILE_SIZE - 1) / HOLOGRAM_TILE_SIZE;
+    }
+
+    static int GetTileCountY(int height)
+    {
+        return (height + HOLOGRAM_TILE_SIZE - 1) / HOLOGRAM_TILE_SIZE;
+    }
+
+    static int GetTileCount(int width, int height)
+    {
+        return GetTileCountX(width) * GetTileCountY(height);
+    }
+
+    static bool IsTileRowEmpty(const BYTE* tiles, int tilesX, int tileRow)
+    {
+        for (int x = 0; x < tilesX; x++)
+        {
+            if (tiles[tileRow * tilesX + x] != TileEmpty)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Classify every HOLOGRAM_TILE_SIZE tile of an RGBA/BGRA buffer as empty, opaque or mixed in a single pass.
+    // tiles must hold GetTileCount(width, height) entries.
+    // Set flipRows to classify the image as it will be after FlipHorizontally, so the same map can be used for
+    // the flip and for every stage after it.
+    static void ClassifyTiles(const BYTE* bytes, int width, int height, BYTE* tiles, bool flipRows = false)
+    {
+        const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+        int stride = width * FRAME_BPP;
+        int tilesX = GetTileCountX(width);
+        int tilesY = GetTileCountY(height);
+
+        for (int ty = 0; ty < tilesY; ty++)
+        {
+            int startRow = ty * HOLOGRAM_TILE_SIZE;
+            int endRow = (std::min)(startRow + HOLOGRAM_TILE_SIZE, height);
+
+            for (int tx = 0; tx < tilesX; tx++)
+            {
+                int startColumn = tx * HOLOGRAM_TILE_SIZE;
+                int endColumn = (std::min)(startColumn + HOLOGRAM_TILE_SIZE, width);
+
+                __m128i any = _mm_setzero_si128();
+                __m128i all = alphaMask;
+                UINT32 anyTail = 0;
+                UINT32 allTail = 0xFF000000;
+
+                for (int row = startRow; row < endRow; row++)
+                {
+                    int sourceRow = flipRows ? height - 1 - row : row;
+                    const BYTE* pixels = bytes + sourceRow * stride;
+
+                    int column = startColumn;
+                    for (; column + 4 <= endColumn; column += 4)
+                    {
+                        __m128i v = _mm_loadu_si128((const __m128i*)(pixels + column * FRAME_BPP));
+                        any = _mm_or_si128(any, v);
+                        all = _mm_and_si128(all, v);
+                    }
+
+                    for (; column < endColumn; column++)
+                    {
+                        UINT32 v = *(const UINT32*)(pixels + column * FRAME_BPP);
+                        anyTail |= v;
+                        allTail &= v;
+                    }
+                }
+
+                bool empty = anyTail == 0 &&
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) == 0xFFFF;
+                bool opaque = (allTail & 0xFF000000) == 0xFF000000 &&
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(all, alphaMask), alphaMask)) == 0xFFFF;
+
+                tiles[ty * tilesX + tx] = empty ? TileEmpty : (opaque ? TileOpaque : TileMixed);
+            }
+        }
+    }
+
 
     // Conversions.
     // Convert a YUV input buffer to a BGRA output buffer.
     static void ConvertYUVtoBGRA(BYTE* input, BYTE* alphaInput, BYTE*& output, int width, int height, bool rgba = false)
     {
-        ConvertYUVtoBGRA_CPU(input, alphaInput, output, width, height, rgba);
+        if (SupportsSSSE3())
+        {
+            ConvertYUVtoBGRA_SSSE3(input, alphaInput, output, width, height, rgba);
+        }
+        else
+        {
+            ConvertYUVtoBGRA_CPU(input, alphaInput, output, width, height, rgba);
+        }
     }
 
     static void ConvertYUVtoBGRA(BYTE* input, BYTE*& output, int width, int height, bool rgba = false)
     {
-        ConvertYUVtoBGRA_CPU(input, nullptr, output, width, height, rgba);
+        ConvertYUVtoBGRA(input, nullptr, output, width, height, rgba);
     }
 
     // Convert a BGRA input buffer to a YUV output buffer.
@@ -338,64 +470,13 @@ public:
 
     static void ConvertRGBtoBGRA(BYTE* input, BYTE*& output, int width, int height, bool rgba)
     {
-        for (int i = 0, j = 0; i <= width * height * 3 - 3 * 4; i += 3 * 4, j += 4 * 4)
+        if (SupportsSSSE3())
         {
-            byte r, g, b;
-            byte r2, g2, b2;
-            byte r3, g3, b3;
-            byte r4, g4, b4;
-
-            r = input[i];
-            g = input[i + 1];
-            b = input[i + 2];
-
-            r2 = input[i + 3];
-            g2 = input[i + 4];
-            b2 = input[i + 5];
-
-            r3 = input[i + 6];
-            g3 = input[i + 7];
-            b3 = input[i + 8];
-
-            r4 = input[i + 9];
-            g4 = input[i + 10];
-            b4 = input[i + 11];
-
-
-            output[j] = b;
-            output[j + 1] = g;
-            output[j + 2] = r;
-            output[j + 3] = 255;
-
-            output[j + 4] = b2;
-            output[j + 5] = g2;
-            output[j + 6] = r2;
-            output[j + 7] = 255;
-
-            output[j + 8] = b3;
-            output[j + 9] = g3;
-            output[j + 10] = r3;
-            output[j + 11] = 255;
-
-            output[j + 12] = b4;
-            output[j + 13] = g4;
-            output[j + 14] = r4;
-            output[j + 15] = 255;
-
-            if (rgba)
-            {
-                output[j] = r;
-                output[j + 2] = b;
-
-                output[j + 4] = r2;
-                output[j + 6] = b2;
-
-                output[j + 8] = r3;
-                output[j + 10] = b3;
-
-                output[j + 12] = r4;
-                output[j + 14] = b4;
-            }
+            ConvertRGBtoBGRA_SSSE3(input, output, width, height, rgba);
+        }
+        else
+        {
+            ConvertRGBtoBGRA_CPU(input, output, width, height, rgba);
         }
     }
 
@@ -403,36 +484,64 @@ public:
     {
         for (int i = 0; i < bufferSize - FRAME_BPP; i += FRAME_BPP)
         {
-            byte br, bg, bb, ba;
-            byte fr, fg, fb, fa;
-
-            br = back[i];
-            bg = back[i + 1];
-            bb = back[i + 2];
-            ba = back[i + 3];
-
-            fr = front[i];
-            fg = front[i + 1];
-            fb = front[i + 2];
-            fa = front[i + 3];
-
+            BlendPixel(back + i, front + i, alpha);
+        }
+    }
 
-            float frontAlpha = Saturate(fa);
+    // Blend using a tile map from ClassifyTiles: empty tiles only force the background opaque,
+    // opaque tiles are copied when alpha is 1, and only the remaining tiles are blended per pixel.
+    static void AlphaBlend(/*[in out]*/ BYTE*& back, const BYTE* front, int width, int height, float alpha, const BYTE* tiles)
+    {
+        const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+        int stride = width * FRAME_BPP;
+        int tilesX = GetTileCountX(width);
+        int tilesY = GetTileCountY(height);
 
-            br = (byte)DirectXHelper::Clamp((int)
-                (((1 - alpha * frontAlpha) * (float)br) +
-                (alpha * (float)fr)));
-            bg = (byte)DirectXHelper::Clamp((int)
-                (((1 - alpha * frontAlpha) * (float)bg) +
-                (alpha * (float)fg)));
-            bb = (byte)DirectXHelper::Clamp((int)
-                (((1 - alpha * frontAlpha) * (float)bb) +
-                (alpha * (float)fb)));
+        for (int ty = 0; ty < tilesY; ty++)
+        {
+            int startRow = ty * HOLOGRAM_TILE_SIZE;
+            int endRow = (std::min)(startRow + HOLOGRAM_TILE_SIZE, height);
 
-            back[i] = br;
-            back[i + 1] = bg;
-            back[i + 2] = bb;
-            back[i + 3] = 255;
+            for (int tx = 0; tx < tilesX; tx++)
+            {
+                int startColumn = tx * HOLOGRAM_TILE_SIZE;
+                int endColumn = (std::min)(startColumn + HOLOGRAM_TILE_SIZE, width);
+                BYTE occupancy = tiles[ty * tilesX + tx];
+
+                for (int row = startRow; row < endRow; row++)
+                {
+                    BYTE* backRow = back + row * stride;
+                    const BYTE* frontRow = front + row * stride;
+
+                    if (occupancy == TileEmpty)
+                    {
+                        int column = startColumn;
+                        for (; column + 4 <= endColumn; column += 4)
+                        {
+                            __m128i* pixels = (__m128i*)(backRow + column * FRAME_BPP);
+                            _mm_storeu_si128(pixels, _mm_or_si128(_mm_loadu_si128(pixels), alphaMask));
+                        }
+
+                        for (; column < endColumn; column++)
+                        {
+                            backRow[column * FRAME_BPP + 3] = 255;
+                        }
+                    }
+                    // only an alpha of exactly 1 blends an opaque pixel to the hologram pixel, SetAlpha does not clamp
+                    else if (occupancy == TileOpaque && alpha == 1.0f)
+                    {
+                        memcpy(backRow + startColumn * FRAME_BPP, frontRow + startColumn * FRAME_BPP,
+                            (endColumn - startColumn) * FRAME_BPP);
+                    }
+                    else
+                    {
+                        for (int column = startColumn; column < endColumn; column++)
+                        {
+                            BlendPixel(backRow + column * FRAME_BPP, frontRow + column * FRAME_BPP, alpha);
+                        }
+                    }
+                }
+            }
         }
     }
 
@@ -449,6 +558,67 @@ public:
         }
     }
 
+    // Check once whether the SIMD conversion kernels can be used on this CPU.
+    static bool SupportsSSSE3()
+    {
+        static const bool supported = []()
+        {
+            int cpuInfo[4];
+            __cpuid(cpuInfo, 1);
+            return (cpuInfo[2] & (1 << 9)) != 0;
+        }();
+
+        return supported;
+    }
+
+    // Export alpha using a tile map from ClassifyTiles: empty and opaque tiles are filled without reading the input.
+    static void AlphaAsRGBA(BYTE* input, BYTE*& output, int width, int height, const BYTE* tiles)
+    {
+        int stride = width * FRAME_BPP;
+        int tilesX = GetTileCountX(width);
+        int tilesY = GetTileCountY(height);
+
+        for (int ty = 0; ty < tilesY; ty++)
+        {
+            int startRow = ty * HOLOGRAM_TILE_SIZE;
+            int endRow = (std::min)(startRow + HOLOGRAM_TILE_SIZE, height);
+
+            for (int tx = 0; tx < tilesX; tx++)
+            {
+                int startColumn = tx * HOLOGRAM_TILE_SIZE;
+                int endColumn = (std::min)(startColumn + HOLOGRAM_TILE_SIZE, width);
+                int rowBytes = (endColumn - startColumn) * FRAME_BPP;
+                BYTE occupancy = tiles[ty * tilesX + tx];
+
+                for (int row = startRow; row < endRow; row++)
+                {
+                    int offset = row * stride + startColumn * FRAME_BPP;
+
+                    if (occupancy == TileEmpty)
+                    {
+                        memset(output + offset, 0, rowBytes);
+                    }
+                    else if (occupancy == TileOpaque)
+                    {
+                        memset(output + offset, 255, rowBytes);
+                    }
+                    else
+                    {
+                        for (int i = offset; i < offset + rowBytes; i += 4)
+                        {
+                            byte a = input[i + 3];
+
+                            output[i] = a;
+                            output[i + 1] = a;
+                            output[i + 2] = a;
+                            output[i + 3] = a;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     // Byte value sanitation.
     // Flatten overflow or underflow values to a valid byte.
     static unsigned int Clamp(int input)
@@ -505,6 +675,139 @@ public:
     }
 
 private:
+    static void BlendPixel(BYTE* back, const BYTE* front, float alpha)
+    {
+        byte br, bg, bb;
+        byte fr, fg, fb, fa;
+
+        br = back[0];
+        bg = back[1];
+        bb = back[2];
+
+        fr = front[0];
+        fg = front[1];
+        fb = front[2];
+        fa = front[3];
+
+        float frontAlpha = Saturate(fa);
+
+        br = (byte)DirectXHelper::Clamp((int)
+            (((1 - alpha * frontAlpha) * (float)br) +
+            (alpha * (float)fr)));
+        bg = (byte)DirectXHelper::Clamp((int)
+            (((1 - alpha * frontAlpha) * (float)bg) +
+            (alpha * (float)fg)));
+        bb = (byte)DirectXHelper::Clamp((int)
+            (((1 - alpha * frontAlpha) * (float)bb) +
+            (alpha * (float)fb)));
+
+        back[0] = br;
+        back[1] = bg;
+        back[2] = bb;
+        back[3] = 255;
+    }
+
+    static void ConvertRGBtoBGRA_CPU(BYTE* input, BYTE*& output, int width, int height, bool rgba)
+    {
+        for (int i = 0, j = 0; i <= width * height * 3 - 3 * 4; i += 3 * 4, j += 4 * 4)
+        {
+            byte r, g, b;
+            byte r2, g2, b2;
+            byte r3, g3, b3;
+            byte r4, g4, b4;
+
+            r = input[i];
+            g = input[i + 1];
+            b = input[i + 2];
+
+            r2 = input[i + 3];
+            g2 = input[i + 4];
+            b2 = input[i + 5];
+
+            r3 = input[i + 6];
+            g3 = input[i + 7];
+            b3 = input[i + 8];
+
+            r4 = input[i + 9];
+            g4 = input[i + 10];
+            b4 = input[i + 11];
+
+
+            output[j] = b;
+            output[j + 1] = g;
+            output[j + 2] = r;
+            output[j + 3] = 255;
+
+            output[j + 4] = b2;
+            output[j + 5] = g2;
+            output[j + 6] = r2;
+            output[j + 7] = 255;
+
+            output[j + 8] = b3;
+            output[j + 9] = g3;
+            output[j + 10] = r3;
+            output[j + 11] = 255;
+
+            output[j + 12] = b4;
+            output[j + 13] = g4;
+            output[j + 14] = r4;
+            output[j + 15] = 255;
+
+            if (rgba)
+            {
+                output[j] = r;
+                output[j + 2] = b;
+
+                output[j + 4] = r2;
+                output[j + 6] = b2;
+
+                output[j + 8] = r3;
+                output[j + 10] = b3;
+
+                output[j + 12] = r4;
+                output[j + 14] = b4;
+            }
+        }
+    }
+
+    static void ConvertRGBtoBGRA_SSSE3(BYTE* input, BYTE*& output, int width, int height, bool rgba)
+    {
+        // Expand 3 byte pixels to 4 byte pixels with an opaque alpha, 16 pixels per iteration.
+        const __m128i shuffle = rgba ?
+            _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) :
+            _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+        const __m128i opaque = _mm_set1_epi32(0xFF000000);
+
+        int pixelCount = width * height;
+        int p = 0;
+        for (; p + 16 <= pixelCount; p += 16)
+        {
+            const BYTE* src = input + p * 3;
+            __m128i* dst = (__m128i*)(output + p * FRAME_BPP);
+
+            __m128i a = _mm_loadu_si128((const __m128i*)src);
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+            __m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+
+            _mm_storeu_si128(dst, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), opaque));
+            _mm_storeu_si128(dst + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), opaque));
+            _mm_storeu_si128(dst + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), opaque));
+            _mm_storeu_si128(dst + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), opaque));
+        }
+
+        // Remaining pixels.
+        for (; p < pixelCount; p++)
+        {
+            const BYTE* src = input + p * 3;
+            BYTE* dst = output + p * FRAME_BPP;
+
+            dst[0] = rgba ? src[0] : src[2];
+            dst[1] = src[1];
+            dst[2] = rgba ? src[2] : src[0];
+            dst[3] = 255;
+        }
+    }
+
     static void ConvertYUVtoBGRA_CPU(BYTE* input, BYTE* alphaInput, BYTE*& output, int width, int height, bool rgba = false)
     {
         for (int i = 0, j = 0, a = 0; i < width * height * FRAME_BPP_RAW - (FRAME_BPP_RAW * 4); i += FRAME_BPP_RAW * 4, j += FRAME_BPP * 4, a += 4)
@@ -584,6 +887,107 @@ private:
         }
     }
 
+    static void ConvertYUVtoBGRA_SSSE3(BYTE* input, BYTE* alphaInput, BYTE*& output, int width, int height, bool rgba = false)
+    {
+        // Same fixed point math as GetRGB, 8 pixels (4 UYVY macro pixels) per iteration.
+        const __m128i yShuffle = _mm_setr_epi8(1, -1, 3, -1, 5, -1, 7, -1, 9, -1, 11, -1, 13, -1, 15, -1);
+        const __m128i uShuffle = _mm_setr_epi8(0, -1, 0, -1, 4, -1, 4, -1, 8, -1, 8, -1, 12, -1, 12, -1);
+        const __m128i vShuffle = _mm_setr_epi8(2, -1, 2, -1, 6, -1, 6, -1, 10, -1, 10, -1, 14, -1, 14, -1);
+
+        const __m128i offset16 = _mm_set1_epi16(16);
+        const __m128i offset128 = _mm_set1_epi16(128);
+        const __m128i round = _mm_set1_epi32(128);
+        const __m128i zero = _mm_setzero_si128();
+
+        // Coefficient pairs for _mm_madd_epi16 on interleaved (c, d) or (c, e) values.
+        const __m128i ceToB = _mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409);
+        const __m128i cdToG = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+        const __m128i eToG = _mm_setr_epi16(-208, 0, -208, 0, -208, 0, -208, 0);
+        const __m128i cdToR = _mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516);
+
+        __m128i opaque = _mm_set1_epi8(-1);
+
+        int pixelCount = width * height;
+        int p = 0;
+        for (; p + 8 <= pixelCount; p += 8)
+        {
+            __m128i yuv = _mm_loadu_si128((const __m128i*)(input + p * FRAME_BPP_RAW));
+
+            __m128i c = _mm_sub_epi16(_mm_shuffle_epi8(yuv, yShuffle), offset16);
+            __m128i d = _mm_sub_epi16(_mm_shuffle_epi8(yuv, uShuffle), offset128);
+            __m128i e = _mm_sub_epi16(_mm_shuffle_epi8(yuv, vShuffle), offset128);
+
+            __m128i ceLo = _mm_unpacklo_epi16(c, e);
+            __m128i ceHi = _mm_unpackhi_epi16(c, e);
+            __m128i cdLo = _mm_unpacklo_epi16(c, d);
+            __m128i cdHi = _mm_unpackhi_epi16(c, d);
+            __m128i eLo = _mm_unpacklo_epi16(e, zero);
+            __m128i eHi = _mm_unpackhi_epi16(e, zero);
+
+            __m128i b = _mm_packs_epi32(
+                _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, ceToB), round), 8),
+                _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, ceToB), round), 8));
+            __m128i g = _mm_packs_epi32(
+                _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, cdToG), _mm_madd_epi16(eLo, eToG)), round), 8),
+                _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, cdToG), _mm_madd_epi16(eHi, eToG)), round), 8));
+            __m128i r = _mm_packs_epi32(
+                _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, cdToR), round), 8),
+                _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, cdToR), round), 8));
+
+            // Clamp to bytes.
+            b = _mm_packus_epi16(b, b);
+            g = _mm_packus_epi16(g, g);
+            r = _mm_packus_epi16(r, r);
+
+            __m128i a = opaque;
+            if (alphaInput != nullptr)
+            {
+                a = _mm_loadl_epi64((const __m128i*)(alphaInput + p));
+            }
+
+            __m128i first = rgba ? b : r;
+            __m128i third = rgba ? r : b;
+
+            __m128i firstSecond = _mm_unpacklo_epi8(first, g);
+            __m128i thirdAlpha = _mm_unpacklo_epi8(third, a);
+
+            __m128i* dst = (__m128i*)(output + p * FRAME_BPP);
+            _mm_storeu_si128(dst, _mm_unpacklo_epi16(firstSecond, thirdAlpha));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(firstSecond, thirdAlpha));
+        }
+
+        // Remaining macro pixels.
+        for (; p + 2 <= pixelCount; p += 2)
+        {
+            const BYTE* src = input + p * FRAME_BPP_RAW;
+            BYTE* dst = output + p * FRAME_BPP;
+
+            int r1, g1, b1, r2, g2, b2;
+            GetRGB(src[1], src[3], src[0], src[2], r1, g1, b1, r2, g2, b2);
+
+            if (rgba)
+            {
+                int swap = r1;
+                r1 = b1;
+                b1 = swap;
+
+                swap = r2;
+                r2 = b2;
+                b2 = swap;
+            }
+
+            dst[0] = (byte)Clamp(r1);
+            dst[1] = (byte)Clamp(g1);
+            dst[2] = (byte)Clamp(b1);
+            dst[3] = alphaInput != nullptr ? alphaInput[p] : 255;
+
+            dst[4] = (byte)Clamp(r2);
+            dst[5] = (byte)Clamp(g2);
+            dst[6] = (byte)Clamp(b2);
+            dst[7] = alphaInput != nullptr ? alphaInput[p + 1] : 255;
+        }
+    }
+
     static void ConvertBGRAtoYUV_CPU(BYTE* input, BYTE*& output, BYTE*& alphaOut, int width, int height)
     {
         for (int i = 0, j = 0, a = 0; i < width * height * FRAME_BPP - 4 * FRAME_BPP; i += 4 * FRAME_BPP, j += 4 * FRAME_BPP_RAW, a += FRAME_BPP)
@@ -25,12 +25,9 @@ static BYTE* colorBytes = new BYTE[FRAME_BUFSIZE];
 static BYTE* holoBytes = new BYTE[FRAME_BUFSIZE];
 #if USE_CANON_SDK
 static BYTE* hiResHoloBytes = new BYTE[HOLOGRAM_BUFSIZE_HIRES];
+static BYTE* hiResHoloTiles = new BYTE[DirectXHelper::GetTileCount(HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES)];
 #endif
-#if HARDWARE_ENCODE_VIDEO
-byte* videoBytes = new byte[(int)(1.5f * FRAME_WIDTH * FRAME_HEIGHT)];
-#else
-byte* videoBytes = new byte[FRAME_BUFSIZE];
-#endif
+static BYTE* holoTiles = new BYTE[DirectXHelper::GetTileCount(HOLOGRAM_WIDTH, HOLOGRAM_HEIGHT)];
 
 static ID3D11Texture2D* g_holoRenderTexture = nullptr;
 #if USE_CANON_SDK
@@ -50,6 +47,15 @@ static ID3D11Device* g_pD3D11Device = NULL;
 static float _frameOffset = INITIAL_FRAME_OFFSET;
 static LONGLONG colorTime = INVALID_TIMESTAMP;
 
+#if STORE_HOLOGRAM_FRAMES
+// Pose time of the hologram frame Unity renders next, and of the stored frame in the hologram texture.
+static LONGLONG hologramRenderTime = INVALID_TIMESTAMP;
+static LONGLONG shownHologramTime = INVALID_TIMESTAMP;
+// Where the current color frame wants its hologram from, set in UpdateSpectatorView.
+static LONGLONG hologramTargetTime = INVALID_TIMESTAMP;
+static LONGLONG hologramTargetOffset = 0;
+#endif
+
 static bool takePicture = false;
 static bool takeHiResPicture = false;
 
@@ -205,6 +211,11 @@ UNITYDLL void SetHologramPose(
     LONGLONG offset = (LONGLONG)(msOffset * 1000.0f);
 
     auto hologramFrame = ci->GetNextHologramFrame(timestamp - offset);
+
+#if STORE_HOLOGRAM_FRAMES && !QUEUE_FRAMES
+    // Unity renders the latest pose.
+    hologramRenderTime = timestamp - offset;
+#endif
     if (hologramFrame != nullptr)
     {
         hologramFrame->rotX = rotX;
@@ -258,8 +269,18 @@ UNITYDLL void UpdateSpectatorView()
             thirdPose._posZ = frame->posZ;
             thirdPose._timestamp = frame->timeStamp;
             thirdPose._colorTime = colorTime;
+
+#if STORE_HOLOGRAM_FRAMES && QUEUE_FRAMES
+            // Unity renders the queued pose.
+            hologramRenderTime = frame->timeStamp;
+#endif
         }
 
+#if STORE_HOLOGRAM_FRAMES
+        hologramTargetTime = colorTime - frameDuration;
+        hologramTargetOffset = (LONGLONG)(_frameOffset * (float)frameDuration);
+#endif
+
         newColorFrame = true;
     }
 }
@@ -272,8 +293,27 @@ static void __stdcall OnRenderEvent(int eventID)
         return;
     }
 
+#if STORE_HOLOGRAM_FRAMES
+    // Keep what Unity rendered, and show the stored frame rendered closest to the color frame.
+    // The hologram texture is only updated when that changes.
+    if (g_pD3D11Device != nullptr && g_holoRenderTexture != nullptr && g_UnityHoloSRV != nullptr)
+    {
+        DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_holoRenderTexture, FRAME_BPP, holoBytes);
+        ci->StoreHologramFrame(holoBytes, hologramRenderTime);
+
+        LONGLONG closestTime = ci->FindClosestStoredHologramFrame(hologramTargetTime, hologramTargetOffset);
+        if (closestTime != INVALID_TIMESTAMP &&
+            closestTime != shownHologramTime &&
+            ci->GetStoredHologramFrame(closestTime, holoBytes))
+        {
+            DirectXHelper::UpdateSRV(g_pD3D11Device, g_UnityHoloSRV, holoBytes, HOLOGRAM_WIDTH * FRAME_BPP);
+            shownHologramTime = closestTime;
+        }
+    }
+#else
     // Update hologram texture from the spectator view camera.
     DirectXHelper::CopyTexture(g_pD3D11Device, g_holoTexture, g_holoRenderTexture);
+#endif
 
     EnterCriticalSection(&lock);
 
@@ -295,8 +335,9 @@ static void __stdcall OnRenderEvent(int eventID)
                 takeHiResPicture = false;
 
                 DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_hiResHoloRenderTexture, FRAME_BPP, hiResHoloBytes);
-                DirectXHelper::FlipHorizontally(hiResHoloBytes, HOLOGRAM_HEIGHT_HIRES, HOLOGRAM_WIDTH_HIRES * FRAME_BPP);
-                ci->TakeCanonPicture(g_pD3D11Device, hiResHoloBytes);
+                DirectXHelper::ClassifyTiles(hiResHoloBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, hiResHoloTiles, true);
+                DirectXHelper::FlipHorizontally(hiResHoloBytes, HOLOGRAM_WIDTH_HIRES, HOLOGRAM_HEIGHT_HIRES, hiResHoloTiles);
+                ci->TakeCanonPicture(g_pD3D11Device, hiResHoloBytes, hiResHoloTiles);
             }
         }
 #endif
@@ -323,12 +364,13 @@ static void __stdcall OnRenderEvent(int eventID)
             }
 
             DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_holoRenderTexture, FRAME_BPP, holoBytes);
-            DirectXHelper::FlipHorizontally(holoBytes, FRAME_HEIGHT, FRAME_WIDTH * FRAME_BPP);
+            DirectXHelper::ClassifyTiles(holoBytes, FRAME_WIDTH, FRAME_HEIGHT, holoTiles, true);
+            DirectXHelper::FlipHorizontally(holoBytes, FRAME_WIDTH, FRAME_HEIGHT, holoTiles);
 
             memcpy(mergedBytes, colorBytes, FRAME_BUFSIZE);
-            DirectXHelper::AlphaBlend(mergedBytes, holoBytes, FRAME_BUFSIZE, ci->GetAlpha());
+            DirectXHelper::AlphaBlend(mergedBytes, holoBytes, FRAME_WIDTH, FRAME_HEIGHT, ci->GetAlpha(), holoTiles);
 
-            ci->TakePicture(g_pD3D11Device, FRAME_WIDTH, FRAME_HEIGHT, FRAME_BPP, mergedBytes, colorBytes, holoBytes);
+            ci->TakePicture(g_pD3D11Device, FRAME_WIDTH, FRAME_HEIGHT, FRAME_BPP, mergedBytes, colorBytes, holoBytes, holoTiles);
 
             delete[] colorBytes;
             delete[] colorBytesRaw;
@@ -340,22 +382,28 @@ static void __stdcall OnRenderEvent(int eventID)
             g_videoTexture != nullptr &&
             ci->IsVideoFrameReady())
         {
+            // Read the frame straight into encoder memory.
+            PooledMediaBuffer* videoFrame = ci->AcquireVideoFrameBuffer();
+            if (videoFrame != nullptr)
+            {
+                BYTE* videoBytes = videoFrame->GetData();
 #if HARDWARE_ENCODE_VIDEO
-            DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_videoTexture, 1.5f, videoBytes);
+                DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_videoTexture, 1.5f, videoBytes);
 #else
-            DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_videoTexture, FRAME_BPP, videoBytes);
+                DirectXHelper::GetBytesFromTexture(g_pD3D11Device, g_videoTexture, FRAME_BPP, videoBytes);
 #endif
-            LONGLONG frameTime = ci->GetTimestamp();
-            if (frameTime == INVALID_TIMESTAMP ||
-                frameTime == 0)
-            {
-                // To record frames before a camera source is present, we must have a valid timestamp.
-                LARGE_INTEGER time;
-                QueryPerformanceCounter(&time);
-                frameTime = time.QuadPart;
+                LONGLONG frameTime = ci->GetTimestamp();
+                if (frameTime == INVALID_TIMESTAMP ||
+                    frameTime == 0)
+                {
+                    // To record frames before a camera source is present, we must have a valid timestamp.
+                    LARGE_INTEGER time;
+                    QueryPerformanceCounter(&time);
+                    frameTime = time.QuadPart;
+                }
+
+                ci->RecordFrameAsync(videoFrame, frameTime);
             }
-
-            ci->RecordFrameAsync(videoBytes, frameTime);
         }
     }
 
@@ -453,6 +501,26 @@ UNITYDLL void SetAudioData(BYTE* audioData)
 #endif
 }
 
+// Engine audio as interleaved floats in -1..1, which are converted to 16 bit PCM natively.
+UNITYDLL void SetAudioDataFloat(float* audioData, int sampleCount, int channels)
+{
+    if (!isRecording || sampleCount <= 0 || channels != AUDIO_CHANNELS)
+    {
+        return;
+    }
+
+#if ENCODE_AUDIO
+    // Get the time for the audio frame.
+    LARGE_INTEGER time;
+    QueryPerformanceCounter(&time);
+
+    if (ci != nullptr)
+    {
+        ci->RecordAudioFrameAsync(audioData, (UINT32)sampleCount, time.QuadPart);
+    }
+#endif
+}
+
 UNITYDLL void TakePicture()
 {
     takePicture = true;
@@ -483,6 +551,26 @@ UNITYDLL void StopRecording()
     }
 }
 
+// sink is an IMFMediaSink, eg: from MrvcNetworkSinkCreate, that receives the recording as it is encoded.
+UNITYDLL bool SetStreamingSink(IMFMediaSink* sink)
+{
+    if (videoInitialized && ci != nullptr)
+    {
+        return ci->SetStreamingSink(sink);
+    }
+
+    return false;
+}
+
+// Memory the stored hologram frames may use, when STORE_HOLOGRAM_FRAMES is set.
+UNITYDLL void SetHologramFrameBudget(int megabytes)
+{
+    if (ci != nullptr && megabytes > 0)
+    {
+        ci->SetHologramFrameBudget((size_t)megabytes * 1024 * 1024);
+    }
+}
+
 UNITYDLL bool IsRecording()
 {
     return isRecording;
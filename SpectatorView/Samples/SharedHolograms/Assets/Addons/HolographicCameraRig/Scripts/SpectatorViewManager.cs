@@ -39,6 +39,9 @@ namespace SpectatorView
         [DllImport("UnityCompositorInterface")]
         private static extern void SetAudioData(byte[] audioData);
 
+        [DllImport("UnityCompositorInterface")]
+        private static extern void SetAudioDataFloat(float[] audioData, int sampleCount, int channels);
+
         [DllImport("UnityCompositorInterface")]
         private static extern void Reset();
 
@@ -489,16 +492,8 @@ namespace SpectatorView
         // Send audio data to Compositor.
         void OnAudioFilterRead(float[] data, int channels)
         {
-            Byte[] audioBytes = new Byte[data.Length * 2];
-
-            for (int i = 0; i < data.Length; i++)
-            {
-                // Rescale float to short range for encoding.
-                short audioEntry = (short)(data[i] * short.MaxValue);
-                BitConverter.GetBytes(audioEntry).CopyTo(audioBytes, i * 2);
-            }
-
-            SetAudioData(audioBytes);
+            // The compositor converts the floats to shorts for encoding.
+            SetAudioDataFloat(data, data.Length, channels);
         }
 #endif
 